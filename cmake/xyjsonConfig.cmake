@@ -4,6 +4,10 @@
 # Set package version
 set(xyjson_VERSION "1.0.0")
 
+# Dependencies of the imported targets
+include(CMakeFindDependencyMacro)
+find_dependency(Threads)
+
 # Import targets from the installation
 include("${CMAKE_CURRENT_LIST_DIR}/xyjsonTargets.cmake")
 
@@ -14,6 +14,7 @@
  */
 
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <cstring>
 #include <vector>
@@ -33,21 +34,24 @@ void print_usage(const char* prog_name) {
     std::cerr << "  echo '{\"a\": {\"b\": 1}}' | " << prog_name << " -?/a/b\n";
 }
 
-bool read_json_from_file(const char* filepath, std::string& json_content) {
-    std::ifstream file(filepath);
+bool read_json_from_file(const char* filepath, MutableDocument& doc) {
+    std::ifstream file(filepath, std::ios::binary);
     if (!file.is_open()) {
         std::cerr << "Error: Cannot open file '" << filepath << "'\n";
         return false;
     }
 
-    json_content.assign((std::istreambuf_iterator<char>(file)),
-                        std::istreambuf_iterator<char>());
+    doc.read(file);
     return true;
 }
 
-bool read_json_from_stdin(std::string& json_content) {
-    json_content.assign((std::istreambuf_iterator<char>(std::cin)),
-                        std::istreambuf_iterator<char>());
+bool read_json_from_stdin(MutableDocument& doc) {
+    if (!std::cin.good()) {
+        return false;
+    }
+
+    // read in chunks, works with pipe
+    doc.read(std::cin);
     return true;
 }
 
@@ -83,21 +87,19 @@ int main(int argc, char* argv[]) {
         query_path = "";
     }
 
-    // Read JSON content
-    std::string json_content;
+    // Read and parse JSON using MutableDocument for easier output
+    MutableDocument doc;
     if (from_stdin) {
-        if (!read_json_from_stdin(json_content)) {
+        if (!read_json_from_stdin(doc)) {
             std::cerr << "Error: Failed to read from stdin\n";
             return 1;
         }
     } else {
-        if (!read_json_from_file(json_source.c_str(), json_content)) {
+        if (!read_json_from_file(json_source.c_str(), doc)) {
             return 1;
         }
     }
 
-    // Parse JSON using MutableDocument for easier output
-    MutableDocument doc(json_content);
     if (doc.hasError()) {
         std::cerr << "Error: Invalid JSON format\n";
         return 1;
@@ -105,10 +107,9 @@ int main(int argc, char* argv[]) {
 
     // If no query path specified, print entire JSON formatted
     if (query_path.empty()) {
-        std::string output;
-        doc.write(output);
-        std::cout << output << "\n";
-        return 0;
+        // streamed in chunks, not materialized as a whole string
+        StreamWriter writer(std::cout, YYJSON_WRITE_PRETTY | YYJSON_WRITE_NEWLINE_AT_END);
+        return writer.write(doc) && writer.flush() ? 0 : 1;
     }
 
     // Query the path
@@ -119,6 +120,6 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    std::cout << result.toString() << "\n";
+    std::cout << result << "\n";
     return 0;
 }
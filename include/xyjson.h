@@ -32,64 +32,130 @@
 #define XYJSON_H__
 
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <fstream>
 #include <cstdio>
+#include <cstddef>
+#include <cerrno>
 
 #include <yyjson.h>
 #include <functional>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <charconv>
+
+#ifndef XYJSON_DISABLE_THREAD
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <exception>
+#endif
+
+#if defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define XYJSON_HAS_PMR
+#endif
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#include <sys/uio.h>
+#define XYJSON_HAS_UNISTD
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#define XYJSON_HAS_MMAP
+#endif
+#endif
+#endif
+
+// incremental reader since yyjson 0.11.0
+#if YYJSON_VERSION_HEX >= 0x000B00
+#define XYJSON_HAS_INCR
+#endif
 
 /* Table of Content (TOC) */
 /* ======================================================================== */
-/* Part 1: Front Definitions                                       Line: 97 */
-/*   Section 1.1: Conditional Compilation Macros                  Line: 100 */
-/*   Section 1.2: Forward Class Declarations                      Line: 124 */
-/*   Section 1.3: Type and Operator Constants                     Line: 152 */
-/*   Section 1.4: Type Traits                                     Line: 195 */
-/* Part 2: Class Definitions                                      Line: 342 */
-/*   Section 2.1: Read-only Json Model                            Line: 345 */
-/*   Section 2.2: Mutable Json Model                              Line: 630 */
-/*   Section 2.3: Helper Class for Mutable Json                  Line: 1050 */
-/*   Section 2.4: Iterator for Json Container                    Line: 1117 */
-/*   Section 2.5: Container-specific Wrapper Classes             Line: 1465 */
-/* Part 3: Non-Class Functions                                   Line: 1535 */
-/*   Section 3.1: Underlying mut_val Creation                    Line: 1548 */
-/*   Section 3.2: Conversion Helper Functions                    Line: 1758 */
-/* Part 4: Class Implementations                                 Line: 1916 */
-/*   Section 4.1: Value Methods                                  Line: 1919 */
-/*     Group 4.1.1: get and getor                                Line: 1922 */
-/*     Group 4.1.2: size and index/path                          Line: 2028 */
-/*     Group 4.1.3: create iterator                              Line: 2061 */
-/*     Group 4.1.4: others                                       Line: 2129 */
-/*   Section 4.2: Document Methods                               Line: 2179 */
-/*     Group 4.2.1: primary manage                               Line: 2182 */
-/*     Group 4.2.2: read and write                               Line: 2224 */
-/*   Section 4.3: MutableValue Methods                           Line: 2318 */
-/*     Group 4.3.1: get and getor                                Line: 2321 */
-/*     Group 4.3.2: size and index/path                          Line: 2433 */
-/*     Group 4.3.3: assignment set                               Line: 2507 */
-/*     Group 4.3.4: array and object add                         Line: 2629 */
-/*     Group 4.3.5: smart input and tag                          Line: 2675 */
-/*     Group 4.3.6: create iterator                              Line: 2779 */
-/*     Group 4.3.7: others                                       Line: 2847 */
-/*   Section 4.4: MutableDocument Methods                        Line: 2897 */
-/*     Group 4.4.1: primary manage                               Line: 2900 */
-/*     Group 4.4.2: read and write                               Line: 2952 */
-/*     Group 4.4.3: create mutable value                         Line: 3057 */
-/*   Section 4.5: ArrayIterator Methods                          Line: 3082 */
-/*   Section 4.6: ObjectIterator Methods                         Line: 3125 */
-/*   Section 4.7: MutableArrayIterator Methods                   Line: 3189 */
-/*   Section 4.8: MutableObjectIterator Methods                  Line: 3309 */
-/* Part 5: Operator Interface                                    Line: 3532 */
-/*   Section 5.1: Primary Path Access                            Line: 3535 */
-/*   Section 5.2: Conversion Unary Operator                      Line: 3642 */
-/*   Section 5.3: Comparison Operator                            Line: 3690 */
-/*   Section 5.4: Create and Bind KeyValue                       Line: 3776 */
-/*   Section 5.5: Stream and Input Operator                      Line: 3808 */
-/*   Section 5.6: Iterator Creation and Operation                Line: 3879 */
-/*   Section 5.7: Document Forward Root Operator                 Line: 4054 */
-/*   Section 5.8: User-defined Literal Operator                  Line: 4119 */
-/* Part 6: Last Definitions                                      Line: 4131 */
+/* Part 1: Front Definitions                                      Line: 164 */
+/*   Section 1.1: Conditional Compilation Macros                  Line: 167 */
+/*   Section 1.2: Forward Class Declarations                      Line: 200 */
+/*   Section 1.3: Type and Operator Constants                     Line: 252 */
+/*   Section 1.4: Type Traits                                     Line: 310 */
+/* Part 2: Class Definitions                                      Line: 461 */
+/*   Section 2.1: Read-only Json Model                            Line: 464 */
+/*   Section 2.2: Mutable Json Model                              Line: 816 */
+/*   Section 2.3: Helper Class for Mutable Json                  Line: 1284 */
+/*   Section 2.4: Iterator for Json Container                    Line: 1351 */
+/*   Section 2.5: Container-specific Wrapper Classes             Line: 1699 */
+/*   Section 2.6: Memory Allocator and Read Options              Line: 1769 */
+/*   Section 2.7: Document Stream                                Line: 2167 */
+/*   Section 2.8: Parallel Processing                            Line: 2248 */
+/*   Section 2.9: Incremental Document                           Line: 2473 */
+/*   Section 2.10: Mutable View                                  Line: 2545 */
+/*   Section 2.11: On-Demand Document                            Line: 2633 */
+/*   Section 2.12: Projection                                    Line: 2816 */
+/*   Section 2.13: Validation                                    Line: 2877 */
+/*   Section 2.14: Stream Writer                                 Line: 2905 */
+/*   Section 2.15: Json Writer                                   Line: 2990 */
+/* Part 3: Non-Class Functions                                   Line: 3139 */
+/*   Section 3.1: Underlying mut_val Creation                    Line: 3152 */
+/*   Section 3.2: Conversion Helper Functions                    Line: 3362 */
+/*   Section 3.3: Memory Allocator Adaptor                       Line: 3551 */
+/*   Section 3.4: Input Stream Helper                            Line: 4127 */
+/*   Section 3.5: Raw Text Scanner                               Line: 4173 */
+/*   Section 3.6: Json Validator                                 Line: 4399 */
+/*   Section 3.7: Tree Walk Helper                               Line: 4783 */
+/*   Section 3.8: Structural Hash                                Line: 4956 */
+/* Part 4: Class Implementations                                 Line: 5118 */
+/*   Section 4.1: Value Methods                                  Line: 5121 */
+/*     Group 4.1.1: get and getor                                Line: 5124 */
+/*     Group 4.1.2: size and index/path                          Line: 5242 */
+/*     Group 4.1.3: create iterator                              Line: 5275 */
+/*     Group 4.1.4: others                                       Line: 5343 */
+/*   Section 4.2: Document Methods                               Line: 5410 */
+/*     Group 4.2.1: primary manage                               Line: 5413 */
+/*     Group 4.2.2: read and write                               Line: 5494 */
+/*   Section 4.3: MutableValue Methods                           Line: 5754 */
+/*     Group 4.3.1: get and getor                                Line: 5757 */
+/*     Group 4.3.2: size and index/path                          Line: 5881 */
+/*     Group 4.3.3: assignment set                               Line: 5955 */
+/*     Group 4.3.4: array and object add                         Line: 6077 */
+/*     Group 4.3.5: smart input and tag                          Line: 6123 */
+/*     Group 4.3.6: create iterator                              Line: 6227 */
+/*     Group 4.3.7: others                                       Line: 6295 */
+/*   Section 4.4: MutableDocument Methods                        Line: 6362 */
+/*     Group 4.4.1: primary manage                               Line: 6365 */
+/*     Group 4.4.2: read and write                               Line: 6509 */
+/*     Group 4.4.3: create mutable value                         Line: 6654 */
+/*   Section 4.5: ArrayIterator Methods                          Line: 6679 */
+/*   Section 4.6: ObjectIterator Methods                         Line: 6722 */
+/*   Section 4.7: MutableArrayIterator Methods                   Line: 6786 */
+/*   Section 4.8: MutableObjectIterator Methods                  Line: 6906 */
+/*   Section 4.9: Allocator Methods                              Line: 7129 */
+/*   Section 4.10: DocumentStream Methods                        Line: 7426 */
+/*   Section 4.11: Parallel Processing Methods                   Line: 7542 */
+/*   Section 4.12: IncrementalDocument Methods                   Line: 8140 */
+/*   Section 4.13: MutableView Methods                           Line: 8283 */
+/*   Section 4.14: OnDemandDocument Methods                      Line: 8548 */
+/*   Section 4.15: Projection Methods                            Line: 8724 */
+/*   Section 4.16: Validation Functions                          Line: 8898 */
+/*   Section 4.17: StreamWriter Methods                          Line: 8926 */
+/*   Section 4.18: JsonWriter Methods                            Line: 9056 */
+/* Part 5: Operator Interface                                    Line: 9351 */
+/*   Section 5.1: Primary Path Access                            Line: 9354 */
+/*   Section 5.2: Conversion Unary Operator                      Line: 9461 */
+/*   Section 5.3: Comparison Operator                            Line: 9520 */
+/*   Section 5.4: Create and Bind KeyValue                       Line: 9606 */
+/*   Section 5.5: Stream and Input Operator                      Line: 9664 */
+/*   Section 5.6: Iterator Creation and Operation                Line: 9743 */
+/*   Section 5.7: Document Forward Root Operator                 Line: 9918 */
+/*   Section 5.8: User-defined Literal Operator                  Line: 9983 */
+/* Part 6: Last Definitions                                      Line: 9995 */
 /* ======================================================================== */
 
 namespace yyjson
@@ -122,6 +188,15 @@ namespace yyjson
 #ifndef XYJSON_DISABLE_MUTABLE
 #endif
 
+/**
+ * @brief Disable multi-threaded parsing and writing
+ *
+ * When defined, removes TaskPool and the parallel classes based on it, so
+ * that no thread library is needed to link.
+ */
+#ifndef XYJSON_DISABLE_THREAD
+#endif
+
 /* @Section 1.2: Forward Class Declarations */
 /* ------------------------------------------------------------------------ */
 /**
@@ -150,6 +225,30 @@ class ConstObject;   //< Specialized object in Value type
 class MutableArray;  //< Specialized array in MutableValue type
 class MutableObject; //< Specialized object in MutableValue type
 
+class Allocator;      //< Memory allocator passed to read/mutate/freeze
+struct ReadOptions;   //< Flags and allocator passed to read
+class ParseSession;   //< Arena recycled across many parses
+class DocumentBatch;  //< Many small documents in one shared arena
+struct MemoryUsage;   //< Bytes and values held by a document
+class MemoryTracker;  //< Allocator wrapper with high-water mark
+class WriteBuffer;    //< Reusable output buffer for write
+template <size_t N>
+class InlineDocument; //< Document parsed in its own fixed buffer
+class DocumentStream; //< Reader of NDJSON or concatenated json records
+
+struct ParallelOptions; //< Threads and chunk size for parallel processing
+class TaskPool;         //< Worker threads with work stealing
+class ParallelParser;   //< Parse json lines on a TaskPool
+class ParallelWriter;   //< Serialize large json on a TaskPool
+class IncrementalDocument; //< Parser fed with chunks of one json
+class MutableView;      //< Copy-on-write edits over a Document
+class OnDemandValue;    //< Lazy json node over raw text
+class OnDemandDocument; //< Raw text scanned only on access
+class Projection;       //< JSON Pointer paths kept when reading
+struct ValidateResult;  //< Error and statistics of validate()
+class StreamWriter;     //< Serialize json to stream in chunks
+class JsonWriter;       //< Build json text directly without nodes
+
 /* @Section 1.3: Type and Operator Constants */
 /* ------------------------------------------------------------------------ */
 
@@ -171,6 +270,14 @@ constexpr EmptyString kString;
 constexpr EmptyArray kArray;
 constexpr EmptyObject kObject;
 
+/// Flags for Document::mmapFile, combined by bitwise or.
+enum MmapFlag : unsigned
+{
+    kMmapSequential = 0x1, //< madvise(MADV_SEQUENTIAL) before parsing
+    kMmapPopulate = 0x2,   //< prefault pages, MADV_WILLNEED if in-situ
+    kMmapInsitu = 0x4,     //< private copy-on-write mapping parsed in-situ
+};
+
 // Type representative constants for underlying pointers
 constexpr yyjson_val* kNode = nullptr;
 constexpr yyjson_mut_val* kMutNode = nullptr;
@@ -215,20 +322,24 @@ namespace trait
 /**
  * @brief Check if type T is a JSON value wrapper
  * 
- * Specialized for both Value and MutableValue types.
+ * Specialized for Value, MutableValue and OnDemandValue types.
  */
 template<typename T> struct is_value : std::false_type {};
 template<> struct is_value<Value> : std::true_type {};
 template<> struct is_value<MutableValue> : std::true_type {};
+template<> struct is_value<OnDemandValue> : std::true_type {};
 
 /**
  * @brief Check if type T is a JSON document wrapper
  * 
- * Specialized for both Document and MutableDocument types.
+ * Specialized for Document, MutableDocument, OnDemandDocument and
+ * InlineDocument types.
  */
 template<typename T> struct is_document : std::false_type {};
 template<> struct is_document<Document> : std::true_type {};
 template<> struct is_document<MutableDocument> : std::true_type {};
+template<> struct is_document<OnDemandDocument> : std::true_type {};
+template<size_t N> struct is_document<InlineDocument<N>> : std::true_type {};
 
 /**
  * @brief Check if type T is a JSON iterator
@@ -407,6 +518,7 @@ public:
     bool isSint() const { return yyjson_is_sint(m_val); }
     bool isUint() const { return yyjson_is_uint(m_val); }
     bool isReal() const { return yyjson_is_real(m_val); }
+    bool isRaw() const { return yyjson_is_raw(m_val); }
     bool isString() const { return yyjson_is_str(m_val); }
     bool isArray() const { return yyjson_is_arr(m_val); }
     bool isObject() const { return yyjson_is_obj(m_val); }
@@ -522,6 +634,10 @@ public:
     std::string toString(bool pretty = false) const;
     int toInteger() const;
     double toNumber() const;
+
+    // Write json into reusable output, replacing its content.
+    bool write(std::string& output, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG) const;
+    bool write(WriteBuffer& output, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG) const;
     
     // Explicit type conversion operators
     explicit operator int() const { return toInteger(); }
@@ -532,6 +648,9 @@ public:
     bool equal(const Value& other) const;
     bool less(const Value& other) const;
 
+    // Structural hash consistent with equal(), independent of key order.
+    uint64_t hash(uint64_t seed = 0) const;
+
 private:
     yyjson_val* m_val = nullptr;
 };
@@ -568,6 +687,14 @@ public:
     explicit Document(const char* str, size_t len = 0);
     explicit Document(const std::string& str)
         : Document(str.c_str(), str.size()) {}
+    explicit Document(std::string&& str) { read(std::move(str)); }
+    // Parse with custom memory allocator or read options.
+    Document(const char* str, size_t len, const Allocator& alc);
+    Document(const std::string& str, const Allocator& alc)
+        : Document(str.c_str(), str.size(), alc) {}
+    Document(const char* str, size_t len, const ReadOptions& opt);
+    Document(const std::string& str, const ReadOptions& opt)
+        : Document(str.c_str(), str.size(), opt) {}
     
     // Conversion from MutableDocument
 #ifndef XYJSON_DISABLE_MUTABLE
@@ -608,18 +735,68 @@ public:
     // Access root value (returns new Value instance)
     Value root() const { return Value(yyjson_doc_get_root(m_doc)); }
 
+    // Bytes consumed by last read, useful with stop-when-done flag.
+    size_t readSize() const { return yyjson_doc_get_read_size(m_doc); }
+
+    // Memory held by values and strings, including in-situ input kept.
+    MemoryUsage memoryUsage() const;
+
     // Read from various source, string, file.
     bool read(const char* str, size_t len = 0);
     bool read(const std::string& str) { return read(str.c_str(), str.size()); }
     bool read(FILE* fp);
-    bool read(std::ifstream& ifs);
+    bool read(std::istream& is);
     bool readFile(const char* path);
+
+    // Read with custom memory allocator.
+    bool read(const char* str, size_t len, const Allocator& alc);
+    bool read(const std::string& str, const Allocator& alc) {
+        return read(str.c_str(), str.size(), alc);
+    }
+    bool read(FILE* fp, const Allocator& alc);
+    bool readFile(const char* path, const Allocator& alc);
+
+    // Read with yyjson flags and allocator in options.
+    bool read(const char* str, size_t len, const ReadOptions& opt);
+    bool read(const std::string& str, const ReadOptions& opt) {
+        return read(str.c_str(), str.size(), opt);
+    }
+    bool read(FILE* fp, const ReadOptions& opt);
+    bool readFile(const char* path, const ReadOptions& opt);
+
+    // Read in-situ, take over the string and keep it alive in document.
+    bool read(std::string&& str);
+    bool read(std::string&& str, const Allocator& alc);
+    bool read(std::string&& str, const ReadOptions& opt);
+    // Read in-situ if capacity has room for padding, otherwise copy it.
+    // The caller still owns the buffer and must keep it alive.
+    bool read(char* str, size_t len, size_t capacity);
+
+    // Read only the subtrees selected by projection, skip the others.
+    bool read(const char* str, size_t len, const Projection& proj);
+    bool read(const std::string& str, const Projection& proj) {
+        return read(str.c_str(), str.size(), proj);
+    }
+    bool read(const char* str, size_t len, const Projection& proj, const ReadOptions& opt);
+    bool read(const std::string& str, const Projection& proj, const ReadOptions& opt) {
+        return read(str.c_str(), str.size(), proj, opt);
+    }
+
+    // Read file via memory mapping, kept alive in document for in-situ.
+    bool mmapFile(const char* path, unsigned flags = kMmapSequential | kMmapInsitu);
     
     // Write to various target, string, file.
-    bool write(std::string& output) const;
+    // The string and buffer are reused, serialized in place without copy.
+    bool write(std::string& output, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG) const;
+    bool write(WriteBuffer& output, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG) const;
     bool write(FILE* fp) const;
     bool write(std::ofstream& ofs) const;
     bool writeFile(const char* path) const;
+#ifndef XYJSON_DISABLE_THREAD
+    // Write large document on threads, the same output as sequential.
+    bool write(std::string& output, const ParallelOptions& opt, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG) const;
+    bool write(FILE* fp, const ParallelOptions& opt, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG) const;
+#endif
 
     // Index access
     template <typename T>
@@ -628,8 +805,9 @@ public:
         return root().index(std::forward<T>(index));
     }
 
-    // Convert to mutable document
+    // Convert to mutable document, using the same allocator by default.
     MutableDocument mutate() const;
+    MutableDocument mutate(const Allocator& alc) const;
     
 private:
     yyjson_doc* m_doc = nullptr;
@@ -691,6 +869,7 @@ public:
     bool isSint() const { return yyjson_mut_is_sint(m_val); }
     bool isUint() const { return yyjson_mut_is_uint(m_val); }
     bool isReal() const { return yyjson_mut_is_real(m_val); }
+    bool isRaw() const { return yyjson_mut_is_raw(m_val); }
     bool isString() const { return yyjson_mut_is_str(m_val); }
     bool isArray() const { return yyjson_mut_is_arr(m_val); }
     bool isObject() const { return yyjson_mut_is_obj(m_val); }
@@ -919,6 +1098,10 @@ public:
     std::string toString(bool pretty = false) const;
     int toInteger() const;
     double toNumber() const;
+
+    // Write json into reusable output, replacing its content.
+    bool write(std::string& output, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG) const;
+    bool write(WriteBuffer& output, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG) const;
     
     // Explicit type conversion operators
     explicit operator int() const { return toInteger(); }
@@ -928,6 +1111,9 @@ public:
     // Comparison method
     bool equal(const MutableValue& other) const;
     bool less(const MutableValue& other) const;
+
+    // Structural hash consistent with equal(), independent of key order.
+    uint64_t hash(uint64_t seed = 0) const;
     
 private:
     yyjson_mut_val* m_val = nullptr;
@@ -969,10 +1155,18 @@ public:
     using value_type = MutableValue;
     
     // Constructors.
-    MutableDocument() : MutableDocument("{}") {}
+    MutableDocument();
     explicit MutableDocument(yyjson_mut_doc* doc);
     explicit MutableDocument(const char* str, size_t len = 0);
     explicit MutableDocument(const std::string& str) : MutableDocument(str.c_str(), str.size()) {}
+    // Empty object or parsed document with custom memory allocator.
+    explicit MutableDocument(const Allocator& alc);
+    MutableDocument(const char* str, size_t len, const Allocator& alc);
+    MutableDocument(const std::string& str, const Allocator& alc)
+        : MutableDocument(str.c_str(), str.size(), alc) {}
+    MutableDocument(const char* str, size_t len, const ReadOptions& opt);
+    MutableDocument(const std::string& str, const ReadOptions& opt)
+        : MutableDocument(str.c_str(), str.size(), opt) {}
     
     // Conversion from Document
     explicit MutableDocument(const Document& other);
@@ -1014,18 +1208,47 @@ public:
     // Set root value
     void setRoot(MutableValue val);
 
+    // Size the next pool growth for values and string bytes to be created.
+    bool reserve(size_t values, size_t strBytes = 0);
+
+    // Memory held by the value and string pools.
+    MemoryUsage memoryUsage() const;
+
     // Read from various source, string, file.
     bool read(const char* str, size_t len = 0);
     bool read(const std::string& str) { return read(str.c_str(), str.size()); }
     bool read(FILE* fp);
-    bool read(std::ifstream& ifs);
+    bool read(std::istream& is);
     bool readFile(const char* path);
+
+    // Read with custom memory allocator.
+    bool read(const char* str, size_t len, const Allocator& alc);
+    bool read(const std::string& str, const Allocator& alc) {
+        return read(str.c_str(), str.size(), alc);
+    }
+    bool read(FILE* fp, const Allocator& alc);
+    bool readFile(const char* path, const Allocator& alc);
+
+    // Read with yyjson flags and allocator in options.
+    bool read(const char* str, size_t len, const ReadOptions& opt);
+    bool read(const std::string& str, const ReadOptions& opt) {
+        return read(str.c_str(), str.size(), opt);
+    }
+    bool read(FILE* fp, const ReadOptions& opt);
+    bool readFile(const char* path, const ReadOptions& opt);
     
     // Write to various target, string, file.
-    bool write(std::string& output) const;
+    // The string and buffer are reused, serialized in place without copy.
+    bool write(std::string& output, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG) const;
+    bool write(WriteBuffer& output, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG) const;
     bool write(FILE* fp) const;
     bool write(std::ofstream& ofs) const;
     bool writeFile(const char* path) const;
+#ifndef XYJSON_DISABLE_THREAD
+    // Write large document on threads, the same output as sequential.
+    bool write(std::string& output, const ParallelOptions& opt, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG) const;
+    bool write(FILE* fp, const ParallelOptions& opt, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG) const;
+#endif
     
     // Create methods for various types to create JSON nodes
     MutableValue create(yyjson_mut_val* value) const;
@@ -1047,8 +1270,11 @@ public:
         return root().index(std::forward<T>(index));
     }
 
-    // Convert to read-only document
-    Document freeze() const;
+    // Convert to read-only document, using the same allocator by default.
+    Document freeze() const&;
+    Document freeze(const Allocator& alc) const;
+    // Convert in place, taking over the strings, and release this document.
+    Document freeze() &&;
     
 private:
     yyjson_mut_doc* m_doc = nullptr;
@@ -1540,2002 +1766,7587 @@ public:
 };
 #endif // XYJSON_DISABLE_MUTABLE
 
-/* @Part 3: Non-Class Functions */
-/* ======================================================================== */
+/* @Section 2.6: Memory Allocator and Read Options */
+/* ------------------------------------------------------------------------ */
 
 /**
- * @brief Utility functions for JSON value creation and manipulation
- * 
- * This namespace contains helper functions that support the main class
- * functionality, providing value creation, type conversion, and other
- * utility operations used throughout the library.
+ * @brief Memory allocator wrapper for parsing and document conversion
+ *
+ * This class holds a yyjson_alc by value, and can be implicitly constructed
+ * from a raw `const yyjson_alc*` or a `std::pmr::memory_resource*`, so that
+ * per-request arenas can be put under Document and MutableDocument.
+ * A default constructed Allocator selects the libc allocator of yyjson.
+ *
+ * @note The allocator is copied into each document it creates, and also
+ *       inherited by mutate() and freeze() of that document. The underlying
+ *       context (memory resource, pool buffer) must outlive all of them.
  */
-namespace util
+class Allocator
 {
+public:
+    Allocator() : m_alc{nullptr, nullptr, nullptr, nullptr} {}
+    Allocator(const yyjson_alc* alc);
+#ifdef XYJSON_HAS_PMR
+    Allocator(std::pmr::memory_resource* resource);
+#endif
+
+    // Pool over caller buffer by yyjson_alc_pool_init, never use heap.
+    // Allocation always fails if the buffer is too small to init.
+    static Allocator pool(void* buf, size_t size);
+
+    // Whether to use default libc allocator
+    bool isDefault() const { return m_alc.malloc == nullptr; }
+
+    // Pointer passed to yyjson C API, nullptr for default allocator
+    const yyjson_alc* c_alc() const { return isDefault() ? nullptr : &m_alc; }
+
+private:
+    yyjson_alc m_alc;
+};
 
-/* @Section 3.1: Underlying mut_val Creation */
-/* ------------------------------------------------------------------------ */
 /**
- * @brief JSON value creation utilities for mutable operations
- * 
- * These functions create yyjson_mut_val instances from various C++ types,
- * handling type conversion and memory allocation through the provided
- * document. They form the foundation for mutable JSON operations.
+ * @brief Options to read json, including yyjson read flags and allocator
+ *
+ * Flags can be set by chained methods, for example:
+ * `doc.read(str, ReadOptions().allowComments().numberAsRaw())`.
+ *
+ * With `numberAsRaw()` or `bignumAsRaw()`, numbers are kept as raw strings
+ * and only parsed when read by get(), getor(), toNumber() or compared.
+ * The in-situ flag is ignored when reading from const input.
  */
+struct ReadOptions
+{
+    yyjson_read_flag flag = YYJSON_READ_NOFLAG;
+    Allocator alc;
+    yyjson_read_err* err = nullptr; //< optional output of error detail
+
+    ReadOptions() {}
+    explicit ReadOptions(yyjson_read_flag flg) : flag(flg) {}
+    ReadOptions(const Allocator& allocator) : alc(allocator) {}
+    ReadOptions(yyjson_read_flag flg, const Allocator& allocator)
+        : flag(flg), alc(allocator) {}
+
+    // Chained setters.
+    ReadOptions& set(yyjson_read_flag flg) { flag |= flg; return *this; }
+    ReadOptions& numberAsRaw() { return set(YYJSON_READ_NUMBER_AS_RAW); }
+    ReadOptions& bignumAsRaw() { return set(YYJSON_READ_BIGNUM_AS_RAW); }
+    ReadOptions& allowComments() { return set(YYJSON_READ_ALLOW_COMMENTS); }
+    ReadOptions& allowTrailingCommas() { return set(YYJSON_READ_ALLOW_TRAILING_COMMAS); }
+    ReadOptions& allowInfAndNan() { return set(YYJSON_READ_ALLOW_INF_AND_NAN); }
+    ReadOptions& stopWhenDone() { return set(YYJSON_READ_STOP_WHEN_DONE); }
+    ReadOptions& allocator(const Allocator& allocator) { alc = allocator; return *this; }
+    ReadOptions& error(yyjson_read_err* output) { err = output; return *this; }
+};
 
-#ifndef XYJSON_DISABLE_MUTABLE
-
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, std::nullptr_t = nullptr)
+/**
+ * @brief Reusable arena that recycles one buffer across many parses
+ *
+ * Each parse reserves the buffer to `yyjson_read_max_memory_usage()` of the
+ * input, growing geometrically when no document is alive. Blocks are bumped
+ * from the buffer, and when the last document handed out is freed, the
+ * whole buffer is recycled for the next parse, without touching the heap.
+ * Allocation that can not fit in the buffer falls back to libc malloc.
+ *
+ * @note Not thread-safe. The session must outlive all documents created
+ *       from it, including those converted by mutate() or freeze().
+ */
+class ParseSession
 {
-    return yyjson_mut_null(doc);
-}
+public:
+    explicit ParseSession(size_t capacity = 0) { reserve(capacity); }
+    ~ParseSession() { ::free(m_buf); }
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, bool value)
-{
-    return yyjson_mut_bool(doc, value);
-}
+    ParseSession(const ParseSession&) = delete;
+    ParseSession& operator=(const ParseSession&) = delete;
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, int value)
-{
-    return yyjson_mut_int(doc, value);
-}
+    // Parse a document with memory from this session.
+    Document parse(const char* str, size_t len = 0);
+    Document parse(const std::string& str) { return parse(str.c_str(), str.size()); }
+    Document parse(const char* str, size_t len, yyjson_read_flag flg, yyjson_read_err* err = nullptr);
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, int64_t value)
-{
-    return yyjson_mut_sint(doc, value);
-}
+    // Grow buffer to at least capacity bytes, only when no document alive.
+    bool reserve(size_t capacity);
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, uint64_t value)
-{
-    return yyjson_mut_uint(doc, value);
-}
+    // Allocator to pass to other read methods.
+    Allocator allocator() const { return Allocator(&m_alc); }
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, double value)
-{
-    return yyjson_mut_real(doc, value);
-}
+    size_t capacity() const { return m_size; }
+    size_t used() const { return m_used; }
+    size_t liveBlocks() const { return m_live; }
 
-inline yyjson_mut_val* createObject(yyjson_mut_doc* doc)
-{
-    return yyjson_mut_obj(doc);
-}
+private:
+    static constexpr size_t kAlign = alignof(std::max_align_t);
+    static size_t alignSize(size_t size) { return (size + kAlign - 1) & ~(kAlign - 1); }
+    bool owns(void* ptr) const { return ptr >= m_buf && ptr < m_buf + m_size; }
+
+    static void* malloc(void* ctx, size_t size);
+    static void* realloc(void* ctx, void* ptr, size_t old_size, size_t size);
+    static void free(void* ctx, void* ptr);
+
+    char* m_buf = nullptr;
+    size_t m_size = 0;
+    size_t m_used = 0;
+    size_t m_live = 0;
+    yyjson_alc m_alc = {&ParseSession::malloc, &ParseSession::realloc, &ParseSession::free, this};
+};
 
-inline yyjson_mut_val* createArray(yyjson_mut_doc* doc)
+/**
+ * @brief Many small documents parsed into one shared arena
+ *
+ * The arena is a ParseSession reserved once for the worst case memory of
+ * all inputs, so that each document costs no heap allocation, and all are
+ * released together. The batch can be reused, when the next batch parsed,
+ * documents of the last one are freed and the arena is recycled.
+ *
+ * Inputs can be any range of items convertible to std::string_view, such
+ * as std::vector<std::string_view>, std::vector<std::string>, or std::span.
+ * Invalid inputs result in invalid documents at their positions, and the
+ * error of the first one is reported by `ReadOptions::err` if provided.
+ *
+ * @note Documents can not outlive the batch, even if moved out.
+ *       The allocator of ReadOptions is not used, as the arena is.
+ *
+ * Example:
+ * @code
+ * DocumentBatch batch = parseMany(messages);
+ * for (const Document& doc : batch) { int id = doc / "id" | 0; }
+ * @endcode
+ */
+class DocumentBatch
 {
-    return yyjson_mut_arr(doc);
-}
+public:
+    DocumentBatch() {}
+    DocumentBatch(DocumentBatch&&) = default;
+    DocumentBatch& operator=(DocumentBatch&& other) noexcept {
+        // documents must be freed before their arena
+        if (this != &other) {
+            m_docs = std::move(other.m_docs);
+            m_session = std::move(other.m_session);
+        }
+        return *this;
+    }
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, const char* value, size_t len)
-{
-    return yyjson_mut_strncpy(doc, value, len);
-}
+    // Parse all inputs, free the last batch, return count of valid ones.
+    template <typename Range>
+    size_t parse(const Range& strs, const ReadOptions& opt = ReadOptions());
 
-template<typename T>
-inline typename std::enable_if<trait::is_cstr_type<T>(), yyjson_mut_val*>::type
-create(yyjson_mut_doc* doc, T value)
-{
-    return create(doc, value, ::strlen(value));
-}
+    // Free all documents, keep the arena for reuse.
+    void clear() { m_docs.clear(); }
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, const std::string& value)
-{
-    return create(doc, value.c_str(), value.size());
-}
+    size_t size() const { return m_docs.size(); }
+    bool empty() const { return m_docs.empty(); }
+    size_t validCount() const;
 
-// For string literals, use reference optimization (yyjson_mut_strn)
-// since literals have static lifetime and don't need copying.
-// Special handling for empty object and array literals
-template <size_t N>
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, const char(&value)[N])
-{
-    if (N == 3)
-    {
-        if (::strcmp(value, "{}") == 0) { return createObject(doc); }
-        if (::strcmp(value, "[]") == 0) { return createArray(doc); }
-    }
-    return yyjson_mut_strn(doc, value, N-1);
-}
+    // Access document and its root by index.
+    const Document& at(size_t i) const { return m_docs[i]; }
+    Value operator[](size_t i) const { return m_docs[i].root(); }
 
-// For char arrays (mutable), use copy instead of reference optimization
+    std::vector<Document>::const_iterator begin() const { return m_docs.begin(); }
+    std::vector<Document>::const_iterator end() const { return m_docs.end(); }
+
+    // Bytes of the shared arena.
+    size_t capacity() const { return m_session ? m_session->capacity() : 0; }
+
+private:
+    std::unique_ptr<ParseSession> m_session;
+    std::vector<Document> m_docs; //< destroyed before the session
+};
+
+// Parse many small documents into one DocumentBatch.
+template <typename Range>
+DocumentBatch parseMany(const Range& strs, const ReadOptions& opt = ReadOptions());
+
+/**
+ * @brief Document parsed into its own fixed buffer without heap allocation
+ *
+ * The buffer of N bytes is a member, so the document can be placed on
+ * stack or in static storage, and each read re-initializes a pool allocator
+ * over it. Read fails cleanly when the buffer is too small, roughly the
+ * input size plus 16 bytes per value with some overhead, see
+ * `yyjson_read_max_memory_usage()`.
+ *
+ * It is built on Document privately, so it can not be taken as Document
+ * to move out or to read otherwise. Only reading from string is provided,
+ * the others such as from file, stream, projection or in-situ would
+ * allocate on heap. The read-only access of Document is the same.
+ *
+ * @note Not copyable nor movable, as the values live inside the object.
+ *       mutate() and `~doc` allocate on heap by default, as the next read
+ *       recycles the buffer; do not pass the pool allocator to mutate().
+ *
+ * Example:
+ * @code
+ * InlineDocument<4096> doc(message);
+ * if (!doc) { ... } // too small or invalid
+ * @endcode
+ */
 template <size_t N>
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, char(&value)[N])
+class InlineDocument : private Document
 {
-    // Always copy mutable arrays, may have '\0' in middle
-    return yyjson_mut_strcpy(doc, value);
-}
+public:
+    using Document::value_type;
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, StringRef value)
-{
-    if (value.len == 2)
+    InlineDocument() {}
+    explicit InlineDocument(const char* str, size_t len = 0) { read(str, len); }
+    explicit InlineDocument(const std::string& str) { read(str); }
+    ~InlineDocument() { free(); }
+
+    InlineDocument(const InlineDocument&) = delete;
+    InlineDocument& operator=(const InlineDocument&) = delete;
+    InlineDocument(InlineDocument&&) = delete;
+    InlineDocument& operator=(InlineDocument&&) = delete;
+
+    // Read only from const input, the allocator in options is ignored.
+    bool read(const char* str, size_t len = 0) { return read(str, len, ReadOptions()); }
+    bool read(const std::string& str) { return read(str.c_str(), str.size()); }
+    bool read(const char* str, size_t len, const ReadOptions& opt)
     {
-        if (::strcmp(value, "{}") == 0) { return createObject(doc); }
-        if (::strcmp(value, "[]") == 0) { return createArray(doc); }
-    }
+        free();
+        if (len == 0 && str) len = strlen(str);
+        ReadOptions local(opt.flag, Allocator::pool(m_buf, N));
+        local.err = opt.err;
+        return Document::read(str, len, local);
+    }
+    bool read(const std::string& str, const ReadOptions& opt) {
+        return read(str.c_str(), str.size(), opt);
+    }
+    // Copied into the buffer, not in-situ.
+    bool read(std::string&& str) { return read(str.c_str(), str.size()); }
+    bool read(std::string&& str, const ReadOptions& opt) {
+        return read(str.c_str(), str.size(), opt);
+    }
+    using Document::free;
+
+    // The same read-only access as Document.
+    using Document::isValid;
+    using Document::hasError;
+    using Document::operator!;
+    using Document::operator bool;
+    using Document::get;
+    using Document::c_doc;
+    using Document::root;
+    using Document::readSize;
+    using Document::memoryUsage;
+    using Document::write;
+    using Document::writeFile;
+    using Document::operator[];
 
-    return yyjson_mut_str(doc, value);
-}
+#ifndef XYJSON_DISABLE_MUTABLE
+    // Convert to mutable document on heap, or with given allocator.
+    MutableDocument mutate() const { return Document::mutate(Allocator()); }
+    MutableDocument mutate(const Allocator& alc) const { return Document::mutate(alc); }
+#endif
 
-// Overloads for empty-type sentinels
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, EmptyArray)
-{
-    return createArray(doc);
-}
+    static constexpr size_t capacity() { return N; }
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, EmptyObject)
-{
-    return createObject(doc);
-}
+private:
+    alignas(std::max_align_t) char m_buf[N];
+};
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, EmptyString)
+/**
+ * @brief Memory held by a document, returned by memoryUsage()
+ *
+ * For Document, yyjson does not record the spare capacity of its value
+ * block, so `allocated` equals `used`, and the input buffer kept for
+ * in-situ reading is counted as strings. For MutableDocument, `allocated`
+ * is the sum of pool chunks, and `used` excludes the unused tail of them.
+ * Use MemoryTracker to measure the exact bytes from allocator.
+ */
+struct MemoryUsage
 {
-    return yyjson_mut_strncpy(doc, "", 0);
-}
+    size_t allocated = 0; //< bytes requested from allocator
+    size_t used = 0;      //< bytes occupied by header, values and strings
+    size_t values = 0;    //< count of value slots used
+    size_t strings = 0;   //< bytes of string pool or kept input
+};
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, ZeroNumber)
+/**
+ * @brief Allocator wrapper that counts live bytes and high-water mark
+ *
+ * Every block is forwarded to the inner allocator with a small header that
+ * records its size, so that free can be accounted. Pass `allocator()` to
+ * read or MutableDocument to measure the peak memory of a workload.
+ *
+ * @note Not thread-safe. The tracker must outlive all documents using it.
+ *
+ * Example:
+ * @code
+ * MemoryTracker tracker;
+ * Document doc(json, ReadOptions(tracker.allocator()));
+ * size_t peak = tracker.peak();
+ * @endcode
+ */
+class MemoryTracker
 {
-    return yyjson_mut_real(doc, 0.0);
-}
+public:
+    explicit MemoryTracker(const Allocator& inner = Allocator());
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, yyjson_val* src)
-{
-    return yyjson_val_mut_copy(doc, src);
-}
+    MemoryTracker(const MemoryTracker&) = delete;
+    MemoryTracker& operator=(const MemoryTracker&) = delete;
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, yyjson_doc* src)
-{
-    return create(doc, yyjson_doc_get_root(src));
-}
+    // Allocator to pass to read methods or MutableDocument.
+    Allocator allocator() const { return Allocator(&m_alc); }
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, const Value& src)
-{
-    return create(doc, src.get());
-}
+    size_t current() const { return m_current; }
+    size_t peak() const { return m_peak; }
+    size_t blocks() const { return m_blocks; }
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, const Document& src)
-{
-    return create(doc, src.root());
-}
+    // Restart the high-water mark from current bytes.
+    void resetPeak() { m_peak = m_current; }
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, yyjson_mut_val* src)
-{
-    return yyjson_mut_val_mut_copy(doc, src);
-}
+private:
+    static constexpr size_t kHeader = alignof(std::max_align_t);
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, yyjson_mut_doc* src)
-{
-    return create(doc, yyjson_mut_doc_get_root(src));
-}
+    static void* malloc(void* ctx, size_t size);
+    static void* realloc(void* ctx, void* ptr, size_t old_size, size_t size);
+    static void free(void* ctx, void* ptr);
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, const MutableValue& src)
-{
-    return create(doc, src.get());
-}
+    yyjson_alc m_inner;
+    size_t m_current = 0;
+    size_t m_peak = 0;
+    size_t m_blocks = 0;
+    yyjson_alc m_alc = {&MemoryTracker::malloc, &MemoryTracker::realloc, &MemoryTracker::free, this};
+};
 
-// Move semantics overload for MutableValue&&
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, MutableValue&& src)
+/**
+ * @brief Output buffer reused across many write calls
+ *
+ * The buffer is handed to yyjson writer as its allocator, so json is
+ * serialized in place, without the extra malloc, strlen and copy of the
+ * returned string. The capacity is kept, and once grown to the largest
+ * output, later writes do not touch the heap. Its own memory comes from
+ * the allocator given in constructor.
+ *
+ * @note Not thread-safe, use one buffer per thread.
+ *
+ * Example:
+ * @code
+ * WriteBuffer buffer;
+ * for (auto& doc : responses) {
+ *     doc.write(buffer);
+ *     send(buffer.data(), buffer.size());
+ * }
+ * @endcode
+ */
+class WriteBuffer
 {
-    // Check if this MutableValue can be moved (same document)
-    if (src.getDoc() == doc) {
-        yyjson_mut_val* result = src.get();
-        src.setMoved();
-        return result;
-    }
-    return create(doc, src.get());
-}
+public:
+    explicit WriteBuffer(const Allocator& alc = Allocator());
+    ~WriteBuffer();
 
-inline yyjson_mut_val* create(yyjson_mut_doc* doc, const MutableDocument& src)
-{
-    return create(doc, src.root());
-}
+    WriteBuffer(const WriteBuffer&) = delete;
+    WriteBuffer& operator=(const WriteBuffer&) = delete;
+
+    // Output of last write, null terminated.
+    const char* data() const { return m_size > 0 ? m_data : ""; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    std::string_view view() const { return std::string_view(data(), m_size); }
+    std::string str() const { return std::string(data(), m_size); }
+
+    size_t capacity() const { return m_capacity; }
+    bool reserve(size_t capacity);
+    void clear() { m_size = 0; }
+
+    // Allocator to pass to yyjson write functions, then commit the result.
+    yyjson_alc c_alc() { return yyjson_alc{&WriteBuffer::malloc, &WriteBuffer::realloc, &WriteBuffer::free, this}; }
+    bool commit(char* json, size_t len);
+
+private:
+    static void* malloc(void* ctx, size_t size);
+    static void* realloc(void* ctx, void* ptr, size_t old_size, size_t size);
+    static void free(void* ctx, void* ptr);
+
+    yyjson_alc m_inner;
+    char* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_capacity = 0;
+    bool m_busy = false; //< buffer handed out to writer
+};
+
+/* @Section 2.7: Document Stream */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Reader that yields one Document per record of a json stream
+ *
+ * The source can be a memory buffer, a `FILE*` or a file descriptor, which
+ * contains NDJSON (json lines) or any whitespace separated json values.
+ * Each record is parsed with `YYJSON_READ_STOP_WHEN_DONE` from a window
+ * that grows when a record is truncated, so the cost is not related to
+ * the remaining size of source. File source is read in chunks.
+ *
+ * Memory is allocated from a ParseSession owned by the stream, that is
+ * recycled when the document passed to next() is freed before parsing the
+ * next record, unless an allocator is given in ReadOptions.
+ *
+ * @note The documents must not outlive the stream unless allocator given.
+ *
+ * Example:
+ * @code
+ * DocumentStream stream(fp);
+ * Document doc;
+ * while (stream.next(doc)) { ... stream.offset() ... }
+ * if (stream.hasError()) { ... stream.error().pos ... }
+ * @endcode
+ */
+class DocumentStream
+{
+public:
+    explicit DocumentStream(const char* str, size_t len = 0, const ReadOptions& opt = ReadOptions());
+    explicit DocumentStream(const std::string& str, const ReadOptions& opt = ReadOptions())
+        : DocumentStream(str.c_str(), str.size(), opt) {}
+    explicit DocumentStream(FILE* fp, const ReadOptions& opt = ReadOptions());
+#ifdef XYJSON_HAS_UNISTD
+    explicit DocumentStream(int fd, const ReadOptions& opt = ReadOptions());
+#endif
+
+    DocumentStream(const DocumentStream&) = delete;
+    DocumentStream& operator=(const DocumentStream&) = delete;
+
+    // Parse next record into doc, return false at end of source or error.
+    bool next(Document& doc);
+
+    // Byte offset and size of the last record in source.
+    size_t offset() const { return m_offset; }
+    size_t size() const { return m_size; }
+    // Count of records read so far.
+    size_t count() const { return m_count; }
+
+    // Error of invalid record, its pos is offset in source.
+    bool hasError() const { return m_err.code != YYJSON_READ_SUCCESS; }
+    const yyjson_read_err& error() const { return m_err; }
+
+private:
+    static constexpr size_t kChunk = 64 * 1024;
+    static constexpr size_t kWindow = 1024;
+
+    bool fill();
+    Document parse(size_t window, yyjson_read_err* err);
+
+    const char* m_data = nullptr; //< memory source or m_buffer
+    size_t m_pos = 0;  //< begin of unread data in m_data
+    size_t m_end = 0;  //< end of valid data in m_data
+    size_t m_base = 0; //< offset of m_data in source
+    bool m_eof = true;
+
+    std::string m_buffer;
+    FILE* m_fp = nullptr;
+    int m_fd = -1;
+
+    yyjson_read_flag m_flag = YYJSON_READ_NOFLAG;
+    Allocator m_alc;
+    ParseSession m_session;
+    yyjson_read_err m_err = {YYJSON_READ_SUCCESS, nullptr, 0};
+
+    size_t m_window = kWindow;
+    size_t m_offset = 0;
+    size_t m_size = 0;
+    size_t m_count = 0;
+};
+
+/* @Section 2.8: Parallel Processing */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Options for parallel parsing and writing
+ */
+struct ParallelOptions
+{
+    size_t threads = 0;         //< total threads, 0 for hardware concurrency
+    size_t chunkSize = 1 << 20; //< approximate bytes of input per task
+    bool ordered = true;        //< deliver results in input order
+
+    ParallelOptions() {}
+    explicit ParallelOptions(size_t n, bool inOrder = true)
+        : threads(n), ordered(inOrder) {}
+};
+
+#ifndef XYJSON_DISABLE_THREAD
+/**
+ * @brief Pool of worker threads running indexed tasks with work stealing
+ *
+ * Tasks [0, count) are dealt round-robin to per-thread deques. A thread
+ * takes task from the front of its own deque, and steals from the back of
+ * others when its own is empty, so tasks are roughly started in index order
+ * while the load is still balanced. The thread calling wait() also helps.
+ *
+ * If a task throws, the remaining tasks of the run are skipped, and the
+ * first exception is rethrown by wait() after all started tasks finished.
+ *
+ * @note Call wait() before starting next tasks.
+ */
+class TaskPool
+{
+public:
+    explicit TaskPool(size_t threads = 0);
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    // Total threads to run tasks, including the caller of wait().
+    size_t size() const { return m_workers.size() + 1; }
+
+    // Start tasks [0, count) in background.
+    void start(size_t count, std::function<void(size_t)> func);
+    // Help running and wait until all started tasks finished,
+    // then rethrow the first exception from tasks if any.
+    void wait();
+    // Start and wait tasks.
+    void run(size_t count, std::function<void(size_t)> func)
+    {
+        start(count, std::move(func));
+        wait();
+    }
+
+    /// Wait on scope exit, so that tasks running in background never
+    /// outlive the locals they use, even if the caller throws. Exception
+    /// from tasks is dropped here, as another one is propagating.
+    class WaitGuard
+    {
+    public:
+        explicit WaitGuard(TaskPool& pool) : m_pool(pool) {}
+        ~WaitGuard() { m_pool.drain(); m_pool.m_error = nullptr; }
+        WaitGuard(const WaitGuard&) = delete;
+        WaitGuard& operator=(const WaitGuard&) = delete;
+
+    private:
+        TaskPool& m_pool;
+    };
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    bool take(size_t id, size_t& task);
+    void runTask(size_t task);
+    void finish();
+    void drain();
+    void work(size_t id);
+
+    std::vector<std::thread> m_workers;
+    std::unique_ptr<Queue[]> m_queues; //< one per thread, last for caller
+    std::function<void(size_t)> m_func;
+    std::atomic<size_t> m_pending{0};
+    std::atomic<bool> m_failed{false}; //< skip the rest tasks after throw
+    std::exception_ptr m_error;        //< first exception, under m_mutex
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    size_t m_round = 0;
+    bool m_stop = false;
+};
+
+/**
+ * @brief Parse line-delimited json (NDJSON) on a TaskPool
+ *
+ * The input is split at newline boundaries into chunks of about
+ * `chunkSize` bytes, and each chunk is parsed by a thread line by line.
+ * Each record is delivered to callback with its byte offset in input:
+ * - ordered: in input order on the calling thread, while the workers parse
+ *   the next batch of chunks, so memory is bounded to two batches;
+ * - unordered: on the worker threads right after parsed, so the callback
+ *   may be invoked concurrently and must be thread-safe.
+ *
+ * Invalid lines are also delivered as invalid Document, blank lines are
+ * skipped. The allocator in ReadOptions, if given, must be thread-safe.
+ * If the callback throws, the rest chunks are skipped and the first
+ * exception is rethrown on the calling thread after all threads stopped.
+ *
+ * parseArray() loads one json that is a huge top-level array. A structural
+ * prepass over slices of about `chunkSize` bytes, in parallel, finds the
+ * commas between elements, then element ranges are parsed on threads and
+ * their values are copied after a new root into one Document, the same
+ * layout as sequential parsing. The input is copied once for in-situ
+ * reading, and values of each range are freed once copied, so the peak is
+ * about the input twice plus the values twice. Syntax error in a range is
+ * reported with its position in input, without parsing again. It falls
+ * back to sequential parsing for small input, other root type, flags that
+ * break the prepass (comments and trailing commas), or unbalanced quotes
+ * and brackets found by the prepass, which costs the prepass in addition.
+ */
+class ParallelParser
+{
+public:
+    using Callback = std::function<void(Document& doc, size_t offset)>;
+
+    explicit ParallelParser(const ParallelOptions& opt = ParallelOptions())
+        : m_opt(opt), m_pool(opt.threads) {}
+
+    // Total threads used to parse.
+    size_t threads() const { return m_pool.size(); }
+
+    // Parse NDJSON, return count of valid documents delivered.
+    size_t parseLines(const char* str, size_t len, const Callback& callback,
+        const ReadOptions& opt = ReadOptions());
+    size_t parseLines(const std::string& str, const Callback& callback,
+        const ReadOptions& opt = ReadOptions())
+    {
+        return parseLines(str.c_str(), str.size(), callback, opt);
+    }
+
+    // Parse one large top-level array into a single Document.
+    Document parseArray(const char* str, size_t len = 0,
+        const ReadOptions& opt = ReadOptions());
+    Document parseArray(const std::string& str, const ReadOptions& opt = ReadOptions())
+    {
+        return parseArray(str.c_str(), str.size(), opt);
+    }
+
+private:
+    ParallelOptions m_opt;
+    TaskPool m_pool;
+};
+
+/**
+ * @brief Serialize one large json on a TaskPool
+ *
+ * The children of a large top-level array or object are split into ranges
+ * of about `chunkSize` bytes, estimated by their count of values, and each
+ * range is serialized by a thread into its own chunk, in the same way as
+ * StreamWriter does. Chunks are handed to the target in order, a batch at
+ * a time while the next batch is being serialized, so the output is
+ * byte-identical to the sequential writer, and memory is bounded to two
+ * batches when writing to file, though a single child larger than one
+ * chunk is still written as one chunk. Values not larger than one chunk
+ * are written sequentially. The mutable tree does not record its size, so
+ * its children are walked to count first, at most one chunk each.
+ *
+ * Example:
+ * @code
+ * ParallelWriter writer(ParallelOptions(8));
+ * writer.write(doc.root(), fd, YYJSON_WRITE_PRETTY);
+ * @endcode
+ */
+class ParallelWriter
+{
+public:
+    explicit ParallelWriter(const ParallelOptions& opt = ParallelOptions())
+        : m_opt(opt), m_pool(opt.threads) {}
+
+    // Total threads used to write.
+    size_t threads() const { return m_pool.size(); }
+
+    // Write json of value into string replacing its content, or to file,
+    // the descriptor is written by writev(), false on invalid or error.
+    bool write(const Value& val, std::string& output, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG);
+    bool write(const Value& val, FILE* fp, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG);
+#ifdef XYJSON_HAS_UNISTD
+    bool write(const Value& val, int fd, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG);
+#endif
+#ifndef XYJSON_DISABLE_MUTABLE
+    bool write(const MutableValue& val, std::string& output, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG);
+    bool write(const MutableValue& val, FILE* fp, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG);
+#ifdef XYJSON_HAS_UNISTD
+    bool write(const MutableValue& val, int fd, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG);
+#endif
+#endif
+
+private:
+    // Receive a batch of chunks in order.
+    using Sink = std::function<bool(const std::string* chunks, size_t count)>;
+
+    size_t chunkValues() const;
+    template <typename valT>
+    bool isLarge(valT* val) const;
+    template <typename valT>
+    bool writeTree(valT* root, yyjson_write_flag flg, const Sink& sink);
+
+    template <typename jsonT>
+    bool writeString(const jsonT& json, std::string& output, yyjson_write_flag flg);
+    template <typename jsonT>
+    bool writeFile(const jsonT& json, FILE* fp, yyjson_write_flag flg);
+#ifdef XYJSON_HAS_UNISTD
+    template <typename jsonT>
+    bool writeFd(const jsonT& json, int fd, yyjson_write_flag flg);
+#endif
+
+    ParallelOptions m_opt;
+    TaskPool m_pool;
+};
+#endif // XYJSON_DISABLE_THREAD
+
+/* @Section 2.9: Incremental Document */
+/* ------------------------------------------------------------------------ */
+
+#ifdef XYJSON_HAS_INCR
+/**
+ * @brief Parser fed with chunks of one json as they arrive
+ *
+ * Wraps the yyjson incremental reader, so that parsing overlaps with I/O,
+ * such as receiving a request body from network. Chunks fed are appended
+ * to an owned buffer, which is allocated only once if the total size is
+ * known in advance, e.g. from Content-Length. Otherwise the buffer grows
+ * geometrically, and the incremental state restarts on each growth to parse
+ * the data fed again, which is amortized to about twice the work of one
+ * parse. Then an array or object root is completed as soon as it is closed,
+ * while a scalar root is completed in finish() when the end is known.
+ *
+ * Example:
+ * @code
+ * IncrementalDocument incr(contentLength);
+ * while (n = recv(...)) { if (!incr.feed(chunk, n)) break; }
+ * Document doc = incr.finish();
+ * @endcode
+ */
+class IncrementalDocument
+{
+public:
+    explicit IncrementalDocument(size_t total = 0, const ReadOptions& opt = ReadOptions());
+    ~IncrementalDocument() { clear(); }
+
+    IncrementalDocument(const IncrementalDocument&) = delete;
+    IncrementalDocument& operator=(const IncrementalDocument&) = delete;
+
+    // Append a chunk and parse as far as possible, false on error.
+    bool feed(const char* data, size_t len);
+    bool feed(const std::string& data) { return feed(data.data(), data.size()); }
+
+    // End of input, return the document, which is invalid on error.
+    Document finish();
+
+    // Start over for another json with expected total size.
+    void reset(size_t total = 0);
+
+    // The root value has been completely parsed before finish().
+    bool isComplete() const { return m_doc != nullptr; }
+    // Bytes fed so far.
+    size_t size() const { return m_size; }
+
+    bool hasError() const
+    {
+        return m_err.code != YYJSON_READ_SUCCESS && m_err.code != YYJSON_READ_ERROR_MORE;
+    }
+    const yyjson_read_err& error() const { return m_err; }
+
+private:
+    static constexpr size_t kChunk = 16 * 1024;
+
+    bool restart();
+    bool onlySpace(const char* data, size_t len, size_t offset);
+    void clear();
+
+    std::string m_buffer; //< stable while the state refers to it
+    size_t m_size = 0;
+    size_t m_total = 0;   //< expected total size, 0 if unknown
+    yyjson_incr_state* m_state = nullptr;
+    yyjson_doc* m_doc = nullptr;
+
+    yyjson_read_flag m_flag = YYJSON_READ_NOFLAG;
+    Allocator m_alc;
+    yyjson_read_err m_err = {YYJSON_READ_SUCCESS, nullptr, 0};
+};
+#endif // XYJSON_HAS_INCR
+
+/* @Section 2.10: Mutable View */
+/* ------------------------------------------------------------------------ */
+#ifndef XYJSON_DISABLE_MUTABLE
+
+/**
+ * @brief Copy-on-write overlay of edits over a read-only Document
+ *
+ * Edit values by JSON Pointer path without copying the whole document as
+ * mutate() does. Only the spine of edited paths is recorded as patches,
+ * while unmodified subtrees stay as references into the original document.
+ * The new values are created in a small MutableDocument owned by the view.
+ * write() combines them, serializing unmodified subtrees directly from the
+ * original, so the memory cost is proportional to the edits.
+ *
+ * Path semantics follow JSON Pointer: set() replaces an existing value or
+ * adds a new key to object, "-" as the last token appends to array. Array
+ * indexes always refer to the original positions, not shifted by removal.
+ *
+ * @note The original document must outlive the view and not be modified.
+ *
+ * Example:
+ * @code
+ * MutableView view(doc);
+ * view.set("/server/port", 8080);
+ * view.remove("/debug");
+ * std::string json = view.toString();
+ * @endcode
+ */
+class MutableView
+{
+public:
+    explicit MutableView(const Document& doc);
+
+    // Replace or add value at path, empty path for the root.
+    template <typename T>
+    bool set(const char* path, T&& value);
+    template <typename T>
+    bool set(const std::string& path, T&& value)
+    {
+        return set(path.c_str(), std::forward<T>(value));
+    }
+
+    // Remove value at path.
+    bool remove(const char* path, size_t len = 0);
+    bool remove(const std::string& path) { return remove(path.c_str(), path.size()); }
+
+    // Whether any edit has been made.
+    bool isModified() const { return m_root->isModified(); }
+
+    // Discard all edits.
+    void clear();
+
+    // Serialize the original document with edits applied, compact only.
+    bool write(std::string& output) const;
+    std::string toString() const;
+
+    // The original document and the one holding new values.
+    const Document& origin() const { return *m_origin; }
+    const MutableDocument& edits() const { return m_edit; }
+
+private:
+    struct Patch
+    {
+        std::string token;               //< key or index in parent
+        yyjson_val* origin = nullptr;    //< original value, null if added
+        yyjson_mut_val* key = nullptr;   //< key of added object member
+        yyjson_mut_val* value = nullptr; //< replacement of the subtree
+        bool removed = false;
+        std::vector<std::unique_ptr<Patch>> children;
+        std::vector<yyjson_mut_val*> appended; //< items appended to array
+
+        Patch* find(const std::string& name) const;
+        Patch* add(const std::string& name, yyjson_val* val);
+        void reset(yyjson_mut_val* val);
+        bool isModified() const;
+    };
+
+    bool setValue(const char* path, size_t len, yyjson_mut_val* value);
+    Patch* spine(const char* path, size_t len, size_t& pos, std::string& token);
+    bool writePatch(const Patch& patch, std::string& output) const;
+
+    const Document* m_origin;
+    MutableDocument m_edit;
+    std::unique_ptr<Patch> m_root;
+};
+
+#endif // XYJSON_DISABLE_MUTABLE
+
+/* @Section 2.11: On-Demand Document */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Json document that scans raw text only when values are accessed
+ *
+ * Unlike Document, no tree is built when reading. Each access by index,
+ * key or path scans the raw text from the current position, skipping the
+ * unneeded siblings by bracket matching, so extracting a few fields from a
+ * large json costs only the bytes before them. Only the visited leaf, or
+ * container when its content is required, is parsed by yyjson on demand,
+ * and cached in the document.
+ *
+ * The skipped text is not validated, so a malformed json may be accepted
+ * as long as the visited path is well-formed.
+ *
+ * @note Not thread-safe even for read, as the parse cache is shared.
+ *       The OnDemandValue refers to the document, which must outlive it.
+ *
+ * Example:
+ * @code
+ * OnDemandDocument doc(json);
+ * std::string name = doc / "user" / "name" | "";
+ * int price = doc / "/items/2/price" | 0;
+ * @endcode
+ */
+class OnDemandDocument
+{
+public:
+    using value_type = OnDemandValue;
+    struct State;
+
+    OnDemandDocument();
+    explicit OnDemandDocument(const char* str, size_t len = 0);
+    explicit OnDemandDocument(const std::string& str);
+    explicit OnDemandDocument(std::string&& str);
+    ~OnDemandDocument();
+
+    OnDemandDocument(const OnDemandDocument&) = delete;
+    OnDemandDocument& operator=(const OnDemandDocument&) = delete;
+    OnDemandDocument(OnDemandDocument&& other) noexcept;
+    OnDemandDocument& operator=(OnDemandDocument&& other) noexcept;
+
+    // Keep a copy of text, or take over the string, nothing parsed yet.
+    bool read(const char* str, size_t len = 0);
+    bool read(const std::string& str) { return read(str.c_str(), str.size()); }
+    bool read(std::string&& str);
+    void free();
+
+    // Error checking, only empty text is detected before access.
+    bool isValid() const { return m_state != nullptr; }
+    bool hasError() const { return !isValid(); }
+    bool operator!() const { return hasError(); }
+    explicit operator bool() const { return isValid(); }
+
+    // Root value positioned at the first non-space char.
+    OnDemandValue root() const;
+
+    // Index access
+    template <typename T>
+    OnDemandValue operator[](T&& index) const;
+
+    // Number of values materialized by yyjson so far.
+    size_t parsedCount() const;
+
+    // Write the root as json, which materializes the whole text.
+    bool write(std::string& output, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG) const;
+
+private:
+    std::unique_ptr<State> m_state;
+};
+
+/**
+ * @brief Lazy json node referring to a position in the raw text
+ *
+ * It has the same read interface and operators as Value. Index and path
+ * access only scan the text, while value extraction, comparison and
+ * conversion materialize the node by value().
+ */
+class OnDemandValue
+{
+public:
+    OnDemandValue() {}
+    OnDemandValue(const char* pos, OnDemandDocument::State* state)
+        : m_pos(pos), m_state(state) {}
+
+    // Error checking
+    bool isValid() const { return m_pos != nullptr; }
+    bool hasError() const { return !isValid(); }
+    bool operator!() const { return hasError(); }
+    explicit operator bool() const { return isValid(); }
+
+    // Type checking by the first char, number kind needs parsing.
+    bool isNull() const { return m_pos && *m_pos == 'n'; }
+    bool isBool() const { return m_pos && (*m_pos == 't' || *m_pos == 'f'); }
+    bool isNumber() const { return m_pos && (*m_pos == '-' || (*m_pos >= '0' && *m_pos <= '9')); }
+    bool isInt() const { return isNumber() && value().isInt(); }
+    bool isSint() const { return isNumber() && value().isSint(); }
+    bool isUint() const { return isNumber() && value().isUint(); }
+    bool isReal() const { return isNumber() && value().isReal(); }
+    bool isString() const { return m_pos && *m_pos == '"'; }
+    bool isArray() const { return m_pos && *m_pos == '['; }
+    bool isObject() const { return m_pos && *m_pos == '{'; }
+    const char* typeName() const { return value().typeName(); }
+    yyjson_type getType() const;
+
+    template <typename T>
+    bool isType(const T& type) const { return value().isType(type); }
+    bool isType(const char* type) const { return value().isType(type); }
+
+    // Value extraction, same as Value after materialized.
+    template <typename T>
+    bool get(T& result) const { return value().get(result); }
+
+    template<typename T>
+    std::decay_t<T> getor(T&& defaultValue) const {
+        return value().getor(std::forward<T>(defaultValue));
+    }
+    const char* getor(EmptyString) const { return value().getor(kString); }
+    double getor(ZeroNumber) const { return value().getor(kNumber); }
+
+    template<typename funcT>
+    auto pipe(funcT&& func) const { return value().pipe(std::forward<funcT>(func)); }
+
+    // Array/Object size and access by index or key, scan text only.
+    size_t size() const;
+    OnDemandValue index(size_t idx) const;
+    OnDemandValue index(int idx) const { return index(static_cast<size_t>(idx)); }
+
+    OnDemandValue index(const char* key, size_t len) const;
+    OnDemandValue index(const std::string& key) const {
+        return index(key.c_str(), key.size());
+    }
+    template <size_t N>
+    OnDemandValue index(const char(&key)[N]) const { return index(key, N-1); }
+    template<typename T>
+    typename std::enable_if<trait::is_cstr_type<T>(), OnDemandValue>::type
+    index(T key) const { return index(key, key ? ::strlen(key) : 0); }
+
+    template <typename T>
+    OnDemandValue operator[](T&& index) const {
+        return this->index(std::forward<T>(index));
+    }
+
+    // Path operations, JSON Pointer if start with '/', otherwise a key.
+    OnDemandValue pathto(size_t idx) const { return index(idx); }
+    OnDemandValue pathto(int idx) const { return index(idx); }
+    OnDemandValue pathto(const char* path, size_t len) const;
+    OnDemandValue pathto(const std::string& path) const {
+        return pathto(path.c_str(), path.size());
+    }
+    template <size_t N>
+    OnDemandValue pathto(const char(&path)[N]) const { return pathto(path, N-1); }
+    template<typename T>
+    typename std::enable_if<trait::is_cstr_type<T>(), OnDemandValue>::type
+    pathto(T path) const {
+        return pathto(path, path ? ::strlen(path) : 0);
+    }
+
+    // Iterator over the materialized container, used by `json % arg`.
+    template <typename T>
+    auto iterator(T&& arg) const { return value().iterator(std::forward<T>(arg)); }
+
+    // Raw text of this value, not including trailing spaces.
+    std::string raw() const;
+
+    // Parse this value by yyjson, cached in the document.
+    Value value() const;
+
+    // Conversion methods
+    std::string toString(bool pretty = false) const { return value().toString(pretty); }
+    int toInteger() const { return value().toInteger(); }
+    double toNumber() const { return value().toNumber(); }
+
+    // Comparison method
+    bool equal(const OnDemandValue& other) const { return value().equal(other.value()); }
+    bool less(const OnDemandValue& other) const { return value().less(other.value()); }
+
+private:
+    const char* m_pos = nullptr;
+    OnDemandDocument::State* m_state = nullptr;
+};
+
+/* @Section 2.12: Projection */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Whitelist of JSON Pointer paths to keep when reading a document
+ *
+ * Reading with projection scans the raw text as OnDemandDocument does, and
+ * copies only the selected subtrees with the containers along their paths,
+ * then parses the reduced text, so no value is allocated for the skipped
+ * parts. A path token "*" matches every array item or object member.
+ *
+ * - Object members not in any path are dropped.
+ * - Array items not matched are dropped, so an index path like "/items/0"
+ *   results in an array of one item, while "*" keeps all items in order.
+ * - A scalar met where a deeper path is expected is dropped as member, and
+ *   kept as null as array item to preserve the positions.
+ * - An empty path "" keeps the whole document.
+ *
+ * @note The skipped text is not validated.
+ *
+ * Example:
+ * @code
+ * Document doc;
+ * doc.read(json, {"/user/id", "/tags/0"}); // {"user":{"id":1},"tags":["a"]}
+ * @endcode
+ */
+class Projection
+{
+public:
+    Projection() {}
+    Projection(std::initializer_list<const char*> paths);
+    explicit Projection(const std::vector<std::string>& paths);
+
+    // Add a JSON Pointer path, false if not start with '/' nor empty.
+    bool add(const char* path, size_t len = 0);
+    bool add(const std::string& path) { return add(path.c_str(), path.size()); }
+
+    // Whether no path is added, then nothing is projected out.
+    bool empty() const { return !m_root.keep && m_root.children.empty(); }
+
+    // Copy projected json text of input to output, false if malformed.
+    bool apply(const char* str, size_t len, std::string& output) const;
+
+private:
+    struct Node
+    {
+        std::string name;
+        size_t index = static_cast<size_t>(-1); //< if name is array index
+        bool any = false;  //< match any by "*"
+        bool keep = false; //< keep the whole subtree
+        std::vector<Node> children;
+    };
+    using Nodes = std::vector<const Node*>;
+
+    const char* emit(const char* p, const char* end, const Nodes& nodes, std::string& output) const;
+    const char* emitObject(const char* p, const char* end, const Nodes& nodes, std::string& output) const;
+    const char* emitArray(const char* p, const char* end, const Nodes& nodes, std::string& output) const;
+
+    Node m_root;
+};
+
+/* @Section 2.13: Validation */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Result of validate(), with error detail and size statistics
+ *
+ * The statistics count up to the error position if invalid, so they can
+ * also be used for admission control before actually parsing the input.
+ */
+struct ValidateResult
+{
+    yyjson_read_code code = YYJSON_READ_SUCCESS;
+    const char* msg = nullptr; //< error message, nullptr if valid
+    size_t pos = 0;      //< error byte position in input
+    size_t depth = 0;    //< max nesting level of containers, 0 for scalar
+    size_t values = 0;   //< count of values including keys, as the parsed doc
+    size_t readSize = 0; //< bytes consumed, less than input by stopWhenDone
+
+    bool isValid() const { return code == YYJSON_READ_SUCCESS; }
+    explicit operator bool() const { return isValid(); }
+};
+
+// Check json syntax and UTF-8 encoding without building values.
+// Read flags for comments, trailing commas, inf/nan, invalid unicode
+// and stop-when-done are respected, the allocator is never used.
+ValidateResult validate(const char* str, size_t len = 0, const ReadOptions& opt = ReadOptions());
+ValidateResult validate(const std::string& str, const ReadOptions& opt = ReadOptions());
+
+/* @Section 2.14: Stream Writer */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Writer that serializes json to a stream in bounded chunks
+ *
+ * The target can be a `std::streambuf` (or `std::ostream`), a `FILE*` or a
+ * file descriptor. Small subtrees are serialized by yyjson into a reused
+ * scratch buffer, while the brackets, keys and separators of large
+ * containers are emitted here, so the memory does not grow with the size
+ * of document. The output is the same as yyjson writer with the same
+ * flags, including pretty mode, which re-indents nested subtrees.
+ *
+ * Example:
+ * @code
+ * StreamWriter writer(std::cout, YYJSON_WRITE_PRETTY);
+ * writer.write(doc);
+ * @endcode
+ */
+class StreamWriter
+{
+public:
+    explicit StreamWriter(std::streambuf* sb, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG)
+        : m_sb(sb), m_flag(flg) {}
+    explicit StreamWriter(std::ostream& os, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG)
+        : m_sb(os.rdbuf()), m_flag(flg) {}
+    explicit StreamWriter(FILE* fp, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG)
+        : m_fp(fp), m_flag(flg) {}
+#ifdef XYJSON_HAS_UNISTD
+    explicit StreamWriter(int fd, yyjson_write_flag flg = YYJSON_WRITE_NOFLAG)
+        : m_fd(fd), m_flag(flg) {}
+#endif
+    ~StreamWriter() { flush(); }
+
+    StreamWriter(const StreamWriter&) = delete;
+    StreamWriter& operator=(const StreamWriter&) = delete;
+
+    // Write json of value or document root, false on invalid or error.
+    bool write(const Value& val);
+    bool write(const Document& doc) { return write(doc.root()); }
+#ifndef XYJSON_DISABLE_MUTABLE
+    bool write(const MutableValue& val);
+    bool write(const MutableDocument& doc) { return write(doc.root()); }
+#endif
+
+    // Write raw text, such as separator between documents.
+    bool append(const char* str, size_t len);
+
+    // Send the buffered chunk to target.
+    bool flush();
+
+    // Total bytes written, including those still buffered.
+    size_t size() const { return m_size; }
+    bool hasError() const { return m_error; }
+
+private:
+    static constexpr size_t kChunk = 64 * 1024;
+    static constexpr size_t kSmallValues = 4096; //< subtree serialized at once
+
+    bool pretty() const { return (m_flag & (YYJSON_WRITE_PRETTY | YYJSON_WRITE_PRETTY_TWO_SPACES)) != 0; }
+    bool send(const char* str, size_t len);
+    bool put(char c) { return append(&c, 1); }
+    bool newline(size_t level);
+    bool finish(bool ok);
+
+    template <typename valT>
+    bool emit(valT* val, size_t level);
+    template <typename valT>
+    bool emitSmall(valT* val, size_t level);
+    template <typename valT>
+    bool emitMember(valT* key, valT* child, size_t level);
+
+    friend class ParallelWriter;
+
+    std::streambuf* m_sb = nullptr;
+    FILE* m_fp = nullptr;
+    int m_fd = -1;
+    yyjson_write_flag m_flag = YYJSON_WRITE_NOFLAG;
+
+    std::string m_buffer;
+    WriteBuffer m_scratch;
+    size_t m_size = 0;
+    bool m_error = false;
+};
+
+/* @Section 2.15: Json Writer */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Builder that appends json text directly, without creating nodes
+ *
+ * The API mirrors MutableValue: `<<` pushes a value into the current array,
+ * or alternately a key and a value into the current object, and `*` binds
+ * a value with its key, as `w << w * 25 * "age"`. Containers are opened by
+ * beginObject()/beginArray() and closed by end(), or by the Scope returned
+ * from object()/array() when it goes out of scope.
+ *
+ * Strings are escaped by scanning 8 bytes a time, integers are formatted by
+ * std::to_chars, and real numbers by yyjson, the same as its writer.
+ * Value, MutableValue and Document are copied as their serialized json,
+ * and an invalid Value is written as null. Misuse, such as a value where a
+ * key is expected or an unmatched end(), marks the writer invalid, and the
+ * later writes are ignored.
+ *
+ * @note Strings are copied as is, they must be valid UTF-8.
+ *
+ * Example:
+ * @code
+ * JsonWriter w;
+ * {
+ *     auto root = w.object();
+ *     w << "name" << "Alice" << w * 25 * "age";
+ *     auto tags = w.array("tags");
+ *     w << "a" << "b";
+ * }
+ * send(w.data(), w.size()); // {"name":"Alice","age":25,"tags":["a","b"]}
+ * @endcode
+ */
+class JsonWriter
+{
+public:
+    /// Value bound by `w * value` waiting for its key.
+    template <typename T>
+    struct Item
+    {
+        T value;
+    };
+
+    /// Key and value pair bound by `*`, written by `<<` at once.
+    template <typename T, typename K = std::string_view>
+    struct Member
+    {
+        K key;
+        T value;
+    };
+
+    /// Key type kept in Member, owned if taken from a temporary string.
+    template <typename K>
+    using MemberKey = std::conditional_t<std::is_same<std::decay_t<K>, std::string>::value
+        && !std::is_lvalue_reference<K>::value, std::string, std::string_view>;
+
+    /// Close the container opened by object() or array() on destruction.
+    class Scope
+    {
+    public:
+        explicit Scope(JsonWriter* writer) : m_writer(writer) {}
+        Scope(Scope&& other) noexcept : m_writer(other.m_writer) { other.m_writer = nullptr; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope() { if (m_writer) m_writer->end(); }
+
+    private:
+        JsonWriter* m_writer;
+    };
+
+    JsonWriter() {}
+    explicit JsonWriter(size_t capacity) { m_out.reserve(capacity); }
+
+    // Output text and its state.
+    const std::string& str() const { return m_out; }
+    const char* data() const { return m_out.c_str(); }
+    size_t size() const { return m_out.size(); }
+    bool isValid() const { return !m_error; }
+    explicit operator bool() const { return isValid(); }
+    // Whether a whole json value is written with all containers closed.
+    bool isComplete() const { return !m_error && m_done; }
+
+    // Reset to write a new json, keep the capacity.
+    void clear();
+    void reserve(size_t capacity) { m_out.reserve(capacity); }
+    // Move out the output and reset.
+    std::string release();
+
+    // Open and close containers, with key if in object.
+    JsonWriter& beginObject();
+    JsonWriter& beginArray();
+    template <typename K>
+    JsonWriter& beginObject(K&& key) { return this->key(std::forward<K>(key)).beginObject(); }
+    template <typename K>
+    JsonWriter& beginArray(K&& key) { return this->key(std::forward<K>(key)).beginArray(); }
+    JsonWriter& end();
+
+    Scope object() { beginObject(); return Scope(this); }
+    Scope array() { beginArray(); return Scope(this); }
+    template <typename K>
+    Scope object(K&& key) { beginObject(std::forward<K>(key)); return Scope(this); }
+    template <typename K>
+    Scope array(K&& key) { beginArray(std::forward<K>(key)); return Scope(this); }
+
+    // Write object key, should be string.
+    JsonWriter& key(const char* str, size_t len);
+    template <typename K>
+    JsonWriter& key(K&& key);
+
+    // Write scalar, string, kArray/kObject or json of Value and Document.
+    JsonWriter& value(const char* str, size_t len);
+    template <typename T>
+    JsonWriter& value(T&& val);
+
+    // Write key and value into object.
+    template <typename K, typename T>
+    JsonWriter& add(K&& key, T&& val) { return this->key(std::forward<K>(key)).value(std::forward<T>(val)); }
+
+    // Write pre-serialized json text as a value.
+    JsonWriter& raw(const char* json, size_t len);
+
+    // Key or value depends on context, as MutableValue::push.
+    template <typename T>
+    JsonWriter& push(T&& val);
+
+private:
+    template <typename T> struct IsItem : std::false_type {};
+    template <typename T> struct IsItem<Item<T>> : std::true_type {};
+    template <typename T> struct IsMember : std::false_type {};
+    template <typename T, typename K> struct IsMember<Member<T, K>> : std::true_type {};
+
+    bool beforeValue();
+    bool beforeKey();
+    void afterValue() { if (m_stack.empty()) m_done = true; }
+    void appendString(const char* str, size_t len);
+    template <typename T>
+    void appendInteger(T val);
+    void appendReal(double val);
+    template <typename V>
+    void appendJson(V* val);
+
+    std::string m_out;
+    std::string m_stack;       //< open brackets
+    bool m_first = true;       //< no item yet in current container
+    bool m_hasKey = false;     //< key written, waiting for value
+    bool m_done = false;       //< root value finished
+    bool m_error = false;
+};
+
+/* @Part 3: Non-Class Functions */
+/* ======================================================================== */
+
+/**
+ * @brief Utility functions for JSON value creation and manipulation
+ * 
+ * This namespace contains helper functions that support the main class
+ * functionality, providing value creation, type conversion, and other
+ * utility operations used throughout the library.
+ */
+namespace util
+{
+
+/* @Section 3.1: Underlying mut_val Creation */
+/* ------------------------------------------------------------------------ */
+/**
+ * @brief JSON value creation utilities for mutable operations
+ * 
+ * These functions create yyjson_mut_val instances from various C++ types,
+ * handling type conversion and memory allocation through the provided
+ * document. They form the foundation for mutable JSON operations.
+ */
+
+#ifndef XYJSON_DISABLE_MUTABLE
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, std::nullptr_t = nullptr)
+{
+    return yyjson_mut_null(doc);
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, bool value)
+{
+    return yyjson_mut_bool(doc, value);
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, int value)
+{
+    return yyjson_mut_int(doc, value);
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, int64_t value)
+{
+    return yyjson_mut_sint(doc, value);
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, uint64_t value)
+{
+    return yyjson_mut_uint(doc, value);
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, double value)
+{
+    return yyjson_mut_real(doc, value);
+}
+
+inline yyjson_mut_val* createObject(yyjson_mut_doc* doc)
+{
+    return yyjson_mut_obj(doc);
+}
+
+inline yyjson_mut_val* createArray(yyjson_mut_doc* doc)
+{
+    return yyjson_mut_arr(doc);
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, const char* value, size_t len)
+{
+    return yyjson_mut_strncpy(doc, value, len);
+}
+
+template<typename T>
+inline typename std::enable_if<trait::is_cstr_type<T>(), yyjson_mut_val*>::type
+create(yyjson_mut_doc* doc, T value)
+{
+    return create(doc, value, ::strlen(value));
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, const std::string& value)
+{
+    return create(doc, value.c_str(), value.size());
+}
+
+// For string literals, use reference optimization (yyjson_mut_strn)
+// since literals have static lifetime and don't need copying.
+// Special handling for empty object and array literals
+template <size_t N>
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, const char(&value)[N])
+{
+    if (N == 3)
+    {
+        if (::strcmp(value, "{}") == 0) { return createObject(doc); }
+        if (::strcmp(value, "[]") == 0) { return createArray(doc); }
+    }
+    return yyjson_mut_strn(doc, value, N-1);
+}
+
+// For char arrays (mutable), use copy instead of reference optimization
+template <size_t N>
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, char(&value)[N])
+{
+    // Always copy mutable arrays, may have '\0' in middle
+    return yyjson_mut_strcpy(doc, value);
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, StringRef value)
+{
+    if (value.len == 2)
+    {
+        if (::strcmp(value, "{}") == 0) { return createObject(doc); }
+        if (::strcmp(value, "[]") == 0) { return createArray(doc); }
+    }
+
+    return yyjson_mut_str(doc, value);
+}
+
+// Overloads for empty-type sentinels
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, EmptyArray)
+{
+    return createArray(doc);
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, EmptyObject)
+{
+    return createObject(doc);
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, EmptyString)
+{
+    return yyjson_mut_strncpy(doc, "", 0);
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, ZeroNumber)
+{
+    return yyjson_mut_real(doc, 0.0);
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, yyjson_val* src)
+{
+    return yyjson_val_mut_copy(doc, src);
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, yyjson_doc* src)
+{
+    return create(doc, yyjson_doc_get_root(src));
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, const Value& src)
+{
+    return create(doc, src.get());
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, const Document& src)
+{
+    return create(doc, src.root());
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, yyjson_mut_val* src)
+{
+    return yyjson_mut_val_mut_copy(doc, src);
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, yyjson_mut_doc* src)
+{
+    return create(doc, yyjson_mut_doc_get_root(src));
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, const MutableValue& src)
+{
+    return create(doc, src.get());
+}
+
+// Move semantics overload for MutableValue&&
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, MutableValue&& src)
+{
+    // Check if this MutableValue can be moved (same document)
+    if (src.getDoc() == doc) {
+        yyjson_mut_val* result = src.get();
+        src.setMoved();
+        return result;
+    }
+    return create(doc, src.get());
+}
+
+inline yyjson_mut_val* create(yyjson_mut_doc* doc, const MutableDocument& src)
+{
+    return create(doc, src.root());
+}
 
 // Create key node for object insertion, with string literal optimization
 template<typename T>
-inline typename std::enable_if<trait::is_key_v<T>, yyjson_mut_val*>::type
-createKey(yyjson_mut_doc* doc, T&& key)
+inline typename std::enable_if<trait::is_key_v<T>, yyjson_mut_val*>::type
+createKey(yyjson_mut_doc* doc, T&& key)
+{
+    return create(doc, std::forward<T>(key));
+}
+
+template<typename T>
+inline typename std::enable_if<!trait::is_key_v<T>, yyjson_mut_val*>::type
+createKey(yyjson_mut_doc* doc, T&& key)
+{
+    return nullptr;
+}
+
+// Specialization for MutableValue key
+inline yyjson_mut_val* createKey(yyjson_mut_doc* doc, const MutableValue& key)
+{
+    if (key.isString()) {
+        return create(doc, key);
+    }
+    return nullptr;
+}
+
+// Move semantics overload for MutableValue&& key
+inline yyjson_mut_val* createKey(yyjson_mut_doc* doc, MutableValue&& key)
+{
+    if (key.isString()) {
+        return create(doc, std::move(key));
+    }
+    return nullptr;
+}
+
+#endif // XYJSON_DISABLE_MUTABLE
+
+/* @Section 3.2: Conversion Helper Functions */
+/* ------------------------------------------------------------------------ */
+/**
+ * @brief Type conversion and comparison utilities
+ * 
+ * These functions provide type conversion and comparison operations
+ * that work with both Value and MutableValue types, enabling unified
+ * handling of JSON values regardless of mutability.
+ */
+
+/**
+ * @brief Parse raw number string kept by NUMBER_AS_RAW or BIGNUM_AS_RAW
+ *
+ * The digits are parsed into a temporary value on each access, the
+ * document is not modified so it is still safe to be read by threads.
+ */
+inline bool readRawNumber(const char* raw, yyjson_val& num)
+{
+    if (yyjson_unlikely(!raw)) return false;
+    return yyjson_read_number(raw, &num, YYJSON_READ_ALLOW_INF_AND_NAN, nullptr, nullptr) != nullptr;
+}
+
+/// Get scalar from raw number as if it was parsed when reading.
+template<typename T>
+inline bool getRawNumber(const char* raw, T& result)
+{
+    yyjson_val num;
+    return readRawNumber(raw, num) && Value(&num).get(result);
+}
+
+/// Cast raw number to double, 0 if not valid number.
+inline double rawToNumber(const char* raw)
+{
+    yyjson_val num;
+    return readRawNumber(raw, num) ? yyjson_get_num(&num) : 0.0;
+}
+
+/**
+ * @brief Compare two JSON values using hybrid comparison logic
+ * 
+ * This function provides a comprehensive comparison of JSON values
+ * following these rules:
+ * 1. Invalid values are considered less than valid values
+ * 2. Values of different types are compared by type order
+ * 3. Values of the same type are compared by their actual values
+ * 4. Containers are compared by size first, then by pointer
+ * 
+ * @tparam T JSON value type (Value or MutableValue)
+ * @param lhs Left-hand side value
+ * @param rhs Right-hand side value
+ * @return bool True if lhs is less than rhs
+ */
+template<typename T>
+inline typename std::enable_if<trait::is_value<T>::value, bool>::type
+lessCompare(const T& lhs, const T& rhs)
+{
+    if (yyjson_unlikely(!lhs.isValid())) {
+        return rhs.isValid(); // an invalid value is less than a valid one
+    }
+    if (yyjson_unlikely(!rhs.isValid())) {
+        return false;
+    }
+
+    // raw is number read lazily by NUMBER_AS_RAW flag
+    auto lhs_type = lhs.getType();
+    auto rhs_type = rhs.getType();
+    if (lhs_type == YYJSON_TYPE_RAW) lhs_type = YYJSON_TYPE_NUM;
+    if (rhs_type == YYJSON_TYPE_RAW) rhs_type = YYJSON_TYPE_NUM;
+
+    if (lhs_type != rhs_type) {
+        return lhs_type < rhs_type;
+    }
+
+    switch (lhs_type) {
+        case YYJSON_TYPE_NULL:
+            return false; // nulls are equal
+
+        case YYJSON_TYPE_BOOL:
+            return (lhs.getor(false)) < (rhs.getor(false));
+
+        case YYJSON_TYPE_NUM: {
+            return lhs.toNumber() < rhs.toNumber();
+        }
+        case YYJSON_TYPE_STR: {
+            const char* lhs_str = lhs | kString;
+            const char* rhs_str = rhs | kString;
+            return ::strcmp(lhs_str, rhs_str) < 0;
+        }
+        case YYJSON_TYPE_ARR:
+        case YYJSON_TYPE_OBJ: {
+            size_t lhs_size = lhs.size();
+            size_t rhs_size = rhs.size();
+            if (lhs_size != rhs_size) {
+                return lhs_size < rhs_size;
+            }
+            // Fallback to pointer comparison for containers of the same size.
+            return lhs.get() < rhs.get();
+        }
+        default: // RAW, or any other type
+            return lhs.get() < rhs.get();
+    }
+}
+
+/**
+ * @brief Convert JSON values to integers with type-specific logic
+ * 
+ * This function converts JSON values to integers using appropriate
+ * conversion rules for each JSON type:
+ * - Strings: parsed using atoi()
+ * - Numbers: direct conversion
+ * - Booleans: true=1, false=0
+ * - Containers: returns size
+ * - Invalid/null: returns 0
+ * 
+ * @tparam jsonT JSON value type
+ * @param val JSON value to convert
+ * @return int Converted integer value
+ */
+template<typename jsonT>
+inline typename std::enable_if<trait::is_value<jsonT>::value, int>::type
+toIntegerCast(const jsonT& val)
+{
+    if (yyjson_unlikely(!val.isValid())) return 0;
+    
+    if (val.isString()) {
+        const char* str = val | "";
+        return ::atoi(str);
+    }
+    
+    if (val.isInt()) {
+        return val.getor(0);
+    }
+    if (val.isBool()) {
+        return val.getor(false);
+    }
+    if (val.isReal()) {
+        return static_cast<int>(val.getor(0.0));
+    }
+    if (val.isRaw()) {
+        return static_cast<int>(val.toNumber());
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief Apply function to JSON value with intelligent parameter mapping
+ * 
+ * This function provides the implementation for pipe() operations,
+ * automatically mapping JSON values to appropriate function parameters:
+ * 1. Prefer direct JSON value parameter
+ * 2. Map to supported scalar types based on function signature
+ * 3. Fallback to getor() with function as default value
+ * 
+ * @tparam jsonT JSON value type
+ * @tparam funcT Function or callable type
+ * @param json JSON value to process
+ * @param func Function to apply
+ * @return auto Result of function application
+ * 
+ * @throws static_assert if function signature is unsupported
+ */
+template<typename jsonT, typename funcT>
+inline auto pipeApply(const jsonT& json, funcT&& func)
+{
+    if constexpr (std::is_invocable_v<funcT, const jsonT&>) {
+        return std::forward<funcT>(func)(json);
+    } else if constexpr (std::is_invocable_v<funcT, const char*>) {
+        return std::forward<funcT>(func)(json.getor(kString));
+    } else if constexpr (std::is_invocable_v<funcT, std::string>) {
+        return std::forward<funcT>(func)(json.getor(std::string{}));
+    } else if constexpr (std::is_invocable_v<funcT, double>) {
+        return std::forward<funcT>(func)(json.getor(kNumber));
+    } else if constexpr (std::is_invocable_v<funcT, int>) {
+        return std::forward<funcT>(func)(json.getor(0));
+    } else if constexpr (std::is_invocable_v<funcT, int64_t>) {
+        return std::forward<funcT>(func)(json.getor(int64_t{}));
+    } else if constexpr (std::is_invocable_v<funcT, uint64_t>) {
+        return std::forward<funcT>(func)(json.getor(uint64_t{}));
+    } else if constexpr (std::is_invocable_v<funcT, bool>) {
+        return std::forward<funcT>(func)(json.getor(false));
+    } else if constexpr (trait::enable_getor<funcT>::value) {
+        // Fallback: treat func as default value for getor
+        return json.getor(std::forward<funcT>(func));
+    } else {
+        static_assert(!std::is_same_v<funcT, funcT>, "Unsupported pipe() callable parameter type");
+    }
+}
+
+/* @Section 3.3: Memory Allocator Adaptor */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Owner of extra resource that must live as long as a document
+ *
+ * A document read through holder allocates its memory via the callbacks
+ * here, which forward to the inner allocator and count live blocks. The
+ * holder deletes itself when the last block is freed, so that the resource
+ * in derived class (e.g. in-situ input buffer) is released along with the
+ * document, no matter freed by Document or yyjson_doc_free directly.
+ */
+struct DocHolder
+{
+    yyjson_alc inner;
+    size_t refs = 1; //< one extra pin during reading
+
+    explicit DocHolder(const yyjson_alc* alc)
+        : inner{&libcMalloc, &libcRealloc, &libcFree, nullptr}
+    {
+        if (alc && alc->malloc) { inner = *alc; }
+    }
+    virtual ~DocHolder() {}
+
+    DocHolder(const DocHolder&) = delete;
+    DocHolder& operator=(const DocHolder&) = delete;
+
+    // Allocator bound to this holder, pass to yyjson read functions.
+    yyjson_alc wrap() { return yyjson_alc{&malloc, &realloc, &free, this}; }
+
+    // Remove the pin, delete self if no document created.
+    void unpin()
+    {
+        if (--refs == 0) delete this;
+    }
+
+    // Whether the string with its null terminator is in owned resource.
+    virtual bool owns(const char* str, size_t len) const
+    {
+        (void)str; (void)len;
+        return false;
+    }
+
+    // Bytes of owned resource.
+    virtual size_t bytes() const { return 0; }
+
+    static bool inRange(const char* str, size_t len, const void* begin, size_t size)
+    {
+        const char* first = static_cast<const char*>(begin);
+        return str >= first && str + len < first + size;
+    }
+
+    static bool isHolder(const yyjson_alc& alc) { return alc.free == &free; }
+
+    static void* malloc(void* ctx, size_t size)
+    {
+        auto* self = static_cast<DocHolder*>(ctx);
+        void* ptr = self->inner.malloc(self->inner.ctx, size);
+        if (yyjson_likely(ptr)) self->refs++;
+        return ptr;
+    }
+
+    static void* realloc(void* ctx, void* ptr, size_t old_size, size_t size)
+    {
+        auto* self = static_cast<DocHolder*>(ctx);
+        return self->inner.realloc(self->inner.ctx, ptr, old_size, size);
+    }
+
+    static void free(void* ctx, void* ptr)
+    {
+        if (yyjson_unlikely(!ptr)) return;
+        auto* self = static_cast<DocHolder*>(ctx);
+        self->inner.free(self->inner.ctx, ptr);
+        self->unpin();
+    }
+
+    static void* libcMalloc(void*, size_t size) { return ::malloc(size); }
+    static void* libcRealloc(void*, void* ptr, size_t, size_t size) { return ::realloc(ptr, size); }
+    static void libcFree(void*, void* ptr) { ::free(ptr); }
+};
+
+/// Holder that owns the padded input string of in-situ reading.
+struct StringHolder : public DocHolder
+{
+    std::string buffer;
+
+    StringHolder(std::string&& str, const yyjson_alc* alc)
+        : DocHolder(alc), buffer(std::move(str)) {}
+    size_t bytes() const override { return buffer.capacity(); }
+    bool owns(const char* str, size_t len) const override
+    {
+        return inRange(str, len, buffer.data(), buffer.size());
+    }
+};
+
+#ifdef XYJSON_HAS_MMAP
+/// Holder that owns the private file mapping of in-situ reading.
+struct MmapHolder : public DocHolder
+{
+    void* addr;
+    size_t size;
+
+    MmapHolder(void* addr_, size_t size_, const yyjson_alc* alc)
+        : DocHolder(alc), addr(addr_), size(size_) {}
+    ~MmapHolder() override { ::munmap(addr, size); }
+    size_t bytes() const override { return size; }
+    bool owns(const char* str, size_t len) const override
+    {
+        return inRange(str, len, addr, size);
+    }
+};
+#endif
+
+/// Holder that owns one buffer of padded input slices for in-situ reading.
+struct SliceHolder : public DocHolder
+{
+    std::unique_ptr<char[]> buffer;
+    size_t size;
+
+    SliceHolder(const yyjson_alc* alc, size_t capacity)
+        : DocHolder(alc), buffer(new char[capacity]), size(capacity) {}
+    size_t bytes() const override { return size; }
+    bool owns(const char* str, size_t len) const override
+    {
+        return inRange(str, len, buffer.get(), size);
+    }
+};
+
+/// Read a document whose memory is bound to holder, which is unpinned after.
+inline yyjson_doc* holderRead(DocHolder* holder, char* dat, size_t len,
+    yyjson_read_flag flg, yyjson_read_err* err = nullptr)
+{
+    yyjson_alc alc = holder->wrap();
+    yyjson_doc* doc = yyjson_read_opts(dat, len, flg, &alc, err);
+    holder->unpin();
+    return doc;
+}
+
+/**
+ * @brief Get the allocator that a document was created with
+ *
+ * yyjson keeps a copy of the allocator in each document, which is reused
+ * when converting between Document and MutableDocument. For document bound
+ * to a holder, return the innermost allocator, not to extend the holder life.
+ */
+inline const yyjson_alc* docAllocator(yyjson_doc* doc)
+{
+    if (yyjson_unlikely(!doc)) return nullptr;
+    const yyjson_alc* alc = &doc->alc;
+    while (DocHolder::isHolder(*alc)) {
+        alc = &static_cast<DocHolder*>(alc->ctx)->inner;
+    }
+    return alc;
+}
+
+#ifndef XYJSON_DISABLE_MUTABLE
+inline const yyjson_alc* docAllocator(yyjson_mut_doc* doc)
+{
+    if (yyjson_unlikely(!doc)) return nullptr;
+    const yyjson_alc* alc = &doc->alc;
+    while (DocHolder::isHolder(*alc)) {
+        alc = &static_cast<DocHolder*>(alc->ctx)->inner;
+    }
+    return alc;
+}
+
+/// Holder that owns the string pool taken over from a read-only document.
+struct PoolHolder : public DocHolder
+{
+    char* pool;
+    size_t size;
+
+    PoolHolder(char* pool_, size_t size_, const yyjson_alc* alc)
+        : DocHolder(alc), pool(pool_), size(size_) {}
+    ~PoolHolder() override { inner.free(inner.ctx, pool); }
+    size_t bytes() const override { return size; }
+    bool owns(const char* str, size_t len) const override
+    {
+        return inRange(str, len, pool, size);
+    }
+};
+
+/**
+ * @brief Copy a read-only value tree into mutable document
+ *
+ * The same as yyjson_val_mut_copy, that builds the linked mutable values
+ * in one pass over the flat value array, except that strings are referred
+ * but not copied, so they must live as long as the mutable document.
+ */
+inline yyjson_mut_val* mutCopyRef(yyjson_mut_doc* doc, yyjson_val* root)
+{
+    if (yyjson_unlikely(!doc || !root)) return nullptr;
+
+    yyjson_val* end = unsafe_yyjson_get_next(root);
+    yyjson_mut_val* vals = unsafe_yyjson_mut_val(doc, static_cast<size_t>(end - root));
+    if (yyjson_unlikely(!vals)) return nullptr;
+
+    yyjson_mut_val* mval = vals;
+    for (yyjson_val* ival = root; ival < end; ++ival, ++mval)
+    {
+        mval->tag = ival->tag;
+        mval->uni.u64 = ival->uni.u64;
+        yyjson_type type = unsafe_yyjson_get_type(ival);
+        size_t len = unsafe_yyjson_get_len(ival);
+        if (type == YYJSON_TYPE_ARR && len > 0) {
+            // link items in a circle, container points to the last one
+            yyjson_val* item = ival + 1;
+            yyjson_mut_val* mitem = mval + 1;
+            while (len-- > 1) {
+                yyjson_val* next = unsafe_yyjson_get_next(item);
+                mitem->next = mitem + (next - item);
+                mitem = mitem->next;
+                item = next;
+            }
+            mitem->next = mval + 1;
+            mval->uni.ptr = mitem;
+        }
+        else if (type == YYJSON_TYPE_OBJ && len > 0) {
+            // link key and value pairs the same way
+            yyjson_val* key = ival + 1;
+            yyjson_mut_val* mkey = mval + 1;
+            while (len-- > 1) {
+                yyjson_val* next = unsafe_yyjson_get_next(key + 1);
+                mkey->next = mkey + 1;
+                (mkey + 1)->next = mkey + (next - key);
+                mkey = (mkey + 1)->next;
+                key = next;
+            }
+            mkey->next = mkey + 1;
+            (mkey + 1)->next = mval + 1;
+            mval->uni.ptr = mkey;
+        }
+    }
+    return vals;
+}
+
+/**
+ * @brief Convert a read-only document to mutable, then free it
+ *
+ * The mutable document is bound to holder which owns the memory of
+ * strings, so that they are referred rather than copied one by one.
+ * The holder is unpinned after.
+ */
+inline yyjson_mut_doc* holderMutate(DocHolder* holder, yyjson_doc* doc)
+{
+    yyjson_alc alc = holder->wrap();
+    yyjson_mut_doc* mdoc = yyjson_mut_doc_new(&alc);
+    if (yyjson_likely(mdoc)) {
+        yyjson_mut_val* root = mutCopyRef(mdoc, yyjson_doc_get_root(doc));
+        if (yyjson_likely(root)) {
+            yyjson_mut_doc_set_root(mdoc, root);
+        } else {
+            yyjson_mut_doc_free(mdoc);
+            mdoc = nullptr;
+        }
+    }
+    holder->unpin();
+    yyjson_doc_free(doc);
+    return mdoc;
+}
+
+/**
+ * @brief Convert a document just read to mutable, taking over its strings
+ *
+ * Replace yyjson_doc_mut_copy for the read methods of MutableDocument, to
+ * avoid the second copy of all strings. The string pool of doc, which is
+ * the input copy where strings are unescaped, is kept by the mutable
+ * document, while the read-only value tree is freed.
+ */
+inline yyjson_mut_doc* mutAdopt(yyjson_doc* doc)
+{
+    if (yyjson_unlikely(!doc)) return nullptr;
+    if (yyjson_unlikely(!doc->str_pool)) {
+        // in-situ document not own the strings
+        yyjson_mut_doc* mdoc = yyjson_doc_mut_copy(doc, &doc->alc);
+        yyjson_doc_free(doc);
+        return mdoc;
+    }
+
+    // strings are unescaped in place within the data read
+    size_t size = yyjson_doc_get_read_size(doc) + YYJSON_PADDING_SIZE;
+    DocHolder* holder = new PoolHolder(doc->str_pool, size, &doc->alc);
+    doc->str_pool = nullptr;
+    return holderMutate(holder, doc);
+}
+
+/// Holder that owns the string chunks taken over from a mutable document.
+struct ChunkHolder : public DocHolder
+{
+    yyjson_str_chunk* chunks = nullptr;
+    char* extra = nullptr; //< copy of strings not kept in place
+    size_t extraSize = 0;
+
+    explicit ChunkHolder(const yyjson_alc* alc) : DocHolder(alc) {}
+    ~ChunkHolder() override
+    {
+        while (chunks) {
+            yyjson_str_chunk* next = chunks->next;
+            inner.free(inner.ctx, chunks);
+            chunks = next;
+        }
+        if (extra) inner.free(inner.ctx, extra);
+    }
+    size_t bytes() const override
+    {
+        size_t total = extraSize;
+        for (yyjson_str_chunk* chunk = chunks; chunk; chunk = chunk->next) {
+            total += chunk->chunk_size;
+        }
+        return total;
+    }
+    bool owns(const char* str, size_t len) const override
+    {
+        for (yyjson_str_chunk* chunk = chunks; chunk; chunk = chunk->next) {
+            if (inRange(str, len, chunk, chunk->chunk_size)) return true;
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief Build read-only values in the layout of yyjson_mut_doc_imut_copy
+ *
+ * A string is referred in place if it is null terminated and owned by the
+ * chunks or the holder of source document, otherwise copied to extra.
+ * Count values and extra bytes when output is null.
+ */
+struct FreezeBuilder
+{
+    const ChunkHolder* chunks;
+    const DocHolder* owner;
+    size_t vals = 0;
+    size_t bytes = 0;
+    yyjson_val* out = nullptr;
+    char* extra = nullptr;
+
+    bool inPlace(const char* str, size_t len) const
+    {
+        if (!chunks->owns(str, len) && !(owner && owner->owns(str, len))) return false;
+        return str[len] == '\0';
+    }
+
+    size_t build(yyjson_mut_val* mval)
+    {
+        yyjson_type type = unsafe_yyjson_get_type(mval);
+        size_t len = unsafe_yyjson_get_len(mval);
+        yyjson_val* val = out;
+        if (out) ++out;
+        ++vals;
+
+        if (type == YYJSON_TYPE_ARR || type == YYJSON_TYPE_OBJ) {
+            // first child after the last one that container points to
+            yyjson_mut_val* child = static_cast<yyjson_mut_val*>(mval->uni.ptr);
+            if (len > 0) child = type == YYJSON_TYPE_OBJ ? child->next->next : child->next;
+            if (type == YYJSON_TYPE_OBJ) len *= 2;
+            size_t sum = 1;
+            for (size_t i = 0; i < len; ++i, child = child->next) {
+                sum += build(child);
+            }
+            if (val) {
+                val->tag = mval->tag;
+                val->uni.ofs = sum * sizeof(yyjson_val);
+            }
+            return sum;
+        }
+
+        if (type == YYJSON_TYPE_STR || type == YYJSON_TYPE_RAW) {
+            const char* str = mval->uni.str;
+            if (inPlace(str, len)) {
+                if (val) { val->tag = mval->tag; val->uni.str = str; }
+            }
+            else if (val) {
+                ::memcpy(extra, str, len);
+                extra[len] = '\0';
+                val->tag = mval->tag;
+                val->uni.str = extra;
+                extra += len + 1;
+            }
+            else {
+                bytes += len + 1;
+            }
+            return 1;
+        }
+
+        if (val) {
+            val->tag = mval->tag;
+            val->uni.u64 = mval->uni.u64;
+        }
+        return 1;
+    }
+};
+
+/**
+ * @brief Convert a mutable document to read-only one, then free it
+ *
+ * Unlike yyjson_mut_doc_imut_copy, the strings are not copied but taken
+ * over by a holder along with the string chunks of the source, and the
+ * mutable value pool is freed right after the read-only values are built,
+ * so the peak memory is lower about the size of all strings.
+ *
+ * @return null if failed, and the source is kept.
+ */
+inline yyjson_doc* freezeInPlace(yyjson_mut_doc* mdoc)
+{
+    if (yyjson_unlikely(!mdoc || !mdoc->root)) return nullptr;
+
+    auto* holder = new ChunkHolder(&mdoc->alc);
+    holder->chunks = mdoc->str_pool.chunks;
+    const DocHolder* owner = DocHolder::isHolder(mdoc->alc)
+        ? static_cast<const DocHolder*>(mdoc->alc.ctx) : nullptr;
+    FreezeBuilder builder{holder, owner};
+    builder.build(mdoc->root);
+    holder->chunks = nullptr;
+
+    size_t hdr = (sizeof(yyjson_doc) + sizeof(yyjson_val) - 1) / sizeof(yyjson_val) * sizeof(yyjson_val);
+    yyjson_alc alc = holder->wrap();
+    yyjson_doc* doc = static_cast<yyjson_doc*>(alc.malloc(alc.ctx, hdr + builder.vals * sizeof(yyjson_val)));
+    if (doc && builder.bytes > 0) {
+        holder->extra = static_cast<char*>(holder->inner.malloc(holder->inner.ctx, builder.bytes));
+        if (yyjson_unlikely(!holder->extra)) {
+            alc.free(alc.ctx, doc);
+            doc = nullptr;
+        }
+        else {
+            holder->extraSize = builder.bytes;
+        }
+    }
+    if (yyjson_unlikely(!doc)) {
+        holder->unpin();
+        return nullptr;
+    }
+
+    ::memset(doc, 0, sizeof(yyjson_doc));
+    doc->alc = alc;
+    doc->val_read = builder.vals;
+    doc->root = reinterpret_cast<yyjson_val*>(reinterpret_cast<char*>(doc) + hdr);
+
+    holder->chunks = mdoc->str_pool.chunks;
+    builder.out = doc->root;
+    builder.extra = holder->extra;
+    builder.build(mdoc->root);
+
+    // release the mutable values, but keep the strings in holder
+    ::memset(&mdoc->str_pool, 0, sizeof(mdoc->str_pool));
+    yyjson_mut_doc_free(mdoc);
+    holder->unpin();
+    return doc;
+}
+#endif
+
+#ifdef XYJSON_HAS_PMR
+/**
+ * @brief yyjson_alc callbacks forwarding to std::pmr::memory_resource
+ *
+ * The free callback of yyjson_alc has no size argument but deallocate of
+ * memory_resource requires it, so each block is prefixed with a header
+ * that records the requested size.
+ */
+struct PmrAllocator
+{
+    static constexpr size_t kHeader = alignof(std::max_align_t);
+
+    static void* malloc(void* ctx, size_t size)
+    {
+        auto* resource = static_cast<std::pmr::memory_resource*>(ctx);
+        void* block = nullptr;
+#if defined(__cpp_exceptions)
+        // exception must not propagate through yyjson C code
+        try { block = resource->allocate(size + kHeader, kHeader); }
+        catch (...) { return nullptr; }
+#else
+        block = resource->allocate(size + kHeader, kHeader);
+#endif
+        if (yyjson_unlikely(!block)) return nullptr;
+        *static_cast<size_t*>(block) = size;
+        return static_cast<char*>(block) + kHeader;
+    }
+
+    static void* realloc(void* ctx, void* ptr, size_t old_size, size_t size)
+    {
+        void* block = malloc(ctx, size);
+        if (yyjson_likely(block && ptr)) {
+            ::memcpy(block, ptr, old_size < size ? old_size : size);
+            free(ctx, ptr);
+        }
+        return block;
+    }
+
+    static void free(void* ctx, void* ptr)
+    {
+        if (yyjson_unlikely(!ptr)) return;
+        auto* resource = static_cast<std::pmr::memory_resource*>(ctx);
+        char* block = static_cast<char*>(ptr) - kHeader;
+        size_t size = *reinterpret_cast<size_t*>(block);
+        resource->deallocate(block, size + kHeader, kHeader);
+    }
+};
+#endif
+
+/**
+ * @brief Allocator that lends the storage of std::string to yyjson writer
+ *
+ * The writer allocates one output block and grows it by realloc, which is
+ * mapped to resize of the string after its original content, so json is
+ * serialized in place, and commit() just trims it to the written length.
+ * Any other block is served by libc.
+ */
+struct StringSink
+{
+    std::string& out;
+    size_t base; //< size of content kept before output
+    bool busy = false;
+
+    explicit StringSink(std::string& str, bool append = false)
+        : out(str), base(append ? str.size() : 0) {}
+
+    yyjson_alc c_alc() { return yyjson_alc{&malloc, &realloc, &free, this}; }
+
+    bool commit(char* json, size_t len)
+    {
+        if (yyjson_unlikely(!json)) {
+            out.resize(base);
+            return false;
+        }
+        if (yyjson_likely(json == &out[base])) {
+            out.resize(base + len);
+        }
+        else {
+            out.resize(base);
+            out.append(json, len);
+            ::free(json);
+        }
+        return true;
+    }
+
+    bool grow(size_t size)
+    {
+#if defined(__cpp_exceptions)
+        // exception must not propagate through yyjson C code
+        try { out.resize(base + size); }
+        catch (...) { return false; }
+#else
+        out.resize(base + size);
+#endif
+        return true;
+    }
+
+    static void* malloc(void* ctx, size_t size)
+    {
+        auto* self = static_cast<StringSink*>(ctx);
+        if (self->busy) return ::malloc(size);
+        if (self->out.size() < self->base + size && !self->grow(size)) return nullptr;
+        self->busy = true;
+        return &self->out[self->base];
+    }
+
+    static void* realloc(void* ctx, void* ptr, size_t old_size, size_t size)
+    {
+        auto* self = static_cast<StringSink*>(ctx);
+        if (!self->busy || ptr != &self->out[self->base]) return ::realloc(ptr, size);
+        (void)old_size;
+        if (!self->grow(size)) return nullptr;
+        return &self->out[self->base];
+    }
+
+    static void free(void* ctx, void* ptr)
+    {
+        auto* self = static_cast<StringSink*>(ctx);
+        if (self->busy && ptr == &self->out[self->base]) {
+            self->busy = false;
+            return;
+        }
+        ::free(ptr);
+    }
+};
+
+/* @Section 3.4: Input Stream Helper */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Read all remaining content of input stream into buffer
+ *
+ * Read in chunks directly into the string buffer, growing geometrically,
+ * so that it works for non-seekable source like pipe and std::cin. The
+ * size is reserved in advance when the stream is seekable. Some spare
+ * capacity is left at the end for padding of in-situ parsing.
+ *
+ * @return false if the stream is not readable or nothing is read.
+ */
+inline bool readStream(std::istream& is, std::string& buffer)
+{
+    if (yyjson_unlikely(!is.good())) return false;
+
+    constexpr size_t kMinChunk = 64 * 1024;
+    size_t len = buffer.size();
+    size_t chunk = kMinChunk;
+
+    // use rdbuf directly, failed seek on pipe not affect stream state
+    std::streambuf* sb = is.rdbuf();
+    auto cur = sb->pubseekoff(0, std::ios::cur, std::ios::in);
+    if (cur != std::streampos(-1)) {
+        auto end = sb->pubseekoff(0, std::ios::end, std::ios::in);
+        sb->pubseekpos(cur, std::ios::in);
+        if (end != std::streampos(-1) && end > cur) {
+            chunk = static_cast<size_t>(end - cur) + YYJSON_PADDING_SIZE;
+        }
+    }
+
+    while (is.good())
+    {
+        buffer.resize(len + chunk);
+        is.read(&buffer[len], static_cast<std::streamsize>(chunk));
+        len += static_cast<size_t>(is.gcount());
+        if (chunk < len) chunk = len;
+        if (chunk < kMinChunk) chunk = kMinChunk;
+    }
+
+    buffer.resize(len);
+    return len > 0;
+}
+
+
+/* @Section 3.5: Raw Text Scanner */
+/* ------------------------------------------------------------------------ */
+
+/// Decode a JSON Pointer token, "~1" for '/' and "~0" for '~'.
+inline std::string pointerToken(const char* str, size_t len)
+{
+    std::string token;
+    token.reserve(len);
+    for (size_t i = 0; i < len; ++i) {
+        if (str[i] == '~' && i + 1 < len && (str[i+1] == '0' || str[i+1] == '1')) {
+            token.push_back(str[++i] == '0' ? '~' : '/');
+        } else {
+            token.push_back(str[i]);
+        }
+    }
+    return token;
+}
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline const char* skipSpace(const char* p, const char* end)
+{
+    while (p < end && isSpace(*p)) ++p;
+    return p;
+}
+
+/// Skip string from the open quote, return past the close quote.
+inline const char* skipString(const char* p, const char* end)
+{
+    for (++p; p < end; )
+    {
+        const char* quote = static_cast<const char*>(::memchr(p, '"', end - p));
+        if (yyjson_unlikely(quote == nullptr)) return nullptr;
+        // escaped by odd number of backslashes before it
+        const char* slash = quote;
+        while (slash > p && slash[-1] == '\\') --slash;
+        if (((quote - slash) & 1) == 0) return quote + 1;
+        p = quote + 1;
+    }
+    return nullptr;
+}
+
+/// Skip any value from its first char, containers by bracket matching.
+inline const char* skipValue(const char* p, const char* end)
+{
+    if (yyjson_unlikely(p >= end)) return nullptr;
+    char c = *p;
+    if (c == '"') return skipString(p, end);
+    if (c == '{' || c == '[')
+    {
+        size_t depth = 0;
+        while (p < end)
+        {
+            c = *p;
+            if (c == '"') {
+                p = skipString(p, end);
+                if (yyjson_unlikely(p == nullptr)) return nullptr;
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                ++depth;
+            }
+            else if (c == '}' || c == ']') {
+                if (--depth == 0) return p + 1;
+            }
+            ++p;
+        }
+        return nullptr;
+    }
+
+    // scalar ends at delimiter
+    const char* q = p;
+    while (q < end && !isSpace(*q) && *q != ',' && *q != '}' && *q != ']') ++q;
+    return q > p ? q : nullptr;
+}
+
+/// Compare raw string content in quotes with key, unescape if needed.
+inline bool rawKeyEqual(const char* begin, const char* end, const char* key, size_t len)
+{
+    size_t size = end - begin;
+    if (yyjson_likely(::memchr(begin, '\\', size) == nullptr)) {
+        return size == len && ::memcmp(begin, key, len) == 0;
+    }
+    yyjson_doc* doc = yyjson_read(begin - 1, size + 2, 0);
+    yyjson_val* str = yyjson_doc_get_root(doc);
+    bool equal = yyjson_equals_strn(str, key, len);
+    yyjson_doc_free(doc);
+    return equal;
+}
+
+/// Scan object for the value of key, return its first char.
+inline const char* scanKey(const char* p, const char* end, const char* key, size_t len)
+{
+    p = skipSpace(p + 1, end);
+    while (p < end && *p == '"')
+    {
+        const char* keyEnd = skipString(p, end);
+        if (yyjson_unlikely(keyEnd == nullptr)) return nullptr;
+        bool match = rawKeyEqual(p + 1, keyEnd - 1, key, len);
+        p = skipSpace(keyEnd, end);
+        if (yyjson_unlikely(p >= end || *p != ':')) return nullptr;
+        p = skipSpace(p + 1, end);
+        if (match) return p < end ? p : nullptr;
+        p = skipValue(p, end);
+        if (yyjson_unlikely(p == nullptr)) return nullptr;
+        p = skipSpace(p, end);
+        if (p >= end || *p != ',') return nullptr;
+        p = skipSpace(p + 1, end);
+    }
+    return nullptr;
+}
+
+/// Scan array for the item at idx, return its first char.
+inline const char* scanIndex(const char* p, const char* end, size_t idx)
+{
+    p = skipSpace(p + 1, end);
+    if (p >= end || *p == ']') return nullptr;
+    for (size_t i = 0; p < end; ++i)
+    {
+        if (i == idx) return p;
+        p = skipValue(p, end);
+        if (yyjson_unlikely(p == nullptr)) return nullptr;
+        p = skipSpace(p, end);
+        if (p >= end || *p != ',') return nullptr;
+        p = skipSpace(p + 1, end);
+    }
+    return nullptr;
+}
+
+/// Count the items of array or members of object.
+inline size_t scanSize(const char* p, const char* end)
+{
+    bool isObj = *p == '{';
+    p = skipSpace(p + 1, end);
+    if (p >= end || *p == ']' || *p == '}') return 0;
+    size_t count = 0;
+    while (p < end)
+    {
+        if (isObj) {
+            p = skipString(p, end);
+            if (yyjson_unlikely(p == nullptr)) return count;
+            p = skipSpace(p, end);
+            if (yyjson_unlikely(p >= end || *p != ':')) return count;
+            p = skipSpace(p + 1, end);
+        }
+        p = skipValue(p, end);
+        if (yyjson_unlikely(p == nullptr)) return count;
+        ++count;
+        p = skipSpace(p, end);
+        if (p >= end || *p != ',') return count;
+        p = skipSpace(p + 1, end);
+    }
+    return count;
+}
+
+/// Whether the char at pos is escaped by odd number of backslashes.
+inline bool isEscaped(const char* begin, const char* pos)
+{
+    const char* slash = pos;
+    while (slash > begin && slash[-1] == '\\') --slash;
+    return ((pos - slash) & 1) != 0;
+}
+
+/**
+ * @brief Structure summary of a slice of text, unknown if start in string
+ *
+ * The quotes split the slice into segments that alternate between inside
+ * and outside string, so the bracket depth is counted for both cases at
+ * once: depth[0] if the slice starts outside string, depth[1] otherwise.
+ * Slices can then be summarized in parallel and resolved by prefix order.
+ */
+struct SliceSummary
+{
+    bool oddQuotes = false;
+    long depth[2] = {0, 0};
+};
+
+inline SliceSummary summarizeSlice(const char* begin, const char* p, const char* end)
+{
+    SliceSummary summary;
+    bool odd = false;
+    for (; p < end; ++p)
+    {
+        switch (*p)
+        {
+        case '"':
+            if (!isEscaped(begin, p)) odd = !odd;
+            break;
+        case '[': case '{':
+            ++summary.depth[odd];
+            break;
+        case ']': case '}':
+            --summary.depth[odd];
+            break;
+        default:
+            break;
+        }
+    }
+    summary.oddQuotes = odd;
+    return summary;
+}
+
+/// Find the first comma at depth 1 from p with known state, or end if none.
+inline const char* scanComma(const char* begin, const char* p, const char* end,
+    bool inString, long depth)
+{
+    if (inString && p < end && isEscaped(begin, p)) ++p;
+    for (; p < end; ++p)
+    {
+        char c = *p;
+        if (inString) {
+            if (c == '\\') ++p;
+            else if (c == '"') inString = false;
+            continue;
+        }
+        if (c == '"') inString = true;
+        else if (c == '[' || c == '{') ++depth;
+        else if (c == ']' || c == '}') --depth;
+        else if (c == ',' && depth == 1) return p;
+    }
+    return end;
+}
+
+/* @Section 3.6: Json Validator */
+/* ------------------------------------------------------------------------ */
+
+/// Length of a valid UTF-8 sequence from non-ascii lead byte, 0 if invalid.
+inline size_t utf8Length(const unsigned char* p, const unsigned char* end)
+{
+    unsigned char c = p[0];
+    unsigned char lo = 0x80;
+    unsigned char hi = 0xBF;
+    size_t n = 0;
+    if (c >= 0xC2 && c <= 0xDF) {
+        n = 2;
+    }
+    else if (c >= 0xE0 && c <= 0xEF) {
+        n = 3;
+        if (c == 0xE0) lo = 0xA0;      // overlong
+        else if (c == 0xED) hi = 0x9F; // surrogate
+    }
+    else if (c >= 0xF0 && c <= 0xF4) {
+        n = 4;
+        if (c == 0xF0) lo = 0x90;      // overlong
+        else if (c == 0xF4) hi = 0x8F; // beyond U+10FFFF
+    }
+    else {
+        return 0;
+    }
+
+    if (yyjson_unlikely(static_cast<size_t>(end - p) < n)) return 0;
+    if (yyjson_unlikely(p[1] < lo || p[1] > hi)) return 0;
+    for (size_t i = 2; i < n; ++i) {
+        if (yyjson_unlikely((p[i] & 0xC0) != 0x80)) return 0;
+    }
+    return n;
+}
+
+/**
+ * @brief Syntax checker of json text that allocates no values
+ *
+ * It walks the text once with an explicit stack of open brackets, so deep
+ * nesting does not recurse, and reports the first error as yyjson would,
+ * with the code, message and position.
+ */
+class Validator
+{
+public:
+    Validator(const char* str, size_t len, yyjson_read_flag flag)
+        : m_begin(str), m_p(str), m_end(str + len), m_flag(flag) {}
+
+    ValidateResult run()
+    {
+        check();
+        m_result.pos = m_result.isValid() ? 0 : m_p - m_begin;
+        return m_result;
+    }
+
+private:
+    bool has(yyjson_read_flag flag) const { return (m_flag & flag) != 0; }
+    bool digit() const { return m_p < m_end && *m_p >= '0' && *m_p <= '9'; }
+
+    bool fail(yyjson_read_code code, const char* msg)
+    {
+        m_result.code = code;
+        m_result.msg = msg;
+        return false;
+    }
+
+    bool failEnd() { return fail(YYJSON_READ_ERROR_UNEXPECTED_END, "unexpected end of data"); }
+
+    bool check()
+    {
+        // open brackets, stay in small buffer for usual depth
+        std::string stack;
+        if (!skipSpace()) return false;
+        if (m_p >= m_end) return fail(YYJSON_READ_ERROR_EMPTY_CONTENT, "input data is empty");
+
+        for (;;)
+        {
+            // a value is expected here
+            if (m_p >= m_end) return failEnd();
+            char c = *m_p;
+            m_result.values++;
+            if (c == '{' || c == '[') {
+                stack.push_back(c);
+                if (stack.size() > m_result.depth) m_result.depth = stack.size();
+                ++m_p;
+                if (!skipSpace()) return false;
+                if (m_p >= m_end) return failEnd();
+                if (*m_p != (c == '{' ? '}' : ']')) {
+                    if (c == '{' && !key()) return false;
+                    continue;
+                }
+                ++m_p;
+                stack.pop_back();
+            }
+            else if (c == '"') {
+                if (!string()) return false;
+            }
+            else if (c == '-' || (c >= '0' && c <= '9')) {
+                if (!number()) return false;
+            }
+            else if (!literal()) {
+                return false;
+            }
+
+            // close containers until next value
+            bool more = false;
+            while (!more && !stack.empty())
+            {
+                if (!skipSpace()) return false;
+                if (m_p >= m_end) return failEnd();
+                char close = stack.back() == '{' ? '}' : ']';
+                if (*m_p == close) {
+                    ++m_p;
+                    stack.pop_back();
+                    continue;
+                }
+                if (*m_p != ',') {
+                    return fail(YYJSON_READ_ERROR_UNEXPECTED_CHARACTER,
+                        "unexpected character, expected a comma or a closing bracket");
+                }
+                ++m_p;
+                if (!skipSpace()) return false;
+                if (m_p >= m_end) return failEnd();
+                if (*m_p == close && has(YYJSON_READ_ALLOW_TRAILING_COMMAS)) {
+                    ++m_p;
+                    stack.pop_back();
+                    continue;
+                }
+                if (stack.back() == '{' && !key()) return false;
+                more = true;
+            }
+            if (!more) break;
+        }
+
+        if (!has(YYJSON_READ_STOP_WHEN_DONE)) {
+            if (!skipSpace()) return false;
+            if (m_p < m_end) {
+                return fail(YYJSON_READ_ERROR_UNEXPECTED_CONTENT, "unexpected content after document");
+            }
+        }
+        m_result.readSize = m_p - m_begin;
+        return true;
+    }
+
+    // Skip whitespace and comments if allowed.
+    bool skipSpace()
+    {
+        for (;;)
+        {
+            while (m_p < m_end && isSpace(*m_p)) ++m_p;
+            if (!has(YYJSON_READ_ALLOW_COMMENTS) || m_end - m_p < 2 || *m_p != '/') return true;
+            if (m_p[1] == '/') {
+                const char* eol = static_cast<const char*>(::memchr(m_p, '\n', m_end - m_p));
+                m_p = eol ? eol + 1 : m_end;
+            }
+            else if (m_p[1] == '*') {
+                const char* p = m_p + 2;
+                while (p + 1 < m_end && (p[0] != '*' || p[1] != '/')) ++p;
+                if (yyjson_unlikely(p + 1 >= m_end)) {
+                    return fail(YYJSON_READ_ERROR_INVALID_COMMENT, "unclosed multiline comment");
+                }
+                m_p = p + 2;
+            }
+            else {
+                return true;
+            }
+        }
+    }
+
+    // Object key and colon after it, then space before value.
+    bool key()
+    {
+        if (yyjson_unlikely(*m_p != '"')) {
+            return fail(YYJSON_READ_ERROR_UNEXPECTED_CHARACTER, "unexpected character, expected a string for object key");
+        }
+        if (!string()) return false;
+        m_result.values++;
+        if (!skipSpace()) return false;
+        if (m_p >= m_end) return failEnd();
+        if (yyjson_unlikely(*m_p != ':')) {
+            return fail(YYJSON_READ_ERROR_UNEXPECTED_CHARACTER, "unexpected character, expected a colon after object key");
+        }
+        ++m_p;
+        return skipSpace();
+    }
+
+    bool hex4(uint32_t& code)
+    {
+        if (yyjson_unlikely(m_end - m_p < 4)) return failEnd();
+        code = 0;
+        for (int i = 0; i < 4; ++i, ++m_p)
+        {
+            char c = *m_p;
+            uint32_t d = 0;
+            if (c >= '0' && c <= '9') d = c - '0';
+            else if (c >= 'a' && c <= 'f') d = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') d = c - 'A' + 10;
+            else return fail(YYJSON_READ_ERROR_INVALID_STRING, "invalid escaped sequence in string");
+            code = (code << 4) | d;
+        }
+        return true;
+    }
+
+    bool escape()
+    {
+        // m_p is past the backslash
+        if (m_p >= m_end) return failEnd();
+        switch (*m_p)
+        {
+        case '"': case '\\': case '/': case 'b':
+        case 'f': case 'n': case 'r': case 't':
+            ++m_p;
+            return true;
+        case 'u':
+            break;
+        default:
+            return fail(YYJSON_READ_ERROR_INVALID_STRING, "invalid escaped character in string");
+        }
+
+        ++m_p;
+        uint32_t code = 0;
+        if (!hex4(code)) return false;
+        bool relaxed = has(YYJSON_READ_ALLOW_INVALID_UNICODE);
+        if (code >= 0xDC00 && code <= 0xDFFF) {
+            if (relaxed) return true;
+            m_p -= 6;
+            return fail(YYJSON_READ_ERROR_INVALID_STRING, "invalid low surrogate in string");
+        }
+        if (code < 0xD800 || code > 0xDBFF) return true;
+
+        if (m_end - m_p >= 2 && m_p[0] == '\\' && m_p[1] == 'u') {
+            m_p += 2;
+            if (!hex4(code)) return false;
+            if (code >= 0xDC00 && code <= 0xDFFF) return true;
+        }
+        if (relaxed) return true;
+        return fail(YYJSON_READ_ERROR_INVALID_STRING, "no low surrogate in string");
+    }
+
+    bool string()
+    {
+        const unsigned char* end = reinterpret_cast<const unsigned char*>(m_end);
+        for (++m_p; ; )
+        {
+            // plain ascii in bulk
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(m_p);
+            while (p < end && *p >= 0x20 && *p < 0x80 && *p != '"' && *p != '\\') ++p;
+            m_p = reinterpret_cast<const char*>(p);
+            if (yyjson_unlikely(p >= end)) {
+                return fail(YYJSON_READ_ERROR_UNEXPECTED_END, "unexpected end of string");
+            }
+
+            unsigned char c = *p;
+            if (c == '"') {
+                ++m_p;
+                return true;
+            }
+            if (c == '\\') {
+                ++m_p;
+                if (!escape()) return false;
+            }
+            else if (c < 0x20) {
+                return fail(YYJSON_READ_ERROR_INVALID_STRING, "unexpected control character in string");
+            }
+            else if (has(YYJSON_READ_ALLOW_INVALID_UNICODE)) {
+                ++m_p;
+            }
+            else {
+                size_t n = utf8Length(p, end);
+                if (yyjson_unlikely(n == 0)) {
+                    return fail(YYJSON_READ_ERROR_INVALID_STRING, "invalid utf-8 encoding in string");
+                }
+                m_p += n;
+            }
+        }
+    }
+
+    bool number()
+    {
+        const char* start = m_p;
+        if (*m_p == '-') {
+            ++m_p;
+            if (!digit()) {
+                if (has(YYJSON_READ_ALLOW_INF_AND_NAN) && infOrNan()) return true;
+                return fail(YYJSON_READ_ERROR_INVALID_NUMBER, "no digit after minus sign");
+            }
+        }
+        if (*m_p == '0') {
+            ++m_p;
+            if (digit()) {
+                return fail(YYJSON_READ_ERROR_INVALID_NUMBER, "number with leading zero is not allowed");
+            }
+        }
+
+        // decimal exponent of the first significant digit
+        long long magnitude = -1;
+        bool significant = false;
+        for (; digit(); ++m_p) {
+            significant = significant || *m_p != '0';
+            if (significant) ++magnitude;
+        }
+        if (m_p < m_end && *m_p == '.') {
+            ++m_p;
+            if (!digit()) return fail(YYJSON_READ_ERROR_INVALID_NUMBER, "no digit after decimal point");
+            for (; digit(); ++m_p) {
+                if (significant) continue;
+                if (*m_p == '0') --magnitude;
+                else significant = true;
+            }
+        }
+        if (m_p < m_end && (*m_p == 'e' || *m_p == 'E')) {
+            ++m_p;
+            bool minus = m_p < m_end && *m_p == '-';
+            if (m_p < m_end && (*m_p == '+' || *m_p == '-')) ++m_p;
+            if (!digit()) return fail(YYJSON_READ_ERROR_INVALID_NUMBER, "no digit after exponent sign");
+            long long exp = 0;
+            for (; digit(); ++m_p) {
+                if (exp < 100000) exp = exp * 10 + (*m_p - '0');
+            }
+            magnitude += minus ? -exp : exp;
+        }
+        if (significant && magnitude >= 308 && overflow(start)) {
+            m_p = start;
+            return fail(YYJSON_READ_ERROR_INVALID_NUMBER, "number is infinity when parsed as double");
+        }
+        return true;
+    }
+
+    // Whether the number up to m_p is rejected as infinity as yyjson does.
+    bool overflow(const char* start) const
+    {
+        yyjson_read_flag keep = YYJSON_READ_ALLOW_INF_AND_NAN | YYJSON_READ_BIGNUM_AS_RAW
+            | YYJSON_READ_NUMBER_AS_RAW;
+        if (has(keep)) return false;
+
+        // rare near the limit, leave the exact rounding to yyjson
+        std::string text(start, m_p);
+        yyjson_val num;
+        return yyjson_read_number(text.c_str(), &num, YYJSON_READ_NOFLAG, nullptr, nullptr) == nullptr;
+    }
+
+    // Case insensitive word at current position.
+    bool word(const char* text, size_t len) const
+    {
+        if (static_cast<size_t>(m_end - m_p) < len) return false;
+        for (size_t i = 0; i < len; ++i) {
+            char c = m_p[i];
+            if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+            if (c != text[i]) return false;
+        }
+        return true;
+    }
+
+    bool infOrNan()
+    {
+        if (word("infinity", 8)) m_p += 8;
+        else if (word("inf", 3)) m_p += 3;
+        else if (word("nan", 3)) m_p += 3;
+        else return false;
+        return true;
+    }
+
+    bool literal()
+    {
+        size_t left = m_end - m_p;
+        if (left >= 4 && ::memcmp(m_p, "true", 4) == 0) { m_p += 4; return true; }
+        if (left >= 4 && ::memcmp(m_p, "null", 4) == 0) { m_p += 4; return true; }
+        if (left >= 5 && ::memcmp(m_p, "false", 5) == 0) { m_p += 5; return true; }
+        if (has(YYJSON_READ_ALLOW_INF_AND_NAN) && infOrNan()) return true;
+
+        char c = *m_p;
+        if (c == 't' || c == 'f' || c == 'n') {
+            return fail(YYJSON_READ_ERROR_LITERAL, "invalid literal");
+        }
+        return fail(YYJSON_READ_ERROR_UNEXPECTED_CHARACTER, "unexpected character, expected a json value");
+    }
+
+    const char* m_begin;
+    const char* m_p;
+    const char* m_end;
+    yyjson_read_flag m_flag;
+    ValidateResult m_result;
+};
+
+/* @Section 3.7: Tree Walk Helper */
+/* ------------------------------------------------------------------------ */
+
+/// Serialize value by yyjson writer with given allocator.
+inline char* writeValue(yyjson_val* val, yyjson_write_flag flg, const yyjson_alc* alc, size_t* len)
+{
+    return yyjson_val_write_opts(val, flg, alc, len, nullptr);
+}
+
+/// Append json of value to string.
+inline bool appendJson(std::string& output, yyjson_val* val)
+{
+    StringSink sink(output, true);
+    yyjson_alc alc = sink.c_alc();
+    size_t len = 0;
+    return sink.commit(yyjson_val_write_opts(val, 0, &alc, &len, nullptr), len);
+}
+
+/// Whether the subtree has no more than limit values, keys included.
+inline bool isSmallTree(yyjson_val* val, size_t limit)
+{
+    if (!yyjson_is_ctn(val)) return true;
+    return static_cast<size_t>(unsafe_yyjson_get_next(val) - val) <= limit;
+}
+
+/// Weight of subtree to balance work, the count of values up to limit.
+inline size_t treeWeight(yyjson_val* val, size_t limit)
+{
+    size_t count = yyjson_is_ctn(val) ? static_cast<size_t>(unsafe_yyjson_get_next(val) - val) : 1;
+    return count < limit ? count : limit;
+}
+
+/// Call func(key, value) for each child, key is nullptr for array item.
+template <typename Func>
+inline bool walkChildren(yyjson_val* val, Func&& func)
+{
+    if (yyjson_is_obj(val)) {
+        yyjson_obj_iter iter;
+        yyjson_obj_iter_init(val, &iter);
+        while (yyjson_val* key = yyjson_obj_iter_next(&iter)) {
+            if (!func(key, yyjson_obj_iter_get_val(key))) return false;
+        }
+    }
+    else {
+        yyjson_arr_iter iter;
+        yyjson_arr_iter_init(val, &iter);
+        while (yyjson_val* item = yyjson_arr_iter_next(&iter)) {
+            if (!func(static_cast<yyjson_val*>(nullptr), item)) return false;
+        }
+    }
+    return true;
+}
+
+#ifndef XYJSON_DISABLE_MUTABLE
+inline char* writeValue(yyjson_mut_val* val, yyjson_write_flag flg, const yyjson_alc* alc, size_t* len)
+{
+    return yyjson_mut_val_write_opts(val, flg, alc, len, nullptr);
+}
+
+inline bool appendJson(std::string& output, yyjson_mut_val* val)
+{
+    StringSink sink(output, true);
+    yyjson_alc alc = sink.c_alc();
+    size_t len = 0;
+    return sink.commit(yyjson_mut_val_write_opts(val, 0, &alc, &len, nullptr), len);
+}
+
+/// Count values up to limit, the mutable tree does not record its size.
+inline size_t countTree(yyjson_mut_val* val, size_t limit)
+{
+    size_t count = 1;
+    if (yyjson_mut_is_arr(val)) {
+        yyjson_mut_arr_iter iter;
+        yyjson_mut_arr_iter_init(val, &iter);
+        while (count <= limit) {
+            yyjson_mut_val* item = yyjson_mut_arr_iter_next(&iter);
+            if (!item) break;
+            count += countTree(item, limit - count);
+        }
+    }
+    else if (yyjson_mut_is_obj(val)) {
+        yyjson_mut_obj_iter iter;
+        yyjson_mut_obj_iter_init(val, &iter);
+        while (count <= limit) {
+            yyjson_mut_val* key = yyjson_mut_obj_iter_next(&iter);
+            if (!key) break;
+            count += 1 + countTree(yyjson_mut_obj_iter_get_val(key), limit - count);
+        }
+    }
+    return count;
+}
+
+inline bool isSmallTree(yyjson_mut_val* val, size_t limit)
+{
+    return countTree(val, limit) <= limit;
+}
+
+/// The mutable subtree is walked to count, so stop at limit.
+inline size_t treeWeight(yyjson_mut_val* val, size_t limit)
+{
+    size_t count = countTree(val, limit);
+    return count < limit ? count : limit;
+}
+
+template <typename Func>
+inline bool walkChildren(yyjson_mut_val* val, Func&& func)
+{
+    if (yyjson_mut_is_obj(val)) {
+        yyjson_mut_obj_iter iter;
+        yyjson_mut_obj_iter_init(val, &iter);
+        while (yyjson_mut_val* key = yyjson_mut_obj_iter_next(&iter)) {
+            if (!func(key, yyjson_mut_obj_iter_get_val(key))) return false;
+        }
+    }
+    else {
+        yyjson_mut_arr_iter iter;
+        yyjson_mut_arr_iter_init(val, &iter);
+        while (yyjson_mut_val* item = yyjson_mut_arr_iter_next(&iter)) {
+            if (!func(static_cast<yyjson_mut_val*>(nullptr), item)) return false;
+        }
+    }
+    return true;
+}
+#endif // XYJSON_DISABLE_MUTABLE
+
+/// Output json as toString() does, by default.
+template <typename jsonT>
+inline void streamJson(std::ostream& os, const jsonT& json)
+{
+    os << json.toString();
+}
+
+/// Stream containers in chunks, string still output as plain value.
+template <typename jsonT>
+inline void streamTree(std::ostream& os, const jsonT& json)
+{
+    if (!json.isValid() || json.isString()) {
+        os << json.toString();
+        return;
+    }
+    std::ostream::sentry guard(os);
+    if (!guard) return;
+    StreamWriter writer(os);
+    if (!writer.write(json) || !writer.flush()) os.setstate(std::ios::badbit);
+}
+
+inline void streamJson(std::ostream& os, const Value& json) { streamTree(os, json); }
+#ifndef XYJSON_DISABLE_MUTABLE
+inline void streamJson(std::ostream& os, const MutableValue& json) { streamTree(os, json); }
+#endif
+
+/// Stream buffer that appends to a string.
+class StringBuf : public std::streambuf
+{
+public:
+    explicit StringBuf(std::string& str) : m_str(str) {}
+
+protected:
+    std::streamsize xsputn(const char* s, std::streamsize n) override
+    {
+        m_str.append(s, static_cast<size_t>(n));
+        return n;
+    }
+    int_type overflow(int_type c) override
+    {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) m_str.push_back(traits_type::to_char_type(c));
+        return traits_type::not_eof(c);
+    }
+
+private:
+    std::string& m_str;
+};
+
+/* @Section 3.8: Structural Hash */
+/* ------------------------------------------------------------------------ */
+
+// Primes and rounds of XXH64.
+constexpr uint64_t kHashPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kHashPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kHashPrime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kHashPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kHashPrime5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t hashRotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t hashRound(uint64_t acc, uint64_t input)
+{
+    acc += input * kHashPrime2;
+    return hashRotl(acc, 31) * kHashPrime1;
+}
+
+inline uint64_t hashMerge(uint64_t acc, uint64_t val)
+{
+    acc ^= hashRound(0, val);
+    return acc * kHashPrime1 + kHashPrime4;
+}
+
+inline uint64_t hashAvalanche(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= kHashPrime2;
+    h ^= h >> 29;
+    h *= kHashPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+inline uint64_t hashRead64(const char* p)
+{
+    uint64_t v;
+    ::memcpy(&v, p, 8);
+    return v;
+}
+
+inline uint64_t hashRead32(const char* p)
+{
+    uint32_t v;
+    ::memcpy(&v, p, 4);
+    return v;
+}
+
+/// XXH64 of bytes, in native byte order.
+inline uint64_t hashBytes(const char* p, size_t len, uint64_t seed)
+{
+    const char* end = p + len;
+    uint64_t h;
+    if (len >= 32) {
+        uint64_t v1 = seed + kHashPrime1 + kHashPrime2;
+        uint64_t v2 = seed + kHashPrime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kHashPrime1;
+        do {
+            v1 = hashRound(v1, hashRead64(p));
+            v2 = hashRound(v2, hashRead64(p + 8));
+            v3 = hashRound(v3, hashRead64(p + 16));
+            v4 = hashRound(v4, hashRead64(p + 24));
+            p += 32;
+        } while (end - p >= 32);
+        h = hashRotl(v1, 1) + hashRotl(v2, 7) + hashRotl(v3, 12) + hashRotl(v4, 18);
+        h = hashMerge(h, v1);
+        h = hashMerge(h, v2);
+        h = hashMerge(h, v3);
+        h = hashMerge(h, v4);
+    }
+    else {
+        h = seed + kHashPrime5;
+    }
+
+    h += static_cast<uint64_t>(len);
+    for (; end - p >= 8; p += 8) {
+        h ^= hashRound(0, hashRead64(p));
+        h = hashRotl(h, 27) * kHashPrime1 + kHashPrime4;
+    }
+    if (end - p >= 4) {
+        h ^= hashRead32(p) * kHashPrime1;
+        h = hashRotl(h, 23) * kHashPrime2 + kHashPrime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= static_cast<uint8_t>(*p) * kHashPrime5;
+        h = hashRotl(h, 11) * kHashPrime1;
+    }
+    return hashAvalanche(h);
+}
+
+/// Hash of scalar, both integer subtypes hash alike as yyjson_equals.
+template <typename valT>
+inline uint64_t hashScalar(valT* val, uint64_t seed)
+{
+    uint8_t type = unsafe_yyjson_get_type(val);
+    if (type == YYJSON_TYPE_STR || type == YYJSON_TYPE_RAW) {
+        return hashBytes(val->uni.str, unsafe_yyjson_get_len(val), seed + type);
+    }
+    uint64_t tag = type | unsafe_yyjson_get_subtype(val);
+    uint64_t payload = 0;
+    if (type == YYJSON_TYPE_NUM) {
+        if (tag != (YYJSON_TYPE_NUM | YYJSON_SUBTYPE_REAL)) tag = YYJSON_TYPE_NUM | YYJSON_SUBTYPE_UINT;
+        payload = val->uni.u64;
+    }
+    return hashAvalanche(hashRound(seed + kHashPrime5 + tag, payload));
+}
+
+/// Hash of array folds items in order, of object sums members to ignore
+/// the key order.
+inline uint64_t hashTree(yyjson_val* val, uint64_t seed)
+{
+    uint8_t type = unsafe_yyjson_get_type(val);
+    if (type != YYJSON_TYPE_ARR && type != YYJSON_TYPE_OBJ) return hashScalar(val, seed);
+
+    // children laid out contiguously, next sibling after whole subtree
+    size_t count = unsafe_yyjson_get_len(val);
+    uint64_t h = seed + kHashPrime5 + type;
+    yyjson_val* child = val + 1;
+    if (type == YYJSON_TYPE_ARR) {
+        for (size_t i = 0; i < count; ++i) {
+            h = hashMerge(h, hashTree(child, seed));
+            child = unsafe_yyjson_get_next(child);
+        }
+    }
+    else {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t key = hashScalar(child, seed);
+            sum += hashAvalanche(key ^ hashRotl(hashTree(child + 1, seed), 29));
+            child = unsafe_yyjson_get_next(child + 1);
+        }
+        h = hashMerge(h, sum);
+    }
+    return hashAvalanche(h + count);
+}
+
+#ifndef XYJSON_DISABLE_MUTABLE
+inline uint64_t hashTree(yyjson_mut_val* val, uint64_t seed)
+{
+    uint8_t type = unsafe_yyjson_get_type(val);
+    if (type != YYJSON_TYPE_ARR && type != YYJSON_TYPE_OBJ) return hashScalar(val, seed);
+
+    size_t count = unsafe_yyjson_get_len(val);
+    uint64_t h = seed + kHashPrime5 + type;
+    uint64_t sum = 0;
+    walkChildren(val, [&](yyjson_mut_val* key, yyjson_mut_val* child) {
+        if (key) sum += hashAvalanche(hashScalar(key, seed) ^ hashRotl(hashTree(child, seed), 29));
+        else h = hashMerge(h, hashTree(child, seed));
+        return true;
+    });
+    if (type == YYJSON_TYPE_OBJ) h = hashMerge(h, sum);
+    return hashAvalanche(h + count);
+}
+#endif // XYJSON_DISABLE_MUTABLE
+
+} /* end of namespace yyjson::util */
+
+/* @Part 4: Class Implementations */
+/* ======================================================================== */
+
+/* @Section 4.1: Value Methods */
+/* ------------------------------------------------------------------------ */
+
+/* @Group 4.1.1: get and getor */
+/* ************************************************************************ */
+
+inline bool Value::get(bool& result) const
+{
+    if (yyjson_likely(isBool())) {
+        result = unsafe_yyjson_get_bool(m_val);
+        return true;
+    }
+    return false;
+}
+
+inline bool Value::get(int& result) const
+{
+    if (yyjson_likely(isInt())) {
+        result = unsafe_yyjson_get_int(m_val);
+        return true;
+    }
+    if (yyjson_unlikely(isRaw())) {
+        return util::getRawNumber(unsafe_yyjson_get_raw(m_val), result);
+    }
+    return false;
+}
+
+inline bool Value::get(int64_t& result) const
+{
+    if (isSint()) {
+        result = unsafe_yyjson_get_sint(m_val);
+        return true;
+    }
+    if (yyjson_unlikely(isRaw())) {
+        return util::getRawNumber(unsafe_yyjson_get_raw(m_val), result);
+    }
+    return false;
+}
+
+inline bool Value::get(uint64_t& result) const
+{
+    if (isUint()) {
+        result = unsafe_yyjson_get_uint(m_val);
+        return true;
+    }
+    if (yyjson_unlikely(isRaw())) {
+        return util::getRawNumber(unsafe_yyjson_get_raw(m_val), result);
+    }
+    return false;
+}
+
+inline bool Value::get(double& result) const
+{
+    if (yyjson_likely(isReal())) {
+        result = unsafe_yyjson_get_real(m_val);
+        return true;
+    }
+    if (yyjson_unlikely(isRaw())) {
+        return util::getRawNumber(unsafe_yyjson_get_raw(m_val), result);
+    }
+    return false;
+}
+
+inline bool Value::get(const char*& result) const
+{
+    if (yyjson_likely(isString())) {
+        result = unsafe_yyjson_get_str(m_val);
+        return true;
+    }
+    return false;
+}
+
+inline bool Value::get(std::string& result) const
+{
+    if (yyjson_likely(isString())) {
+        result = unsafe_yyjson_get_str(m_val);
+        return true;
+    }
+    return false;
+}
+
+inline bool Value::get(yyjson_val*& result) const
+{
+    if (yyjson_likely(isValid())) { result = m_val; return true; }
+    return false;
+}
+
+template<typename T>
+inline std::decay_t<T> Value::getor(T&& defaultValue) const
+{
+    using R = std::decay_t<T>;
+    R result{};
+    return get(result) ? result : static_cast<R>(defaultValue);
+}
+
+inline const char* Value::getor(EmptyString) const
+{
+    return yyjson_likely(isString()) ? unsafe_yyjson_get_str(m_val) : "";
+}
+
+inline double Value::getor(ZeroNumber) const
+{
+    return toNumber();
+}
+
+inline ConstArray Value::getor(EmptyArray) const
+{
+    return array();
+}
+
+inline ConstObject Value::getor(EmptyObject) const
+{
+    return object();
+}
+
+template<typename funcT>
+inline auto Value::pipe(funcT&& func) const
+{
+    return util::pipeApply(*this, std::forward<funcT>(func));
+}
+
+/* @Group 4.1.2: size and index/path */
+/* ************************************************************************ */
+
+inline size_t Value::size() const
+{
+    if (yyjson_unlikely(!m_val)) return 0;
+    if (yyjson_is_arr(m_val)) return yyjson_arr_size(m_val);
+    if (yyjson_is_obj(m_val)) return yyjson_obj_size(m_val);
+    return 0;
+}
+
+inline Value Value::index(size_t idx) const
+{
+    if (yyjson_unlikely(!isArray())) return Value(nullptr);
+    return Value(yyjson_arr_get(m_val, idx));
+}
+
+inline Value Value::index(const char* key, size_t len) const
+{
+    if (yyjson_unlikely(!isObject() || !key)) return Value(nullptr);
+    return Value(yyjson_obj_getn(m_val, key, len));
+}
+
+inline Value Value::pathto(const char* path, size_t len) const
+{
+    if (yyjson_unlikely(!path || len == 0)) return *this;
+    if (path[0] == '/') {
+        yyjson_val* result = yyjson_ptr_getn(m_val, path, len);
+        return Value(result);
+    }
+    return index(path, len);
+}
+
+/* @Group 4.1.3: create iterator */
+/* ************************************************************************ */
+
+inline ArrayIterator Value::iterator(size_t startIndex) const
+{
+    if (yyjson_likely(isArray())) {
+        ArrayIterator iter(m_val);
+        if (yyjson_likely(startIndex == 0)) return iter;
+        return iter.advance(startIndex);
+    }
+    return ArrayIterator();
+}
+
+inline ArrayIterator Value::iterator(int startIndex) const
+{
+    return iterator(static_cast<size_t>(startIndex));
+}
+
+inline ObjectIterator Value::iterator(const char* startKey) const
+{
+    if (yyjson_likely(isObject())) {
+        ObjectIterator iter(m_val);
+        if (yyjson_likely(startKey == nullptr || *startKey == '\0')) return iter;
+        return iter.advance(startKey);
+    }
+    return ObjectIterator();
+}
+
+inline ArrayIterator Value::iterator(EmptyArray) const
+{
+    return yyjson_likely(isArray()) ? iterator(size_t(0)) : ArrayIterator();
+}
+
+inline ObjectIterator Value::iterator(EmptyObject) const
+{
+    return yyjson_likely(isObject()) ? iterator(nullptr) : ObjectIterator();
+}
+
+inline ArrayIterator Value::beginArray() const
+{
+    return iterator(size_t(0));
+}
+
+inline ArrayIterator Value::endArray() const
+{
+    return beginArray().end();
+}
+
+inline ObjectIterator Value::beginObject() const
+{
+    return iterator((const char*)nullptr);
+}
+
+inline ObjectIterator Value::endObject() const
+{
+    return beginObject().end();
+}
+
+inline ConstArray Value::array() const 
+{
+    return ConstArray(*this);
+}
+
+inline ConstObject Value::object() const 
+{
+    return ConstObject(*this);
+}
+
+/* @Group 4.1.4: others */
+/* ************************************************************************ */
+
+inline std::string Value::toString(bool pretty) const
+{
+    if (yyjson_unlikely(!isValid())) return "";
+
+    if (isString() && !pretty) {
+        return std::string(yyjson_get_str(m_val), yyjson_get_len(m_val));
+    }
+
+    std::string result;
+    write(result, pretty ? YYJSON_WRITE_PRETTY : YYJSON_WRITE_NOFLAG);
+    return result;
+}
+
+inline bool Value::write(std::string& output, yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/) const
+{
+    if (yyjson_unlikely(!isValid())) return false;
+    util::StringSink sink(output);
+    yyjson_alc alc = sink.c_alc();
+    size_t len = 0;
+    return sink.commit(yyjson_val_write_opts(m_val, flg, &alc, &len, nullptr), len);
+}
+
+inline bool Value::write(WriteBuffer& output, yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/) const
+{
+    if (yyjson_unlikely(!isValid())) return false;
+    yyjson_alc alc = output.c_alc();
+    size_t len = 0;
+    return output.commit(yyjson_val_write_opts(m_val, flg, &alc, &len, nullptr), len);
+}
+
+inline int Value::toInteger() const
+{
+    if (yyjson_unlikely(!isValid())) return 0;
+    if (isArray() || isObject())
+    {
+        return static_cast<int>(size());
+    }
+    return util::toIntegerCast(*this);
+}
+
+inline double Value::toNumber() const
+{
+    if (yyjson_unlikely(isRaw())) {
+        return util::rawToNumber(unsafe_yyjson_get_raw(m_val));
+    }
+    return yyjson_get_num(m_val);
+}
+
+inline bool Value::equal(const Value& other) const
+{
+    return (m_val == other.m_val) || yyjson_equals(m_val, other.m_val);
+}
+
+inline bool Value::less(const Value& other) const
+{
+    return util::lessCompare(*this, other);
+}
+
+inline uint64_t Value::hash(uint64_t seed/* = 0*/) const
+{
+    if (yyjson_unlikely(!m_val)) return 0;
+    return util::hashTree(m_val, seed);
+}
+
+/* @Section 4.2: Document Methods */
+/* ------------------------------------------------------------------------ */
+
+/* @Group 4.2.1: primary manage */
+/* ************************************************************************ */
+
+inline Document::Document(yyjson_doc* doc) : m_doc(doc)
+{
+}
+
+inline Document::Document(const char* str, size_t len/* = 0*/)
+{
+    if (len == 0 && str) len = strlen(str);
+    m_doc = yyjson_read(str, len, 0);
+}
+
+inline Document::Document(const char* str, size_t len, const Allocator& alc)
+{
+    read(str, len, ReadOptions(alc));
+}
+
+inline Document::Document(const char* str, size_t len, const ReadOptions& opt)
+{
+    read(str, len, opt);
+}
+
+#ifndef XYJSON_DISABLE_MUTABLE
+inline Document::Document(const MutableDocument& other)
+{
+    *this = other.freeze();
+}
+#endif
+
+inline void Document::free()
+{
+    if (yyjson_likely(m_doc))
+    {
+        yyjson_doc_free(m_doc);
+        m_doc = nullptr;
+    }
+}
+
+inline MemoryUsage Document::memoryUsage() const
+{
+    MemoryUsage usage;
+    if (yyjson_unlikely(!m_doc)) return usage;
+
+    size_t hdr = (sizeof(yyjson_doc) + sizeof(yyjson_val) - 1) / sizeof(yyjson_val) * sizeof(yyjson_val);
+    usage.values = yyjson_doc_get_val_count(m_doc);
+    if (m_doc->str_pool) {
+        usage.strings = m_doc->dat_read + YYJSON_PADDING_SIZE;
+    }
+    else if (util::DocHolder::isHolder(m_doc->alc)) {
+        // in-situ input or string chunks kept by holder
+        usage.strings = static_cast<const util::DocHolder*>(m_doc->alc.ctx)->bytes();
+    }
+    usage.used = hdr + usage.values * sizeof(yyjson_val) + usage.strings;
+    usage.allocated = usage.used;
+    return usage;
+}
+
+#ifndef XYJSON_DISABLE_MUTABLE
+// Convert read-only document to mutable document
+inline MutableDocument Document::mutate() const
+{
+    if (yyjson_unlikely(!isValid())) {
+        return MutableDocument((yyjson_mut_doc*)nullptr);
+    }
+
+    yyjson_mut_doc* mut_doc = yyjson_doc_mut_copy(m_doc, util::docAllocator(m_doc));
+    return MutableDocument(mut_doc);
+}
+
+inline MutableDocument Document::mutate(const Allocator& alc) const
+{
+    if (yyjson_unlikely(!isValid())) {
+        return MutableDocument((yyjson_mut_doc*)nullptr);
+    }
+
+    yyjson_mut_doc* mut_doc = yyjson_doc_mut_copy(m_doc, alc.c_alc());
+    return MutableDocument(mut_doc);
+}
+#endif
+
+/* @Group 4.2.2: read and write */
+/* ************************************************************************ */
+
+inline bool Document::read(const char* str, size_t len)
+{
+    free();
+    
+    if (len == 0 && str) len = strlen(str);
+    m_doc = yyjson_read(str, len, 0);
+    return isValid();
+}
+
+inline bool Document::read(FILE* fp)
+{
+    free();
+    
+    if (yyjson_unlikely(!fp)) return false;
+    m_doc = yyjson_read_fp(fp, 0, nullptr, nullptr);
+    return isValid();
+}
+
+inline bool Document::read(std::istream& is)
+{
+    free();
+
+    std::string buffer;
+    if (yyjson_unlikely(!util::readStream(is, buffer))) return false;
+    return read(std::move(buffer));
+}
+
+inline bool Document::readFile(const char* path)
+{
+    if (yyjson_unlikely(!path)) return false;
+    FILE* fp = fopen(path, "rb");
+    if (yyjson_unlikely(!fp)) return false;
+
+    bool result = read(fp);
+    fclose(fp);
+    return result;
+}
+
+inline bool Document::read(const char* str, size_t len, const Allocator& alc)
+{
+    return read(str, len, ReadOptions(alc));
+}
+
+inline bool Document::read(FILE* fp, const Allocator& alc)
+{
+    return read(fp, ReadOptions(alc));
+}
+
+inline bool Document::readFile(const char* path, const Allocator& alc)
+{
+    return readFile(path, ReadOptions(alc));
+}
+
+inline bool Document::read(const char* str, size_t len, const ReadOptions& opt)
+{
+    free();
+
+    if (len == 0 && str) len = strlen(str);
+    if (yyjson_unlikely(!str)) return false;
+    // not in-situ, the input is not modified
+    yyjson_read_flag flg = opt.flag & ~YYJSON_READ_INSITU;
+    m_doc = yyjson_read_opts(const_cast<char*>(str), len, flg, opt.alc.c_alc(), opt.err);
+    return isValid();
+}
+
+inline bool Document::read(FILE* fp, const ReadOptions& opt)
+{
+    free();
+
+    if (yyjson_unlikely(!fp)) return false;
+    m_doc = yyjson_read_fp(fp, opt.flag, opt.alc.c_alc(), opt.err);
+    return isValid();
+}
+
+inline bool Document::readFile(const char* path, const ReadOptions& opt)
+{
+    if (yyjson_unlikely(!path)) return false;
+    FILE* fp = fopen(path, "rb");
+    if (yyjson_unlikely(!fp)) return false;
+
+    bool result = read(fp, opt);
+    fclose(fp);
+    return result;
+}
+
+inline bool Document::read(std::string&& str)
+{
+    return read(std::move(str), ReadOptions());
+}
+
+inline bool Document::read(std::string&& str, const Allocator& alc)
+{
+    return read(std::move(str), ReadOptions(alc));
+}
+
+inline bool Document::read(std::string&& str, const ReadOptions& opt)
+{
+    free();
+
+    // move before padding, short string data may move with the object
+    auto* holder = new util::StringHolder(std::move(str), opt.alc.c_alc());
+    size_t len = holder->buffer.size();
+    holder->buffer.append(YYJSON_PADDING_SIZE, '\0');
+    m_doc = util::holderRead(holder, &holder->buffer[0], len,
+        opt.flag | YYJSON_READ_INSITU, opt.err);
+    return isValid();
+}
+
+inline bool Document::read(const char* str, size_t len, const Projection& proj)
+{
+    return read(str, len, proj, ReadOptions());
+}
+
+inline bool Document::read(const char* str, size_t len, const Projection& proj,
+    const ReadOptions& opt)
+{
+    if (proj.empty()) return read(str, len, opt);
+
+    std::string text;
+    if (yyjson_unlikely(!proj.apply(str, len, text))) {
+        free();
+        if (opt.err) {
+            opt.err->code = YYJSON_READ_ERROR_UNEXPECTED_CHARACTER;
+            opt.err->msg = "malformed json for projection";
+            opt.err->pos = 0;
+        }
+        return false;
+    }
+    return read(std::move(text), opt);
+}
+
+inline bool Document::read(char* str, size_t len, size_t capacity)
+{
+    if (yyjson_unlikely(!str)) { free(); return false; }
+    if (capacity < len + YYJSON_PADDING_SIZE) {
+        return read(std::string(str, len));
+    }
+
+    free();
+    ::memset(str + len, 0, YYJSON_PADDING_SIZE);
+    m_doc = yyjson_read_opts(str, len, YYJSON_READ_INSITU, nullptr, nullptr);
+    return isValid();
+}
+
+inline bool Document::mmapFile(const char* path, unsigned flags/* = kMmapSequential | kMmapInsitu*/)
+{
+#ifdef XYJSON_HAS_MMAP
+    free();
+
+    if (yyjson_unlikely(!path)) return false;
+    int fd = ::open(path, O_RDONLY);
+    if (yyjson_unlikely(fd < 0)) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    // MAP_POPULATE on private writable mapping would prefault for write and
+    // copy every page, so it only applies to read-only mapping
+    int mapFlag = 0;
+#ifdef MAP_POPULATE
+    if ((flags & kMmapPopulate) && !(flags & kMmapInsitu)) mapFlag |= MAP_POPULATE;
+#endif
+
+    void* addr = MAP_FAILED;
+    size_t mapSize = size;
+    if (flags & kMmapInsitu) {
+        // reserve zero pages for padding, then map the file over the front
+        mapSize = size + YYJSON_PADDING_SIZE;
+        addr = ::mmap(nullptr, mapSize, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (yyjson_likely(addr != MAP_FAILED) &&
+            ::mmap(addr, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_FIXED | mapFlag, fd, 0) == MAP_FAILED) {
+            ::munmap(addr, mapSize);
+            addr = MAP_FAILED;
+        }
+    }
+    else {
+        addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED | mapFlag, fd, 0);
+    }
+    ::close(fd);
+    if (yyjson_unlikely(addr == MAP_FAILED)) return false;
+
+#ifdef MADV_SEQUENTIAL
+    if (flags & kMmapSequential) ::madvise(addr, size, MADV_SEQUENTIAL);
+#endif
+#ifdef MADV_WILLNEED
+    if ((flags & kMmapPopulate) && (flags & kMmapInsitu)) ::madvise(addr, size, MADV_WILLNEED);
+#endif
+
+    if (flags & kMmapInsitu) {
+        auto* holder = new util::MmapHolder(addr, mapSize, nullptr);
+        m_doc = util::holderRead(holder, static_cast<char*>(addr), size, YYJSON_READ_INSITU);
+    }
+    else {
+        // strings are copied by yyjson, the mapping is needless after parsing
+        m_doc = yyjson_read(static_cast<const char*>(addr), size, 0);
+        ::munmap(addr, mapSize);
+    }
+    return isValid();
+#else
+    (void)flags;
+    return readFile(path);
+#endif
+}
+
+inline bool Document::write(std::string& output, yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/) const
+{
+    if (yyjson_unlikely(!m_doc)) return false;
+    util::StringSink sink(output);
+    yyjson_alc alc = sink.c_alc();
+    size_t len = 0;
+    return sink.commit(yyjson_write_opts(m_doc, flg, &alc, &len, nullptr), len);
+}
+
+inline bool Document::write(WriteBuffer& output, yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/) const
+{
+    if (yyjson_unlikely(!m_doc)) return false;
+    yyjson_alc alc = output.c_alc();
+    size_t len = 0;
+    return output.commit(yyjson_write_opts(m_doc, flg, &alc, &len, nullptr), len);
+}
+
+inline bool Document::write(FILE* fp) const
+{
+    if (yyjson_unlikely(!m_doc || !fp)) return false;
+    // streamed in chunks, not the whole text at once
+    StreamWriter writer(fp);
+    return writer.write(*this) && writer.flush();
+}
+
+inline bool Document::write(std::ofstream& ofs) const
+{
+    if (yyjson_unlikely(!m_doc)) return false;
+    ofs.seekp(0, std::ios::beg);
+    StreamWriter writer(ofs);
+    bool result = writer.write(*this) && writer.flush();
+    ofs.flush();
+    return result && !ofs.fail();
+}
+
+inline bool Document::writeFile(const char* path) const
+{
+    if (yyjson_unlikely(!path)) return false;
+    FILE* fp = fopen(path, "wb");
+    if (yyjson_unlikely(!fp)) return false;
+
+    bool result = write(fp);
+    fclose(fp);
+    return result;
+}
+
+#ifndef XYJSON_DISABLE_MUTABLE
+/* @Section 4.3: MutableValue Methods */
+/* ------------------------------------------------------------------------ */
+
+/* @Group 4.3.1: get and getor */
+/* ************************************************************************ */
+
+inline bool MutableValue::get(bool& result) const
+{
+    if (yyjson_likely(isBool())) {
+        result = unsafe_yyjson_get_bool((yyjson_val*)m_val); // yyjson_mut_get_bool
+        return true;
+    }
+    return false;
+}
+
+inline bool MutableValue::get(int& result) const
+{
+    if (yyjson_likely(isInt())) {
+        result = unsafe_yyjson_get_int((yyjson_val*)m_val); // yyjson_mut_get_int
+        return true;
+    }
+    if (yyjson_unlikely(isRaw())) {
+        return util::getRawNumber(unsafe_yyjson_get_raw(m_val), result);
+    }
+    return false;
+}
+
+inline bool MutableValue::get(int64_t& result) const
+{
+    if (isSint()) {
+        result = unsafe_yyjson_get_sint((yyjson_val*)m_val); // yyjson_mut_get_sint
+        return true;
+    }
+    if (yyjson_unlikely(isRaw())) {
+        return util::getRawNumber(unsafe_yyjson_get_raw(m_val), result);
+    }
+    return false;
+}
+
+inline bool MutableValue::get(uint64_t& result) const
+{
+    if (isUint()) {
+        result = unsafe_yyjson_get_uint((yyjson_val*)m_val); // yyjson_mut_get_uint
+        return true;
+    }
+    if (yyjson_unlikely(isRaw())) {
+        return util::getRawNumber(unsafe_yyjson_get_raw(m_val), result);
+    }
+    return false;
+}
+
+inline bool MutableValue::get(double& result) const
+{
+    if (yyjson_likely(isReal())) {
+        result = unsafe_yyjson_get_real((yyjson_val*)m_val); // yyjson_mut_get_real
+        return true;
+    }
+    if (yyjson_unlikely(isRaw())) {
+        return util::getRawNumber(unsafe_yyjson_get_raw(m_val), result);
+    }
+    return false;
+}
+
+inline bool MutableValue::get(const char*& result) const
+{
+    if (yyjson_likely(isString())) {
+        result = unsafe_yyjson_get_str((yyjson_val*)m_val); // yyjson_mut_get_str
+        return true;
+    }
+    return false;
+}
+
+inline bool MutableValue::get(std::string& result) const
+{
+    if (yyjson_likely(isString())) {
+        result = unsafe_yyjson_get_str((yyjson_val*)m_val); // yyjson_mut_get_str
+        return true;
+    }
+    return false;
+}
+
+inline bool MutableValue::get(yyjson_mut_val*& result) const
+{
+    if (yyjson_likely(isValid())) { result = m_val; return true; }
+    return false;
+}
+
+inline bool MutableValue::get(yyjson_mut_doc*& result) const
+{
+    if (yyjson_likely(m_doc != nullptr)) { result = m_doc; return true; }
+    return false;
+}
+
+template<typename T>
+inline std::decay_t<T> MutableValue::getor(T&& defaultValue) const
+{
+    using R = std::decay_t<T>;
+    R result{};
+    return get(result) ? result : static_cast<R>(defaultValue);
+}
+
+inline const char* MutableValue::getor(EmptyString) const
+{
+    return yyjson_likely(isString()) ? unsafe_yyjson_get_str((yyjson_val*)m_val) : "";
+}
+
+inline double MutableValue::getor(ZeroNumber) const
+{
+    return toNumber();
+}
+
+inline MutableArray MutableValue::getor(EmptyArray) const
+{
+    return array();
+}
+
+inline MutableObject MutableValue::getor(EmptyObject) const
+{
+    return object();
+}
+
+template<typename funcT>
+inline auto MutableValue::pipe(funcT&& func) const
+{
+    return util::pipeApply(*this, std::forward<funcT>(func));
+}
+
+/* @Group 4.3.2: size and index/path */
+/* ************************************************************************ */
+
+inline size_t MutableValue::size() const
+{
+    if (yyjson_unlikely(!m_val)) return 0;
+    if (yyjson_mut_is_arr(m_val)) return yyjson_mut_arr_size(m_val);
+    if (yyjson_mut_is_obj(m_val)) return yyjson_mut_obj_size(m_val);
+    return 0;
+}
+
+inline void MutableValue::clear()
+{
+    if (yyjson_unlikely(!m_val || !m_doc)) return;
+
+    if (yyjson_mut_is_arr(m_val)) {
+        yyjson_mut_arr_clear(m_val);
+    }
+    else if (yyjson_mut_is_obj(m_val)) {
+        yyjson_mut_obj_clear(m_val);
+    }
+    else if (yyjson_mut_is_str(m_val)) {
+        set("");
+    }
+    else if (yyjson_mut_is_int(m_val) || yyjson_mut_is_sint(m_val) || yyjson_mut_is_uint(m_val)) {
+        set(0);
+    }
+    else if (yyjson_mut_is_real(m_val)) {
+        set(0.0);
+    }
+    // Note: null and bool types are not cleared as they have no meaningful "zero" value
+}
+
+inline MutableValue MutableValue::index(size_t idx) const
+{
+    if (yyjson_unlikely(!isArray())) return MutableValue(nullptr, m_doc);
+    return MutableValue(yyjson_mut_arr_get(m_val, idx), m_doc);
+}
+
+inline MutableValue MutableValue::index(const char* key, size_t len) const
+{
+    if (yyjson_unlikely(!isObject() || !key)) return MutableValue(nullptr, m_doc);
+    return MutableValue(yyjson_mut_obj_getn(m_val, key, len), m_doc);
+}
+
+inline MutableValue MutableValue::index(size_t idx)
+{
+    if (yyjson_unlikely(!isArray())) return MutableValue(nullptr, m_doc);
+    return MutableValue(yyjson_mut_arr_get(m_val, idx), m_doc);
+}
+
+inline MutableValue MutableValue::index(const char* key, size_t len)
+{
+    if (yyjson_unlikely(!isObject() || !key)) return MutableValue(nullptr, m_doc);
+    yyjson_mut_val* val = yyjson_mut_obj_getn(m_val, key, len);
+    if (yyjson_unlikely(!val)) {
+        // Key doesn't exist, insert null value with explicit length
+        val = yyjson_mut_null(m_doc);
+        yyjson_mut_val* key_val = yyjson_mut_strncpy(m_doc, key, len);
+        yyjson_mut_obj_add(m_val, key_val, val);
+    }
+    return MutableValue(val, m_doc);
+}
+
+inline MutableValue MutableValue::pathto(const char* path, size_t len) const
+{
+    if (yyjson_unlikely(!path || len == 0)) return *this;
+    if (path[0] == '/') {
+        yyjson_mut_val* result = yyjson_mut_ptr_getn(m_val, path, len);
+        return MutableValue(result, m_doc);
+    }
+    return index(path, len);
+}
+
+/* @Group 4.3.3: assignment set */
+/* ************************************************************************ */
+
+inline MutableValue& MutableValue::set(const MutableValue& other)
+{
+    if (this != &other) {
+        m_val = other.m_val;
+        m_doc = other.m_doc;
+    }
+    return *this;
+}
+
+inline MutableValue& MutableValue::set(std::nullptr_t value)
+{
+    yyjson_mut_set_null(m_val);
+    return *this;
+}
+
+inline MutableValue& MutableValue::set(bool value)
+{
+    yyjson_mut_set_bool(m_val, value);
+    return *this;
+}
+
+inline MutableValue& MutableValue::set(int value)
+{
+    yyjson_mut_set_int(m_val, value);
+    return *this;
+}
+
+inline MutableValue& MutableValue::set(int64_t value)
+{
+    yyjson_mut_set_sint(m_val, value);
+    return *this;
+}
+
+inline MutableValue& MutableValue::set(uint64_t value)
+{
+    yyjson_mut_set_uint(m_val, value);
+    return *this;
+}
+
+inline MutableValue& MutableValue::set(double value)
+{
+    yyjson_mut_set_real(m_val, value);
+    return *this;
+}
+
+inline MutableValue& MutableValue::set(const std::string& value)
+{
+    return setCopy(value.c_str(), value.size());
+}
+
+inline MutableValue& MutableValue::set(StringRef value)
+{
+    if (value.len == 2)
+    {
+        if (::strcmp(value, "{}") == 0) { return setObject(); }
+        if (::strcmp(value, "[]") == 0) { return setArray(); }
+    }
+    yyjson_mut_set_strn(m_val, value.str, value.len);
+    return *this;
+}
+
+inline MutableValue& MutableValue::setCopy(const char* value, size_t len)
+{
+    if (isValid() && value)
+    {
+        // copy input value to new node
+        // let old node point to the string in the new old.
+        // Note the new node and old string is not accessible
+        // and only free when the document is freed.
+        yyjson_mut_val* newNode = yyjson_mut_strncpy(m_doc, value, len);
+        const char* newStr = yyjson_mut_get_str(newNode);
+        yyjson_mut_set_str(m_val, newStr);
+    }
+    return *this;
+}
+
+template <size_t N>
+inline MutableValue& MutableValue::set(const char(&value)[N])
+{
+    if (N == 3)
+    {
+        if (::strcmp(value, "{}") == 0) { return setObject(); }
+        if (::strcmp(value, "[]") == 0) { return setArray(); }
+    }
+    yyjson_mut_set_strn(m_val, value, N-1);
+    return *this;
+}
+
+template <size_t N>
+inline MutableValue& MutableValue::set(char(&value)[N])
+{
+    return setCopy(value, ::strlen(value));
+}
+
+template<typename T>
+inline typename std::enable_if<trait::is_cstr_type<T>(), MutableValue&>::type
+MutableValue::set(T value)
+{
+    return setCopy(value, ::strlen(value));
+}
+
+inline MutableValue& MutableValue::setArray()
+{
+    if (yyjson_unlikely(isValid()))
+    {
+        yyjson_mut_set_arr(m_val);
+    }
+    return *this;
+}
+
+inline MutableValue& MutableValue::setObject()
+{
+    if (yyjson_unlikely(isValid()))
+    {
+        yyjson_mut_set_obj(m_val);
+    }
+    return *this;
+}
+
+/* @Group 4.3.4: array and object add */
+/* ************************************************************************ */
+
+inline MutableValue& MutableValue::append(yyjson_mut_val* value)
+{
+    yyjson_mut_arr_append(m_val, value); // the C API would check argument
+    return *this;
+}
+
+template <typename T>
+inline MutableValue& MutableValue::append(T&& value)
+{
+    return append(util::create(m_doc, std::forward<T>(value)));
+}
+
+inline MutableValue& MutableValue::add(yyjson_mut_val* key, yyjson_mut_val* value)
+{
+    yyjson_mut_obj_add(m_val, key, value); // the C API would check argument
+    return *this;
+}
+
+inline MutableValue& MutableValue::add(KeyValue&& kv)
+{
+    if (yyjson_likely(yyjson_mut_obj_add(m_val, kv.key, kv.value)))
+    {
+        kv.key = nullptr;
+        kv.value = nullptr;
+    }
+    return *this;
+}
+
+template<typename keyT, typename valT>
+inline MutableValue& MutableValue::add(keyT&& key, valT&& value)
+{
+    if (yyjson_likely(isObject())) {
+        yyjson_mut_val* keyNode = util::createKey(m_doc, std::forward<keyT>(key));
+        if (yyjson_unlikely(!keyNode)) {
+            return *this;
+        }
+        
+        yyjson_mut_val* valNode = util::create(m_doc, std::forward<valT>(value));
+        yyjson_mut_obj_add(m_val, keyNode, valNode);
+    }
+    return *this;
+}
+
+/* @Group 4.3.5: smart input and tag */
+/* ************************************************************************ */
+
+inline KeyValue MutableValue::tag(MutableValue&& key) &&
+{
+    // Require same document pool and string type; do not copy
+    yyjson_mut_val* keyNode = nullptr;
+    if (yyjson_likely(key.m_doc == m_doc && key.isString()))
+    {
+        keyNode = key.m_val;
+    }
+    auto ret = KeyValue(keyNode, m_val);
+    m_val = nullptr;
+    key.m_val = nullptr;
+    return ret;
+}
+
+template <typename keyT>
+inline KeyValue MutableValue::tag(keyT&& key) &&
+{
+    yyjson_mut_val* keyNode = util::createKey(m_doc, std::forward<keyT>(key));
+    auto ret = KeyValue(keyNode, m_val);
+    m_val = nullptr;
+    return ret;
+}
+
+// Specialization for KeyValue - can only be added to object
+inline MutableValue& MutableValue::push(KeyValue&& kv)
+{
+    if (yyjson_likely(isObject()))
+    {
+        return add(std::forward<KeyValue>(kv));
+    }
+    return *this;
+}
+
+#ifndef XYJSON_DISABLE_CHAINED_INPUT
+template <typename keyT>
+inline bool MutableValue::pushKey(keyT&& key)
+{
+    m_pendingKey = util::createKey(m_doc, std::forward<keyT>(key));
+    return false;
+}
+
+template <typename T>
+inline bool MutableValue::pushValue(T&& value)
+{
+    if (yyjson_likely(m_pendingKey == nullptr)) {
+        return false;
+    }
+    yyjson_mut_val* succeedVal = util::create(m_doc, std::forward<T>(value));
+    add(m_pendingKey, succeedVal);
+    m_pendingKey = nullptr;
+    return true;
+}
+#endif
+
+// General template for other types
+template <typename T>
+inline MutableValue& MutableValue::push(T&& value)
+{
+    if (isArray()) {
+        return append(std::forward<T>(value));
+    }
+#ifndef XYJSON_DISABLE_CHAINED_INPUT
+    else if (isObject()) {
+        bool ok = pushValue(std::forward<T>(value)) || pushKey(std::forward<T>(value));
+    }
+#endif
+    return *this;
+}
+
+// Pop method for array: remove last element and return it
+inline MutableValue& MutableValue::pop(MutableValue& result)
+{
+    if (yyjson_likely(isArray())) {
+        size_t n = size();
+        if (yyjson_likely(n > 0)) {
+            MutableArrayIterator iter = beginArray();
+            iter.advance(n - 1);
+            result = iter.remove();
+            return *this;
+        }
+    }
+    result = MutableValue(nullptr, m_doc);
+    return *this;
+}
+
+// Pop method for object: remove last key-value pair and return it
+inline MutableValue& MutableValue::pop(KeyValue& result)
+{
+    if (yyjson_likely(isObject())) {
+        size_t n = size();
+        if (yyjson_likely(n > 0)) {
+            MutableObjectIterator iter = beginObject();
+            iter.advance(n - 1);
+            result = iter.remove();
+            return *this;
+        }
+    }
+    result = KeyValue(nullptr, nullptr);
+    return *this;
+}
+
+/* @Group 4.3.6: create iterator */
+/* ************************************************************************ */
+
+inline MutableArrayIterator MutableValue::iterator(size_t startIndex) const
+{
+    if (yyjson_likely(isArray())) {
+        MutableArrayIterator iter(m_val, m_doc);
+        if (yyjson_likely(startIndex == 0)) return iter;
+        return iter.advance(startIndex);
+    }
+    return MutableArrayIterator();
+}
+
+inline MutableArrayIterator MutableValue::iterator(int startIndex) const
+{
+    return iterator(static_cast<size_t>(startIndex));
+}
+
+inline MutableObjectIterator MutableValue::iterator(const char* startKey) const
+{
+    if (yyjson_likely(isObject())) {
+        MutableObjectIterator iter(m_val, m_doc);
+        if (yyjson_likely(startKey == nullptr || *startKey == '\0')) return iter;
+        return iter.advance(startKey);
+    }
+    return MutableObjectIterator();
+}
+
+inline MutableArrayIterator MutableValue::iterator(EmptyArray) const
+{
+    return yyjson_likely(isArray()) ? iterator(size_t(0)) : MutableArrayIterator();
+}
+
+inline MutableObjectIterator MutableValue::iterator(EmptyObject) const
+{
+    return yyjson_likely(isObject()) ? iterator(nullptr) : MutableObjectIterator();
+}
+
+inline MutableArrayIterator MutableValue::beginArray() const
+{
+    return iterator(size_t(0));
+}
+
+inline MutableArrayIterator MutableValue::endArray() const
+{
+    return beginArray().end();
+}
+
+inline MutableObjectIterator MutableValue::beginObject() const
+{
+    return iterator((const char*)nullptr);
+}
+
+inline MutableObjectIterator MutableValue::endObject() const
+{
+    return beginObject().end();
+}
+
+inline MutableArray MutableValue::array() const
+{
+    return MutableArray(*this);
+}
+
+inline MutableObject MutableValue::object() const
+{
+    return MutableObject(*this);
+}
+
+/* @Group 4.3.7: others */
+/* ************************************************************************ */
+
+inline std::string MutableValue::toString(bool pretty) const
+{
+    if (yyjson_unlikely(!isValid())) return "";
+
+    if (isString() && !pretty) {
+        return std::string(yyjson_mut_get_str(m_val), yyjson_mut_get_len(m_val));
+    }
+
+    std::string result;
+    write(result, pretty ? YYJSON_WRITE_PRETTY : YYJSON_WRITE_NOFLAG);
+    return result;
+}
+
+inline bool MutableValue::write(std::string& output, yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/) const
+{
+    if (yyjson_unlikely(!isValid())) return false;
+    util::StringSink sink(output);
+    yyjson_alc alc = sink.c_alc();
+    size_t len = 0;
+    return sink.commit(yyjson_mut_val_write_opts(m_val, flg, &alc, &len, nullptr), len);
+}
+
+inline bool MutableValue::write(WriteBuffer& output, yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/) const
+{
+    if (yyjson_unlikely(!isValid())) return false;
+    yyjson_alc alc = output.c_alc();
+    size_t len = 0;
+    return output.commit(yyjson_mut_val_write_opts(m_val, flg, &alc, &len, nullptr), len);
+}
+
+inline int MutableValue::toInteger() const
+{
+    if (yyjson_unlikely(!isValid())) return 0;
+    if (isArray() || isObject())
+    {
+        return static_cast<int>(size());
+    }
+    return util::toIntegerCast(*this);
+}
+
+inline double MutableValue::toNumber() const
+{
+    if (yyjson_unlikely(isRaw())) {
+        return util::rawToNumber(unsafe_yyjson_get_raw(m_val));
+    }
+    return yyjson_mut_get_num(m_val);
+}
+
+inline bool MutableValue::equal(const MutableValue& other) const
+{
+    return (m_val == other.m_val) || yyjson_mut_equals(m_val, other.m_val);
+}
+
+inline uint64_t MutableValue::hash(uint64_t seed/* = 0*/) const
+{
+    if (yyjson_unlikely(!m_val)) return 0;
+    return util::hashTree(m_val, seed);
+}
+
+inline bool MutableValue::less(const MutableValue& other) const
+{
+    return util::lessCompare(*this, other);
+}
+
+/* @Section 4.4: MutableDocument Methods */
+/* ------------------------------------------------------------------------ */
+
+/* @Group 4.4.1: primary manage */
+/* ************************************************************************ */
+
+inline MutableDocument::MutableDocument()
 {
-    return create(doc, std::forward<T>(key));
+    // empty object root, not parse "{}"
+    m_doc = yyjson_mut_doc_new(nullptr);
+    if (yyjson_likely(m_doc)) {
+        yyjson_mut_doc_set_root(m_doc, yyjson_mut_obj(m_doc));
+    }
 }
 
-template<typename T>
-inline typename std::enable_if<!trait::is_key_v<T>, yyjson_mut_val*>::type
-createKey(yyjson_mut_doc* doc, T&& key)
+inline MutableDocument::MutableDocument(yyjson_mut_doc* doc) : m_doc(doc)
 {
-    return nullptr;
 }
 
-// Specialization for MutableValue key
-inline yyjson_mut_val* createKey(yyjson_mut_doc* doc, const MutableValue& key)
+inline MutableDocument::MutableDocument(const char* str, size_t len/* = 0*/)
 {
-    if (key.isString()) {
-        return create(doc, key);
+    if (len == 0 && str) len = strlen(str);
+    m_doc = util::mutAdopt(yyjson_read(str, len, 0));
+}
+
+inline MutableDocument::MutableDocument(const Allocator& alc)
+{
+    m_doc = yyjson_mut_doc_new(alc.c_alc());
+    if (yyjson_likely(m_doc)) {
+        yyjson_mut_doc_set_root(m_doc, yyjson_mut_obj(m_doc));
     }
-    return nullptr;
 }
 
-// Move semantics overload for MutableValue&& key
-inline yyjson_mut_val* createKey(yyjson_mut_doc* doc, MutableValue&& key)
+inline MutableDocument::MutableDocument(const char* str, size_t len, const Allocator& alc)
+{
+    read(str, len, ReadOptions(alc));
+}
+
+inline MutableDocument::MutableDocument(const char* str, size_t len, const ReadOptions& opt)
+{
+    read(str, len, opt);
+}
+
+inline MutableDocument::MutableDocument(const Document& other)
+{
+    *this = other.mutate();
+}
+
+inline void MutableDocument::free()
+{
+    if (yyjson_likely(m_doc))
+    {
+        yyjson_mut_doc_free(m_doc);
+        m_doc = nullptr;
+    }
+}
+
+// Convert mutable document to read-only document
+inline Document MutableDocument::freeze() const&
+{
+    if (yyjson_unlikely(!isValid())) {
+        return Document((yyjson_doc*)nullptr);
+    }
+    
+    yyjson_doc* doc = yyjson_mut_doc_imut_copy(m_doc, util::docAllocator(m_doc));
+    return Document(doc);
+}
+
+inline Document MutableDocument::freeze(const Allocator& alc) const
+{
+    if (yyjson_unlikely(!isValid())) {
+        return Document((yyjson_doc*)nullptr);
+    }
+    
+    yyjson_doc* doc = yyjson_mut_doc_imut_copy(m_doc, alc.c_alc());
+    return Document(doc);
+}
+
+inline Document MutableDocument::freeze() &&
+{
+    if (yyjson_unlikely(!isValid())) {
+        return Document((yyjson_doc*)nullptr);
+    }
+
+    yyjson_doc* doc = util::freezeInPlace(m_doc);
+    if (yyjson_likely(doc)) {
+        m_doc = nullptr;
+        return Document(doc);
+    }
+
+    // fallback to copy, e.g. empty root
+    Document result = static_cast<const MutableDocument&>(*this).freeze();
+    free();
+    return result;
+}
+
+inline void MutableDocument::setRoot(MutableValue val)
+{
+    if (yyjson_likely(m_doc))
+    {
+        yyjson_mut_doc_set_root(m_doc, val.get());
+    }
+}
+
+inline bool MutableDocument::reserve(size_t values, size_t strBytes/* = 0*/)
+{
+    if (yyjson_unlikely(!m_doc)) return false;
+
+    // yyjson allocates a chunk of the size when the current one is full
+    bool result = true;
+    if (values > 0 && !yyjson_mut_doc_set_val_pool_size(m_doc, values)) result = false;
+    if (strBytes > 0 && !yyjson_mut_doc_set_str_pool_size(m_doc, strBytes)) result = false;
+    return result;
+}
+
+inline MemoryUsage MutableDocument::memoryUsage() const
+{
+    MemoryUsage usage;
+    if (yyjson_unlikely(!m_doc)) return usage;
+
+    // the first slot of each value chunk is taken by chunk header
+    size_t valBytes = 0;
+    size_t slots = 0;
+    for (yyjson_val_chunk* chunk = m_doc->val_pool.chunks; chunk; chunk = chunk->next) {
+        valBytes += chunk->chunk_size;
+        slots += chunk->chunk_size / sizeof(yyjson_mut_val) - 1;
+    }
+    size_t strBytes = 0;
+    size_t strSpace = 0;
+    for (yyjson_str_chunk* chunk = m_doc->str_pool.chunks; chunk; chunk = chunk->next) {
+        strBytes += chunk->chunk_size;
+        strSpace += chunk->chunk_size - sizeof(yyjson_str_chunk);
+    }
+    size_t valFree = static_cast<size_t>(m_doc->val_pool.end - m_doc->val_pool.cur);
+    size_t strFree = static_cast<size_t>(m_doc->str_pool.end - m_doc->str_pool.cur);
+
+    size_t held = 0;
+    if (util::DocHolder::isHolder(m_doc->alc)) {
+        held = static_cast<const util::DocHolder*>(m_doc->alc.ctx)->bytes();
+    }
+    usage.values = slots - valFree;
+    usage.strings = strSpace - strFree + held;
+    usage.used = sizeof(yyjson_mut_doc) + usage.values * sizeof(yyjson_mut_val) + usage.strings;
+    usage.allocated = sizeof(yyjson_mut_doc) + valBytes + strBytes + held;
+    return usage;
+}
+
+/* @Group 4.4.2: read and write */
+/* ************************************************************************ */
+
+inline bool MutableDocument::read(const char* str, size_t len)
+{
+    free();
+    
+    if (len == 0 && str) len = strlen(str);
+    m_doc = util::mutAdopt(yyjson_read(str, len, 0));
+    return isValid();
+}
+
+inline bool MutableDocument::read(FILE* fp)
+{
+    free();
+    
+    if (yyjson_unlikely(!fp)) return false;
+    m_doc = util::mutAdopt(yyjson_read_fp(fp, 0, nullptr, nullptr));
+    return isValid();
+}
+
+inline bool MutableDocument::read(std::istream& is)
+{
+    free();
+
+    std::string buffer;
+    if (yyjson_unlikely(!util::readStream(is, buffer))) return false;
+    // in-situ, the buffer is kept by mutable document that refers strings
+    size_t len = buffer.size();
+    buffer.append(YYJSON_PADDING_SIZE, '\0');
+    auto* holder = new util::StringHolder(std::move(buffer), nullptr);
+    yyjson_doc* doc = yyjson_read_opts(&holder->buffer[0], len, YYJSON_READ_INSITU, nullptr, nullptr);
+    if (yyjson_likely(doc)) {
+        m_doc = util::holderMutate(holder, doc);
+    } else {
+        holder->unpin();
+    }
+
+    return isValid();
+}
+
+inline bool MutableDocument::readFile(const char* path)
+{
+    if (yyjson_unlikely(!path)) return false;
+    FILE* fp = fopen(path, "rb");
+    if (yyjson_unlikely(!fp)) return false;
+
+    bool result = read(fp);
+    fclose(fp);
+    return result;
+}
+
+inline bool MutableDocument::read(const char* str, size_t len, const Allocator& alc)
+{
+    return read(str, len, ReadOptions(alc));
+}
+
+inline bool MutableDocument::read(FILE* fp, const Allocator& alc)
+{
+    return read(fp, ReadOptions(alc));
+}
+
+inline bool MutableDocument::readFile(const char* path, const Allocator& alc)
+{
+    return readFile(path, ReadOptions(alc));
+}
+
+inline bool MutableDocument::read(const char* str, size_t len, const ReadOptions& opt)
+{
+    free();
+
+    if (len == 0 && str) len = strlen(str);
+    if (yyjson_unlikely(!str)) return false;
+    yyjson_read_flag flg = opt.flag & ~YYJSON_READ_INSITU;
+    m_doc = util::mutAdopt(yyjson_read_opts(const_cast<char*>(str), len, flg, opt.alc.c_alc(), opt.err));
+    return isValid();
+}
+
+inline bool MutableDocument::read(FILE* fp, const ReadOptions& opt)
+{
+    free();
+
+    if (yyjson_unlikely(!fp)) return false;
+    yyjson_read_flag flg = opt.flag & ~YYJSON_READ_INSITU;
+    m_doc = util::mutAdopt(yyjson_read_fp(fp, flg, opt.alc.c_alc(), opt.err));
+    return isValid();
+}
+
+inline bool MutableDocument::readFile(const char* path, const ReadOptions& opt)
+{
+    if (yyjson_unlikely(!path)) return false;
+    FILE* fp = fopen(path, "rb");
+    if (yyjson_unlikely(!fp)) return false;
+
+    bool result = read(fp, opt);
+    fclose(fp);
+    return result;
+}
+
+inline bool MutableDocument::write(std::string& output, yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/) const
+{
+    if (yyjson_unlikely(!m_doc)) return false;
+    util::StringSink sink(output);
+    yyjson_alc alc = sink.c_alc();
+    size_t len = 0;
+    return sink.commit(yyjson_mut_write_opts(m_doc, flg, &alc, &len, nullptr), len);
+}
+
+inline bool MutableDocument::write(WriteBuffer& output, yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/) const
+{
+    if (yyjson_unlikely(!m_doc)) return false;
+    yyjson_alc alc = output.c_alc();
+    size_t len = 0;
+    return output.commit(yyjson_mut_write_opts(m_doc, flg, &alc, &len, nullptr), len);
+}
+
+inline bool MutableDocument::write(FILE* fp) const
+{
+    if (yyjson_unlikely(!m_doc || !fp)) return false;
+    // streamed in chunks, not the whole text at once
+    StreamWriter writer(fp);
+    return writer.write(*this) && writer.flush();
+}
+
+inline bool MutableDocument::write(std::ofstream& ofs) const
+{
+    if (yyjson_unlikely(!m_doc)) return false;
+    ofs.seekp(0, std::ios::beg);
+    StreamWriter writer(ofs);
+    bool result = writer.write(*this) && writer.flush();
+    ofs.flush();
+    return result && !ofs.fail();
+}
+
+inline bool MutableDocument::writeFile(const char* path) const
+{
+    if (yyjson_unlikely(!path)) return false;
+    FILE* fp = fopen(path, "wb");
+    if (yyjson_unlikely(!fp)) return false;
+    
+    bool result = write(fp);
+    fclose(fp);
+    return result;
+}
+
+/* @Group 4.4.3: create mutable value */
+/* ************************************************************************ */
+
+inline MutableValue MutableDocument::create(yyjson_mut_val* value) const
+{ 
+    if (yyjson_likely(value && m_doc))
+    {
+        return MutableValue(value, m_doc); 
+    }
+    return MutableValue(nullptr, m_doc);
+}
+
+inline MutableValue MutableDocument::create() const
+{ 
+    return create(yyjson_mut_null(m_doc)); 
+}
+
+template <typename T>
+inline MutableValue MutableDocument::create(T&& value) const
+{
+    return create(util::create(m_doc, std::forward<T>(value)));
+}
+
+#endif // XYJSON_DISABLE_MUTABLE
+
+/* @Section 4.5: ArrayIterator Methods */
+/* ------------------------------------------------------------------------ */
+
+inline ArrayIterator::ArrayIterator(yyjson_val* root) : m_arr(root)
+{
+    if (yyjson_likely(root)) {
+        yyjson_arr_iter_init(root, &m_iter);
+    }
+}
+
+inline ArrayIterator& ArrayIterator::next()
+{
+    yyjson_arr_iter_next(&m_iter);
+    return *this;
+}
+
+// Backward iteration is O(N) operation: reset to beginning and advance idx-1 steps
+inline ArrayIterator& ArrayIterator::prev()
+{
+    if (yyjson_unlikely(m_iter.idx == 0)) {
+        return end(true);
+    }
+    size_t idx = m_iter.idx - 1;
+    return begin().advance(idx);
+}
+
+inline ArrayIterator& ArrayIterator::begin()
+{
+    if (yyjson_likely(m_arr)) {
+        yyjson_arr_iter_init(m_arr, &m_iter);
+    }
+    return *this;
+}
+
+inline ArrayIterator& ArrayIterator::advance(size_t steps)
 {
-    if (key.isString()) {
-        return create(doc, std::move(key));
+    for (size_t i = 0; i < steps && isValid(); i++) { 
+        next();
     }
-    return nullptr;
+    return *this;
 }
 
-#endif // XYJSON_DISABLE_MUTABLE
 
-/* @Section 3.2: Conversion Helper Functions */
+/* @Section 4.6: ObjectIterator Methods */
 /* ------------------------------------------------------------------------ */
-/**
- * @brief Type conversion and comparison utilities
- * 
- * These functions provide type conversion and comparison operations
- * that work with both Value and MutableValue types, enabling unified
- * handling of JSON values regardless of mutability.
- */
 
-/**
- * @brief Compare two JSON values using hybrid comparison logic
- * 
- * This function provides a comprehensive comparison of JSON values
- * following these rules:
- * 1. Invalid values are considered less than valid values
- * 2. Values of different types are compared by type order
- * 3. Values of the same type are compared by their actual values
- * 4. Containers are compared by size first, then by pointer
- * 
- * @tparam T JSON value type (Value or MutableValue)
- * @param lhs Left-hand side value
- * @param rhs Right-hand side value
- * @return bool True if lhs is less than rhs
- */
-template<typename T>
-inline typename std::enable_if<trait::is_value<T>::value, bool>::type
-lessCompare(const T& lhs, const T& rhs)
+inline ObjectIterator::ObjectIterator(yyjson_val* root)
 {
-    if (yyjson_unlikely(!lhs.isValid())) {
-        return rhs.isValid(); // an invalid value is less than a valid one
-    }
-    if (yyjson_unlikely(!rhs.isValid())) {
-        return false;
+    if (yyjson_likely(root)) {
+        yyjson_obj_iter_init(root, &m_iter);
     }
+}
 
-    auto lhs_type = lhs.getType();
-    auto rhs_type = rhs.getType();
+inline ObjectIterator& ObjectIterator::next()
+{
+    yyjson_obj_iter_next(&m_iter);
+    return *this;
+}
 
-    if (lhs_type != rhs_type) {
-        return lhs_type < rhs_type;
+// Backward iteration is O(N) operation: reset to beginning and advance idx-1 steps
+inline ObjectIterator& ObjectIterator::prev()
+{
+    if (yyjson_unlikely(m_iter.idx == 0)) {
+        return end(true);
     }
+    size_t idx = m_iter.idx - 1;
+    return begin().advance(idx);
+}
 
-    switch (lhs_type) {
-        case YYJSON_TYPE_NULL:
-            return false; // nulls are equal
-
-        case YYJSON_TYPE_BOOL:
-            return (lhs.getor(false)) < (rhs.getor(false));
-
-        case YYJSON_TYPE_NUM: {
-            return lhs.toNumber() < rhs.toNumber();
-        }
-        case YYJSON_TYPE_STR: {
-            const char* lhs_str = lhs | kString;
-            const char* rhs_str = rhs | kString;
-            return ::strcmp(lhs_str, rhs_str) < 0;
-        }
-        case YYJSON_TYPE_ARR:
-        case YYJSON_TYPE_OBJ: {
-            size_t lhs_size = lhs.size();
-            size_t rhs_size = rhs.size();
-            if (lhs_size != rhs_size) {
-                return lhs_size < rhs_size;
-            }
-            // Fallback to pointer comparison for containers of the same size.
-            return lhs.get() < rhs.get();
-        }
-        default: // RAW, or any other type
-            return lhs.get() < rhs.get();
+inline ObjectIterator& ObjectIterator::begin()
+{
+    if (yyjson_likely(m_iter.obj)) {
+        yyjson_obj_iter_init(m_iter.obj, &m_iter);
     }
+    return *this;
 }
 
-/**
- * @brief Convert JSON values to integers with type-specific logic
- * 
- * This function converts JSON values to integers using appropriate
- * conversion rules for each JSON type:
- * - Strings: parsed using atoi()
- * - Numbers: direct conversion
- * - Booleans: true=1, false=0
- * - Containers: returns size
- * - Invalid/null: returns 0
- * 
- * @tparam jsonT JSON value type
- * @param val JSON value to convert
- * @return int Converted integer value
- */
-template<typename jsonT>
-inline typename std::enable_if<trait::is_value<jsonT>::value, int>::type
-toIntegerCast(const jsonT& val)
+inline ObjectIterator& ObjectIterator::advance(size_t steps)
 {
-    if (yyjson_unlikely(!val.isValid())) return 0;
-    
-    if (val.isString()) {
-        const char* str = val | "";
-        return ::atoi(str);
-    }
-    
-    if (val.isInt()) {
-        return val.getor(0);
-    }
-    if (val.isBool()) {
-        return val.getor(false);
-    }
-    if (val.isReal()) {
-        return static_cast<int>(val.getor(0.0));
+    for (size_t i = 0; i < steps && isValid(); i++) { 
+        next();
     }
-    
-    return 0;
+    return *this;
 }
 
-/**
- * @brief Apply function to JSON value with intelligent parameter mapping
- * 
- * This function provides the implementation for pipe() operations,
- * automatically mapping JSON values to appropriate function parameters:
- * 1. Prefer direct JSON value parameter
- * 2. Map to supported scalar types based on function signature
- * 3. Fallback to getor() with function as default value
- * 
- * @tparam jsonT JSON value type
- * @tparam funcT Function or callable type
- * @param json JSON value to process
- * @param func Function to apply
- * @return auto Result of function application
- * 
- * @throws static_assert if function signature is unsupported
- */
-template<typename jsonT, typename funcT>
-inline auto pipeApply(const jsonT& json, funcT&& func)
+inline ObjectIterator& ObjectIterator::advance(const char* key)
 {
-    if constexpr (std::is_invocable_v<funcT, const jsonT&>) {
-        return std::forward<funcT>(func)(json);
-    } else if constexpr (std::is_invocable_v<funcT, const char*>) {
-        return std::forward<funcT>(func)(json.getor(kString));
-    } else if constexpr (std::is_invocable_v<funcT, std::string>) {
-        return std::forward<funcT>(func)(json.getor(std::string{}));
-    } else if constexpr (std::is_invocable_v<funcT, double>) {
-        return std::forward<funcT>(func)(json.getor(kNumber));
-    } else if constexpr (std::is_invocable_v<funcT, int>) {
-        return std::forward<funcT>(func)(json.getor(0));
-    } else if constexpr (std::is_invocable_v<funcT, int64_t>) {
-        return std::forward<funcT>(func)(json.getor(int64_t{}));
-    } else if constexpr (std::is_invocable_v<funcT, uint64_t>) {
-        return std::forward<funcT>(func)(json.getor(uint64_t{}));
-    } else if constexpr (std::is_invocable_v<funcT, bool>) {
-        return std::forward<funcT>(func)(json.getor(false));
-    } else if constexpr (trait::enable_getor<funcT>::value) {
-        // Fallback: treat func as default value for getor
-        return json.getor(std::forward<funcT>(func));
-    } else {
-        static_assert(!std::is_same_v<funcT, funcT>, "Unsupported pipe() callable parameter type");
+    if (yyjson_unlikely(!key || !*key)) return *this;
+    
+    while (isValid()) {
+        const char* currentKey = name();
+        if (currentKey && ::strcmp(currentKey, key) == 0) {
+            break;
+        }
+        next();
     }
+    return *this;
 }
 
-} /* end of namespace yyjson::util */
-
-/* @Part 4: Class Implementations */
-/* ======================================================================== */
-
-/* @Section 4.1: Value Methods */
-/* ------------------------------------------------------------------------ */
-
-/* @Group 4.1.1: get and getor */
-/* ************************************************************************ */
-
-inline bool Value::get(bool& result) const
+// ObjectIterator fast seek implementation using yyjson_obj_iter_getn
+inline Value ObjectIterator::seek(const char* key, size_t key_len)
 {
-    if (yyjson_likely(isBool())) {
-        result = unsafe_yyjson_get_bool(m_val);
-        return true;
-    }
-    return false;
+    yyjson_val* val = yyjson_obj_iter_getn(&m_iter, key, key_len);
+    return Value(val);
 }
 
-inline bool Value::get(int& result) const
+#ifndef XYJSON_DISABLE_MUTABLE
+/* @Section 4.7: MutableArrayIterator Methods */
+/* ------------------------------------------------------------------------ */
+
+inline MutableArrayIterator::MutableArrayIterator(yyjson_mut_val* root, yyjson_mut_doc* doc) : m_doc(doc)
 {
-    if (yyjson_likely(isInt())) {
-        result = unsafe_yyjson_get_int(m_val);
-        return true;
+    if (yyjson_likely(root)) {
+        yyjson_mut_arr_iter_init(root, &m_iter);
+        if (yyjson_likely(m_iter.idx < m_iter.max)) {
+            m_iter.pre = (yyjson_mut_val*)m_iter.arr->uni.ptr;  // prev = tail element
+            m_iter.cur = m_iter.pre->next;                      // cur = first element
+        }
     }
-    return false;
 }
 
-inline bool Value::get(int64_t& result) const
+inline MutableArrayIterator& MutableArrayIterator::next()
 {
-    if (isSint()) {
-        result = unsafe_yyjson_get_sint(m_val);
-        return true;
+    if (yyjson_likely(m_iter.idx < m_iter.max)) {
+        m_iter.pre = m_iter.cur;          // current element becomes previous
+        m_iter.cur = m_iter.cur->next;    // advance to next element
+        m_iter.idx++;                     // increment index
     }
-    return false;
+    return *this;
 }
 
-inline bool Value::get(uint64_t& result) const
+// Backward iteration is O(N) operation: reset to beginning and advance idx-1 steps
+// If at beginning, move to fast end (circular linked list)
+inline MutableArrayIterator& MutableArrayIterator::prev()
 {
-    if (isUint()) {
-        result = unsafe_yyjson_get_uint(m_val);
-        return true;
+    if (yyjson_unlikely(m_iter.idx == 0)) {
+        return end();
     }
-    return false;
+    size_t idx = m_iter.idx - 1;
+    return begin().advance(idx);
 }
 
-inline bool Value::get(double& result) const
+inline MutableArrayIterator& MutableArrayIterator::begin()
 {
-    if (yyjson_likely(isReal())) {
-        result = unsafe_yyjson_get_real(m_val);
-        return true;
+    if (yyjson_likely(m_iter.arr)) {
+        yyjson_mut_arr_iter_init(m_iter.arr, &m_iter);
+        if (yyjson_likely(m_iter.idx < m_iter.max)) {
+            m_iter.pre = (yyjson_mut_val*)m_iter.arr->uni.ptr;  // prev = tail element
+            m_iter.cur = m_iter.pre->next;                      // cur = first element
+        }
     }
-    return false;
+    return *this;
 }
 
-inline bool Value::get(const char*& result) const
+inline MutableArrayIterator& MutableArrayIterator::advance(size_t steps)
 {
-    if (yyjson_likely(isString())) {
-        result = unsafe_yyjson_get_str(m_val);
-        return true;
+    for (size_t i = 0; i < steps && isValid(); i++) { 
+        next();
     }
-    return false;
+    return *this;
 }
 
-inline bool Value::get(std::string& result) const
+inline bool MutableArrayIterator::insert(yyjson_mut_val* val)
 {
-    if (yyjson_likely(isString())) {
-        result = unsafe_yyjson_get_str(m_val);
-        return true;
+    // allow idx == max to insert at the end
+    if (yyjson_unlikely(!val || !m_iter.arr || m_iter.idx > m_iter.max)) {
+        return false;
     }
-    return false;
-}
 
-inline bool Value::get(yyjson_val*& result) const
-{
-    if (yyjson_likely(isValid())) { result = m_val; return true; }
-    return false;
+    if (m_iter.max == 0) {
+        // first element, form self-loop
+        val->next = val;
+        m_iter.pre = val;
+        m_iter.cur = val;
+        m_iter.arr->uni.ptr = val;
+    }
+    else {
+        // insert before current element (iterator points to new element)
+        yyjson_mut_val *prev = m_iter.pre;
+        yyjson_mut_val *next = m_iter.cur;
+        prev->next = val;
+        val->next = next;
+        m_iter.cur = val;
+
+        // if inserting at the end, update arr->uni.ptr
+        if (m_iter.idx == m_iter.max) {
+            m_iter.arr->uni.ptr = val;
+        }
+    }
+    unsafe_yyjson_set_len(m_iter.arr, ++m_iter.max);
+    return true;
 }
 
 template<typename T>
-inline std::decay_t<T> Value::getor(T&& defaultValue) const
+inline bool MutableArrayIterator::insert(T&& value)
 {
-    using R = std::decay_t<T>;
-    R result{};
-    return get(result) ? result : static_cast<R>(defaultValue);
+    // Create value from template type and forward to native insert
+    yyjson_mut_val* val = util::create(m_doc, std::forward<T>(value));
+    return insert(val);
 }
 
-inline const char* Value::getor(EmptyString) const
+/// Remove current element and return it
+inline MutableValue MutableArrayIterator::remove()
 {
-    return yyjson_likely(isString()) ? unsafe_yyjson_get_str(m_val) : "";
-}
+    yyjson_mut_val* removed_val = nullptr;
+    if (yyjson_likely(isValid() && m_iter.cur)) {
+        removed_val = m_iter.cur;
 
-inline double Value::getor(ZeroNumber) const
-{
-    return toNumber();
+        if (m_iter.max == 1) {
+            // remove the last element
+            m_iter.cur = nullptr;
+            m_iter.pre = nullptr;
+            m_iter.arr->uni.ptr = nullptr;
+        }
+        else {
+            // remove current element, let cur point to next element
+            m_iter.pre->next = m_iter.cur->next;
+            m_iter.cur = m_iter.pre->next;
+        }
+
+        m_iter.max--;
+        unsafe_yyjson_set_len(m_iter.arr, m_iter.max);
+    }
+    return MutableValue(removed_val, m_doc);
 }
 
-inline ConstArray Value::getor(EmptyArray) const
+
+/* @Section 4.8: MutableObjectIterator Methods */
+/* ------------------------------------------------------------------------ */
+
+inline MutableObjectIterator::MutableObjectIterator(yyjson_mut_val* root, yyjson_mut_doc* doc) : m_doc(doc)
 {
-    return array();
+    if (yyjson_likely(root)) {
+        yyjson_mut_obj_iter_init(root, &m_iter);
+        if (yyjson_likely(m_iter.idx < m_iter.max)) {
+            m_iter.pre = (yyjson_mut_val*)m_iter.obj->uni.ptr;  // prev = tail key
+            m_iter.cur = m_iter.pre->next->next;                // cur = first key
+        }
+    }
 }
 
-inline ConstObject Value::getor(EmptyObject) const
+inline MutableObjectIterator& MutableObjectIterator::next()
 {
-    return object();
+    // directly operate on pointers, advance by two steps (key->val->next key)
+    if (yyjson_likely(m_iter.idx < m_iter.max)) {
+        m_iter.pre = m_iter.cur;                   // current key becomes previous
+        m_iter.cur = m_iter.cur->next->next;       // advance to next key (skip value)
+        m_iter.idx++;                              // increment index
+    }
+    return *this;
 }
 
-template<typename funcT>
-inline auto Value::pipe(funcT&& func) const
+// Backward iteration is O(N) operation: reset to beginning and advance idx-1 steps
+// If at beginning, move to fast end (circular linked list)
+inline MutableObjectIterator& MutableObjectIterator::prev()
 {
-    return util::pipeApply(*this, std::forward<funcT>(func));
+    if (yyjson_unlikely(m_iter.idx == 0)) {
+        return end();
+    }
+    size_t idx = m_iter.idx - 1;
+    return begin().advance(idx);
 }
 
-/* @Group 4.1.2: size and index/path */
-/* ************************************************************************ */
-
-inline size_t Value::size() const
+inline MutableObjectIterator& MutableObjectIterator::begin()
 {
-    if (yyjson_unlikely(!m_val)) return 0;
-    if (yyjson_is_arr(m_val)) return yyjson_arr_size(m_val);
-    if (yyjson_is_obj(m_val)) return yyjson_obj_size(m_val);
-    return 0;
+    if (yyjson_likely(m_iter.obj)) {
+        yyjson_mut_obj_iter_init(m_iter.obj, &m_iter);
+        if (yyjson_likely(m_iter.idx < m_iter.max)) {
+            m_iter.pre = (yyjson_mut_val*)m_iter.obj->uni.ptr;  // prev = tail key
+            m_iter.cur = m_iter.pre->next->next;                // cur = first key
+        }
+    }
+    return *this;
 }
 
-inline Value Value::index(size_t idx) const
+inline MutableObjectIterator& MutableObjectIterator::advance(size_t steps)
 {
-    if (yyjson_unlikely(!isArray())) return Value(nullptr);
-    return Value(yyjson_arr_get(m_val, idx));
+    for (size_t i = 0; i < steps && isValid(); i++) { 
+        next();
+    }
+    return *this;
 }
 
-inline Value Value::index(const char* key, size_t len) const
+inline MutableObjectIterator& MutableObjectIterator::advance(const char* key)
 {
-    if (yyjson_unlikely(!isObject() || !key)) return Value(nullptr);
-    return Value(yyjson_obj_getn(m_val, key, len));
+    if (yyjson_unlikely(!key || !*key)) return *this;
+    
+    while (isValid()) {
+        const char* currentKey = name();
+        if (currentKey && ::strcmp(currentKey, key) == 0) {
+            break;
+        }
+        next();
+    }
+    return *this;
 }
 
-inline Value Value::pathto(const char* path, size_t len) const
+// MutableObjectIterator fast seek implementation using yyjson_mut_obj_iter_getn
+inline MutableValue MutableObjectIterator::seek(const char* key, size_t key_len)
 {
-    if (yyjson_unlikely(!path || len == 0)) return *this;
-    if (path[0] == '/') {
-        yyjson_val* result = yyjson_ptr_getn(m_val, path, len);
-        return Value(result);
+    // adapt from yyjson_mut_obj_iter_getn to our iterator semantics
+    if (yyjson_unlikely(!key || key_len == 0 || m_iter.max == 0)) {
+        return MutableValue();
     }
-    return index(path, len);
-}
 
-/* @Group 4.1.3: create iterator */
-/* ************************************************************************ */
+    yyjson_mut_val* cur = m_iter.cur;
+    yyjson_mut_val* pre = m_iter.pre;
 
-inline ArrayIterator Value::iterator(size_t startIndex) const
-{
-    if (yyjson_likely(isArray())) {
-        ArrayIterator iter(m_val);
-        if (yyjson_likely(startIndex == 0)) return iter;
-        return iter.advance(startIndex);
+    for (size_t i = 0; i < m_iter.max; ++i) {
+        if (unsafe_yyjson_equals_strn(cur, key, key_len)) {
+            m_iter.pre = cur;
+            m_iter.cur = cur->next->next;
+            m_iter.idx += i + 1;
+            if (yyjson_unlikely(m_iter.idx > m_iter.max)) {
+                m_iter.idx -= m_iter.max;  // wrap around
+            }
+            return MutableValue(cur->next, m_doc);
+        }
+        pre = cur;
+        cur = cur->next->next;
     }
-    return ArrayIterator();
-}
 
-inline ArrayIterator Value::iterator(int startIndex) const
-{
-    return iterator(static_cast<size_t>(startIndex));
+    return MutableValue();  // not found
 }
 
-inline ObjectIterator Value::iterator(const char* startKey) const
+// MutableObjectIterator insert implementation
+inline bool MutableObjectIterator::insert(yyjson_mut_val* key, yyjson_mut_val* val)
 {
-    if (yyjson_likely(isObject())) {
-        ObjectIterator iter(m_val);
-        if (yyjson_likely(startKey == nullptr || *startKey == '\0')) return iter;
-        return iter.advance(startKey);
+    if (yyjson_unlikely(!key || !val || !m_iter.obj)) {
+        return false;
     }
-    return ObjectIterator();
-}
 
-inline ArrayIterator Value::iterator(EmptyArray) const
-{
-    return yyjson_likely(isArray()) ? iterator(size_t(0)) : ArrayIterator();
-}
+    // Insert new key-value pair at current iterator position
+    // The structure is: ... -> pre_key -> pre_val -> (key -> val) -> cur_key -> cur_val -> ...
 
-inline ObjectIterator Value::iterator(EmptyObject) const
-{
-    return yyjson_likely(isObject()) ? iterator(nullptr) : ObjectIterator();
+    if (m_iter.max == 0) { // insert the first kv
+        key->next = val;
+        val->next = key;  // Close the circle: key -> val -> key
+        m_iter.cur = key;
+        m_iter.obj->uni.ptr = key;  // Update object tail pointer (last key)
+    }
+    else {
+        yyjson_mut_val* prev_key = m_iter.pre;
+        yyjson_mut_val* prev_val = prev_key->next;
+        prev_val->next = key;
+        key->next = val;
+        val->next = m_iter.cur;
+        m_iter.cur = key;
+
+        if (m_iter.idx == m_iter.max) { // insert at the end
+            m_iter.obj->uni.ptr = key;  // keep obj point to end key
+        }
+    }
+
+    m_iter.max++;
+    unsafe_yyjson_set_len(m_iter.obj, m_iter.max);
+    return true;
 }
 
-inline ArrayIterator Value::beginArray() const
+template<typename K, typename V>
+inline bool MutableObjectIterator::insert(K&& key, V&& value)
 {
-    return iterator(size_t(0));
+    // Create key and value from template types
+    yyjson_mut_val* key_val = util::createKey(m_doc, std::forward<K>(key));
+    yyjson_mut_val* value_val = util::create(m_doc, std::forward<V>(value));
+    return insert(key_val, value_val);
 }
 
-inline ArrayIterator Value::endArray() const
+inline bool MutableObjectIterator::insert(KeyValue&& kv_pair)
 {
-    return beginArray().end();
+    bool result = insert(kv_pair.key, kv_pair.value);
+    if (yyjson_likely(result)) {
+        kv_pair.key = nullptr;
+        kv_pair.value = nullptr;
+    }
+    return result;
 }
 
-inline ObjectIterator Value::beginObject() const
+#ifndef XYJSON_DISABLE_CHAINED_INPUT
+// Chained insertion support: insertKey
+template<typename keyT>
+inline bool MutableObjectIterator::insertKey(keyT&& key)
 {
-    return iterator((const char*)nullptr);
+    m_pendingKey = util::createKey(m_doc, std::forward<keyT>(key));
+    return false;
 }
 
-inline ObjectIterator Value::endObject() const
+// Chained insertion support: insertValue
+template<typename valT>
+inline bool MutableObjectIterator::insertValue(valT&& value)
 {
-    return beginObject().end();
+    if (m_pendingKey == nullptr) {
+        return false;
+    }
+    yyjson_mut_val* valueNode = util::create(m_doc, std::forward<valT>(value));
+    if (yyjson_unlikely(!valueNode)) {
+        return false;
+    }
+    bool result = insert(m_pendingKey, valueNode);
+    m_pendingKey = nullptr;
+    return result;
 }
 
-inline ConstArray Value::array() const 
+// Insert method for chained insertion - handles key/value logic internally
+// Returns true if a value was inserted (meaning we should advance)
+// Returns false if a key was stored (meaning we should wait for value) or both failed
+template<typename T>
+inline bool MutableObjectIterator::insert(T&& arg)
 {
-    return ConstArray(*this);
+    return insertValue(std::forward<T>(arg)) || insertKey(std::forward<T>(arg));
 }
+#endif
 
-inline ConstObject Value::object() const 
+// MutableObjectIterator remove implementation
+inline KeyValue MutableObjectIterator::remove()
 {
-    return ConstObject(*this);
-}
+    yyjson_mut_val* removed_key = nullptr;
+    yyjson_mut_val* removed_val = nullptr;
 
-/* @Group 4.1.4: others */
-/* ************************************************************************ */
+    if (yyjson_likely(isValid() && m_iter.cur)) {
+        removed_key = m_iter.cur;
+        removed_val = m_iter.cur->next;
 
-inline std::string Value::toString(bool pretty) const
-{
-    if (yyjson_unlikely(!isValid())) return "";
+        if (m_iter.max == 1) {
+            // remove the last key-value pair
+            m_iter.cur = nullptr;
+            m_iter.pre = nullptr;
+            m_iter.obj->uni.ptr = nullptr;
+        }
+        else {
+            // remove current key-value pair from circular linked list
+            // Kprev -> Vprev -> Kcur -> Vcur -> Knext -> Vnext -> ...
+            // becomes: Kprev -> Vprev -> Knext -> Vnext -> ...
+            yyjson_mut_val *key_prev = m_iter.pre;
+            yyjson_mut_val *val_prev = key_prev->next;
+            yyjson_mut_val *key_next = m_iter.cur->next->next;
+            val_prev->next = key_next;
 
-    if (isString() && !pretty) {
-        return std::string(yyjson_get_str(m_val));
-    }
-    
-    uint32_t flags = YYJSON_WRITE_NOFLAG;
-    if (pretty) {
-        flags |= YYJSON_WRITE_PRETTY;
-    }
-    
-    size_t len = 0;
-    char* json_str = yyjson_val_write(m_val, flags, &len);
-    if (yyjson_unlikely(!json_str)) return "";
-    
-    std::string result(json_str, len);
-    free(json_str);
-    return result;
-}
+            // move iterator to next key
+            m_iter.cur = key_next;
+        }
 
-inline int Value::toInteger() const
-{
-    if (yyjson_unlikely(!isValid())) return 0;
-    if (isArray() || isObject())
-    {
-        return static_cast<int>(size());
+        m_iter.max--;
+        unsafe_yyjson_set_len(m_iter.obj, m_iter.max);
     }
-    return util::toIntegerCast(*this);
+    return KeyValue(removed_key, removed_val);
 }
 
-inline double Value::toNumber() const
+#endif // XYJSON_DISABLE_MUTABLE
+
+/* @Section 4.9: Allocator Methods */
+/* ------------------------------------------------------------------------ */
+
+inline Allocator::Allocator(const yyjson_alc* alc)
+    : m_alc{nullptr, nullptr, nullptr, nullptr}
 {
-    return yyjson_get_num(m_val);
+    if (alc) { m_alc = *alc; }
 }
 
-inline bool Value::equal(const Value& other) const
+inline Allocator Allocator::pool(void* buf, size_t size)
 {
-    return (m_val == other.m_val) || yyjson_equals(m_val, other.m_val);
+    yyjson_alc alc;
+    if (yyjson_unlikely(!yyjson_alc_pool_init(&alc, buf, size))) {
+        // fail rather than fall back to heap
+        alc.malloc = [](void*, size_t) -> void* { return nullptr; };
+        alc.realloc = [](void*, void*, size_t, size_t) -> void* { return nullptr; };
+        alc.free = [](void*, void*) {};
+        alc.ctx = nullptr;
+    }
+    return Allocator(&alc);
 }
 
-inline bool Value::less(const Value& other) const
+#ifdef XYJSON_HAS_PMR
+inline Allocator::Allocator(std::pmr::memory_resource* resource)
+    : m_alc{nullptr, nullptr, nullptr, nullptr}
 {
-    return util::lessCompare(*this, other);
+    if (resource) {
+        m_alc.malloc = &util::PmrAllocator::malloc;
+        m_alc.realloc = &util::PmrAllocator::realloc;
+        m_alc.free = &util::PmrAllocator::free;
+        m_alc.ctx = resource;
+    }
 }
+#endif
 
-/* @Section 4.2: Document Methods */
-/* ------------------------------------------------------------------------ */
+inline bool ParseSession::reserve(size_t capacity)
+{
+    if (capacity <= m_size) return true;
+    if (yyjson_unlikely(m_live > 0)) return false;
 
-/* @Group 4.2.1: primary manage */
-/* ************************************************************************ */
+    size_t size = m_size * 2;
+    if (size < capacity) size = capacity;
+    size = alignSize(size);
+    char* buf = static_cast<char*>(::malloc(size));
+    if (yyjson_unlikely(!buf)) return false;
 
-inline Document::Document(yyjson_doc* doc) : m_doc(doc)
-{
+    ::free(m_buf);
+    m_buf = buf;
+    m_size = size;
+    m_used = 0;
+    return true;
 }
 
-inline Document::Document(const char* str, size_t len/* = 0*/)
+inline Document ParseSession::parse(const char* str, size_t len/* = 0*/)
 {
     if (len == 0 && str) len = strlen(str);
-    m_doc = yyjson_read(str, len, 0);
+    return parse(str, len, YYJSON_READ_NOFLAG);
 }
 
-#ifndef XYJSON_DISABLE_MUTABLE
-inline Document::Document(const MutableDocument& other)
+inline Document ParseSession::parse(const char* str, size_t len, yyjson_read_flag flg, yyjson_read_err* err/* = nullptr*/)
 {
-    *this = other.freeze();
+    if (yyjson_unlikely(!str)) return Document();
+
+    // worst case memory of the doc, may fail while old documents alive
+    flg &= ~YYJSON_READ_INSITU;
+    reserve(m_used + yyjson_read_max_memory_usage(len, flg));
+    yyjson_doc* doc = yyjson_read_opts(const_cast<char*>(str), len, flg, &m_alc, err);
+    return Document(doc);
 }
-#endif
 
-inline void Document::free()
+inline void* ParseSession::malloc(void* ctx, size_t size)
 {
-    if (yyjson_likely(m_doc))
-    {
-        yyjson_doc_free(m_doc);
-        m_doc = nullptr;
+    auto* self = static_cast<ParseSession*>(ctx);
+    size_t aligned = alignSize(size);
+    if (yyjson_likely(aligned <= self->m_size - self->m_used)) {
+        void* ptr = self->m_buf + self->m_used;
+        self->m_used += aligned;
+        self->m_live++;
+        return ptr;
     }
+    return ::malloc(size);
 }
 
-#ifndef XYJSON_DISABLE_MUTABLE
-// Convert read-only document to mutable document
-inline MutableDocument Document::mutate() const
+inline void* ParseSession::realloc(void* ctx, void* ptr, size_t old_size, size_t size)
 {
-    if (yyjson_unlikely(!isValid())) {
-        return MutableDocument((yyjson_mut_doc*)nullptr);
+    auto* self = static_cast<ParseSession*>(ctx);
+    if (!self->owns(ptr)) {
+        return ::realloc(ptr, size);
     }
 
-    yyjson_mut_doc* mut_doc = yyjson_doc_mut_copy(m_doc, nullptr);
-    return MutableDocument(mut_doc);
-}
-#endif
-
-/* @Group 4.2.2: read and write */
-/* ************************************************************************ */
+    // extend or shrink the last block in place
+    char* end = static_cast<char*>(ptr) + alignSize(old_size);
+    if (end == self->m_buf + self->m_used) {
+        size_t offset = static_cast<char*>(ptr) - self->m_buf;
+        size_t aligned = alignSize(size);
+        if (aligned <= self->m_size - offset) {
+            self->m_used = offset + aligned;
+            return ptr;
+        }
+    }
 
-inline bool Document::read(const char* str, size_t len)
-{
-    free();
-    
-    if (len == 0 && str) len = strlen(str);
-    m_doc = yyjson_read(str, len, 0);
-    return isValid();
+    void* block = malloc(ctx, size);
+    if (yyjson_likely(block)) {
+        ::memcpy(block, ptr, old_size < size ? old_size : size);
+        free(ctx, ptr);
+    }
+    return block;
 }
 
-inline bool Document::read(FILE* fp)
+inline void ParseSession::free(void* ctx, void* ptr)
 {
-    free();
-    
-    if (yyjson_unlikely(!fp)) return false;
-    m_doc = yyjson_read_fp(fp, 0, nullptr, nullptr);
-    return isValid();
+    auto* self = static_cast<ParseSession*>(ctx);
+    if (!self->owns(ptr)) {
+        ::free(ptr);
+        return;
+    }
+
+    // recycle the whole buffer when the last block released
+    if (--self->m_live == 0) {
+        self->m_used = 0;
+    }
 }
 
-inline bool Document::read(std::ifstream& ifs)
+inline size_t DocumentBatch::validCount() const
 {
-    // Check if stream is in a valid state before any operations
-    if (yyjson_unlikely(!ifs.good())) return false;
-    
-    ifs.seekg(0, std::ios::end);
-    std::streampos pos = ifs.tellg();
-    
-    // Check if tellg() failed (returns -1 for invalid files)
-    if (pos == -1) return false;
-    
-    size_t size = static_cast<size_t>(pos);
-    ifs.seekg(0, std::ios::beg);
-    
-    if (size == 0) return false;
-    
-    std::string content(size, '\0');
-    ifs.read(&content[0], size);
-    
-    return read(content);
+    size_t count = 0;
+    for (auto& doc : m_docs) {
+        if (doc.isValid()) count++;
+    }
+    return count;
 }
 
-inline bool Document::readFile(const char* path)
+template <typename Range>
+inline size_t DocumentBatch::parse(const Range& strs, const ReadOptions& opt/* = ReadOptions()*/)
 {
-    if (yyjson_unlikely(!path)) return false;
-    FILE* fp = fopen(path, "rb");
-    if (yyjson_unlikely(!fp)) return false;
+    m_docs.clear();
+    if (!m_session) m_session.reset(new ParseSession);
 
-    bool result = read(fp);
-    fclose(fp);
-    return result;
-}
+    // worst case of all documents, with alignment of two blocks each
+    yyjson_read_flag flg = opt.flag & ~YYJSON_READ_INSITU;
+    size_t total = 0;
+    size_t count = 0;
+    for (const auto& str : strs) {
+        std::string_view view(str);
+        total += yyjson_read_max_memory_usage(view.size(), flg) + 2 * alignof(std::max_align_t);
+        count++;
+    }
+    m_session->reserve(total);
+    m_docs.reserve(count);
 
-inline bool Document::write(std::string& output) const
-{
-    if (yyjson_unlikely(!m_doc)) return false;
-    char* json = yyjson_write(m_doc, 0, nullptr);
-    if (yyjson_unlikely(!json)) return false;
-    output = json;
-    std::free(json);
-    return true;
+    // keep the error of the first invalid input
+    size_t valid = 0;
+    yyjson_read_err* err = opt.err;
+    for (const auto& str : strs) {
+        std::string_view view(str);
+        m_docs.push_back(m_session->parse(view.data(), view.size(), flg, err));
+        if (m_docs.back().isValid()) valid++;
+        else err = nullptr;
+    }
+    return valid;
 }
 
-inline bool Document::write(FILE* fp) const
+template <typename Range>
+inline DocumentBatch parseMany(const Range& strs, const ReadOptions& opt/* = ReadOptions()*/)
 {
-    if (yyjson_unlikely(!m_doc || !fp)) return false;
-    return yyjson_write_fp(fp, m_doc, 0, nullptr, nullptr);
+    DocumentBatch batch;
+    batch.parse(strs, opt);
+    return batch;
 }
 
-inline bool Document::write(std::ofstream& ofs) const
+inline MemoryTracker::MemoryTracker(const Allocator& inner/* = Allocator()*/)
+    : m_inner{&util::DocHolder::libcMalloc, &util::DocHolder::libcRealloc, &util::DocHolder::libcFree, nullptr}
 {
-    std::string content;
-    if (yyjson_unlikely(!write(content))) return false;
-    
-    ofs.seekp(0, std::ios::beg);
-    ofs.write(content.c_str(), content.size());
-    ofs.flush();
-    
-    return !ofs.fail();
+    if (!inner.isDefault()) { m_inner = *inner.c_alc(); }
 }
 
-inline bool Document::writeFile(const char* path) const
+inline void* MemoryTracker::malloc(void* ctx, size_t size)
 {
-    if (yyjson_unlikely(!path)) return false;
-    FILE* fp = fopen(path, "wb");
-    if (yyjson_unlikely(!fp)) return false;
-
-    bool result = write(fp);
-    fclose(fp);
-    return result;
+    auto* self = static_cast<MemoryTracker*>(ctx);
+    void* block = self->m_inner.malloc(self->m_inner.ctx, size + kHeader);
+    if (yyjson_unlikely(!block)) return nullptr;
+    *static_cast<size_t*>(block) = size;
+    self->m_current += size;
+    self->m_blocks++;
+    if (self->m_current > self->m_peak) self->m_peak = self->m_current;
+    return static_cast<char*>(block) + kHeader;
 }
 
-#ifndef XYJSON_DISABLE_MUTABLE
-/* @Section 4.3: MutableValue Methods */
-/* ------------------------------------------------------------------------ */
-
-/* @Group 4.3.1: get and getor */
-/* ************************************************************************ */
-
-inline bool MutableValue::get(bool& result) const
+inline void* MemoryTracker::realloc(void* ctx, void* ptr, size_t old_size, size_t size)
 {
-    if (yyjson_likely(isBool())) {
-        result = unsafe_yyjson_get_bool((yyjson_val*)m_val); // yyjson_mut_get_bool
-        return true;
-    }
-    return false;
+    if (yyjson_unlikely(!ptr)) return malloc(ctx, size);
+    auto* self = static_cast<MemoryTracker*>(ctx);
+    char* block = static_cast<char*>(ptr) - kHeader;
+    size_t recorded = *reinterpret_cast<size_t*>(block);
+    block = static_cast<char*>(self->m_inner.realloc(self->m_inner.ctx, block,
+        old_size + kHeader, size + kHeader));
+    if (yyjson_unlikely(!block)) return nullptr;
+    *reinterpret_cast<size_t*>(block) = size;
+    self->m_current = self->m_current - recorded + size;
+    if (self->m_current > self->m_peak) self->m_peak = self->m_current;
+    return block + kHeader;
 }
 
-inline bool MutableValue::get(int& result) const
+inline void MemoryTracker::free(void* ctx, void* ptr)
 {
-    if (yyjson_likely(isInt())) {
-        result = unsafe_yyjson_get_int((yyjson_val*)m_val); // yyjson_mut_get_int
-        return true;
-    }
-    return false;
+    if (yyjson_unlikely(!ptr)) return;
+    auto* self = static_cast<MemoryTracker*>(ctx);
+    char* block = static_cast<char*>(ptr) - kHeader;
+    self->m_current -= *reinterpret_cast<size_t*>(block);
+    self->m_blocks--;
+    self->m_inner.free(self->m_inner.ctx, block);
 }
 
-inline bool MutableValue::get(int64_t& result) const
+inline WriteBuffer::WriteBuffer(const Allocator& alc/* = Allocator()*/)
+    : m_inner{&util::DocHolder::libcMalloc, &util::DocHolder::libcRealloc, &util::DocHolder::libcFree, nullptr}
 {
-    if (isSint()) {
-        result = unsafe_yyjson_get_sint((yyjson_val*)m_val); // yyjson_mut_get_sint
-        return true;
-    }
-    return false;
+    if (!alc.isDefault()) { m_inner = *alc.c_alc(); }
 }
 
-inline bool MutableValue::get(uint64_t& result) const
+inline WriteBuffer::~WriteBuffer()
 {
-    if (isUint()) {
-        result = unsafe_yyjson_get_uint((yyjson_val*)m_val); // yyjson_mut_get_uint
-        return true;
-    }
-    return false;
+    if (m_data) m_inner.free(m_inner.ctx, m_data);
 }
 
-inline bool MutableValue::get(double& result) const
+inline bool WriteBuffer::reserve(size_t capacity)
 {
-    if (yyjson_likely(isReal())) {
-        result = unsafe_yyjson_get_real((yyjson_val*)m_val); // yyjson_mut_get_real
-        return true;
-    }
-    return false;
-}
+    if (capacity <= m_capacity) return true;
+    if (yyjson_unlikely(m_busy)) return false;
 
-inline bool MutableValue::get(const char*& result) const
-{
-    if (yyjson_likely(isString())) {
-        result = unsafe_yyjson_get_str((yyjson_val*)m_val); // yyjson_mut_get_str
-        return true;
-    }
-    return false;
+    // content is kept, as realloc of writer relies on it
+    char* data = static_cast<char*>(m_data
+        ? m_inner.realloc(m_inner.ctx, m_data, m_capacity, capacity)
+        : m_inner.malloc(m_inner.ctx, capacity));
+    if (yyjson_unlikely(!data)) return false;
+    m_data = data;
+    m_capacity = capacity;
+    return true;
 }
 
-inline bool MutableValue::get(std::string& result) const
+inline bool WriteBuffer::commit(char* json, size_t len)
 {
-    if (yyjson_likely(isString())) {
-        result = unsafe_yyjson_get_str((yyjson_val*)m_val); // yyjson_mut_get_str
-        return true;
+    m_size = 0;
+    if (yyjson_unlikely(!json)) return false;
+    if (yyjson_unlikely(json != m_data)) {
+        // served by inner allocator while buffer was busy
+        bool ok = reserve(len + 1);
+        if (ok) {
+            ::memcpy(m_data, json, len + 1);
+            m_size = len;
+        }
+        m_inner.free(m_inner.ctx, json);
+        return ok;
     }
-    return false;
+    m_busy = false;
+    m_size = len;
+    return true;
 }
 
-inline bool MutableValue::get(yyjson_mut_val*& result) const
+inline void* WriteBuffer::malloc(void* ctx, size_t size)
 {
-    if (yyjson_likely(isValid())) { result = m_val; return true; }
-    return false;
+    auto* self = static_cast<WriteBuffer*>(ctx);
+    if (yyjson_unlikely(self->m_busy)) return self->m_inner.malloc(self->m_inner.ctx, size);
+    if (size > self->m_capacity) {
+        // old content is discarded, so no copy as realloc
+        if (self->m_data) self->m_inner.free(self->m_inner.ctx, self->m_data);
+        self->m_data = nullptr;
+        self->m_capacity = 0;
+        if (yyjson_unlikely(!self->reserve(size))) return nullptr;
+    }
+    self->m_size = 0;
+    self->m_busy = true;
+    return self->m_data;
 }
 
-inline bool MutableValue::get(yyjson_mut_doc*& result) const
+inline void* WriteBuffer::realloc(void* ctx, void* ptr, size_t old_size, size_t size)
 {
-    if (yyjson_likely(m_doc != nullptr)) { result = m_doc; return true; }
-    return false;
+    auto* self = static_cast<WriteBuffer*>(ctx);
+    if (ptr != self->m_data || !self->m_busy) {
+        return self->m_inner.realloc(self->m_inner.ctx, ptr, old_size, size);
+    }
+    self->m_busy = false;
+    bool ok = self->reserve(size);
+    self->m_busy = true;
+    return ok ? self->m_data : nullptr;
 }
 
-template<typename T>
-inline std::decay_t<T> MutableValue::getor(T&& defaultValue) const
+inline void WriteBuffer::free(void* ctx, void* ptr)
 {
-    using R = std::decay_t<T>;
-    R result{};
-    return get(result) ? result : static_cast<R>(defaultValue);
+    auto* self = static_cast<WriteBuffer*>(ctx);
+    if (ptr == self->m_data && self->m_busy) {
+        self->m_busy = false;
+        self->m_size = 0;
+        return;
+    }
+    self->m_inner.free(self->m_inner.ctx, ptr);
 }
 
-inline const char* MutableValue::getor(EmptyString) const
-{
-    return yyjson_likely(isString()) ? unsafe_yyjson_get_str((yyjson_val*)m_val) : "";
-}
+/* @Section 4.10: DocumentStream Methods */
+/* ------------------------------------------------------------------------ */
 
-inline double MutableValue::getor(ZeroNumber) const
+inline DocumentStream::DocumentStream(const char* str, size_t len, const ReadOptions& opt)
+    : m_data(str), m_flag(opt.flag & ~YYJSON_READ_STOP_WHEN_DONE & ~YYJSON_READ_INSITU), m_alc(opt.alc)
 {
-    return toNumber();
+    if (len == 0 && str) len = strlen(str);
+    if (str) m_end = len;
 }
 
-inline MutableArray MutableValue::getor(EmptyArray) const
+inline DocumentStream::DocumentStream(FILE* fp, const ReadOptions& opt)
+    : m_eof(fp == nullptr), m_fp(fp),
+      m_flag(opt.flag & ~YYJSON_READ_STOP_WHEN_DONE & ~YYJSON_READ_INSITU), m_alc(opt.alc)
 {
-    return array();
 }
 
-inline MutableObject MutableValue::getor(EmptyObject) const
+#ifdef XYJSON_HAS_UNISTD
+inline DocumentStream::DocumentStream(int fd, const ReadOptions& opt)
+    : m_eof(fd < 0), m_fd(fd),
+      m_flag(opt.flag & ~YYJSON_READ_STOP_WHEN_DONE & ~YYJSON_READ_INSITU), m_alc(opt.alc)
 {
-    return object();
 }
+#endif
 
-template<typename funcT>
-inline auto MutableValue::pipe(funcT&& func) const
+inline bool DocumentStream::fill()
 {
-    return util::pipeApply(*this, std::forward<funcT>(func));
-}
+    if (m_eof) return false;
 
-/* @Group 4.3.2: size and index/path */
-/* ************************************************************************ */
+    // drop consumed data, documents have their own copy
+    if (m_pos > 0) {
+        ::memmove(&m_buffer[0], &m_buffer[m_pos], m_end - m_pos);
+        m_base += m_pos;
+        m_end -= m_pos;
+        m_pos = 0;
+    }
 
-inline size_t MutableValue::size() const
+    size_t chunk = m_end > kChunk ? m_end : kChunk;
+    if (m_buffer.size() < m_end + chunk) m_buffer.resize(m_end + chunk);
+    m_data = m_buffer.data();
+
+    size_t n = 0;
+    if (m_fp) {
+        n = ::fread(&m_buffer[m_end], 1, chunk, m_fp);
+    }
+#ifdef XYJSON_HAS_UNISTD
+    else if (m_fd >= 0) {
+        ssize_t r = 0;
+        do { r = ::read(m_fd, &m_buffer[m_end], chunk); } while (r < 0 && errno == EINTR);
+        n = r > 0 ? static_cast<size_t>(r) : 0;
+    }
+#endif
+
+    if (n == 0) { m_eof = true; return false; }
+    m_end += n;
+    return true;
+}
+
+inline Document DocumentStream::parse(size_t window, yyjson_read_err* err)
 {
-    if (yyjson_unlikely(!m_val)) return 0;
-    if (yyjson_mut_is_arr(m_val)) return yyjson_mut_arr_size(m_val);
-    if (yyjson_mut_is_obj(m_val)) return yyjson_mut_obj_size(m_val);
-    return 0;
+    const char* str = m_data + m_pos;
+    yyjson_read_flag flg = m_flag | YYJSON_READ_STOP_WHEN_DONE;
+    if (!m_alc.isDefault()) {
+        return Document(yyjson_read_opts(const_cast<char*>(str), window, flg, m_alc.c_alc(), err));
+    }
+    return m_session.parse(str, window, flg, err);
 }
 
-inline void MutableValue::clear()
+inline bool DocumentStream::next(Document& doc)
 {
-    if (yyjson_unlikely(!m_val || !m_doc)) return;
+    // free first so that the session memory can be recycled
+    doc.free();
+    if (yyjson_unlikely(hasError())) return false;
 
-    if (yyjson_mut_is_arr(m_val)) {
-        yyjson_mut_arr_clear(m_val);
-    }
-    else if (yyjson_mut_is_obj(m_val)) {
-        yyjson_mut_obj_clear(m_val);
-    }
-    else if (yyjson_mut_is_str(m_val)) {
-        set("");
-    }
-    else if (yyjson_mut_is_int(m_val) || yyjson_mut_is_sint(m_val) || yyjson_mut_is_uint(m_val)) {
-        set(0);
+    for (;;)
+    {
+        while (m_pos < m_end) {
+            char c = m_data[m_pos];
+            if (c != ' ' && c != '\n' && c != '\r' && c != '\t') break;
+            ++m_pos;
+        }
+        if (m_pos < m_end) break;
+        if (!fill()) return false;
     }
-    else if (yyjson_mut_is_real(m_val)) {
-        set(0.0);
+
+    for (;;)
+    {
+        size_t avail = m_end - m_pos;
+        size_t window = avail < m_window ? avail : m_window;
+        bool complete = (window == avail && m_eof);
+
+        yyjson_read_err err;
+        doc = parse(window, &err);
+        // a value ends just at window end may be truncated, e.g. number
+        if (doc.isValid() && (doc.readSize() < window || complete)) break;
+        if (!doc.isValid() && (err.code != YYJSON_READ_ERROR_UNEXPECTED_END || complete)) {
+            m_err = err;
+            m_err.pos += m_base + m_pos;
+            return false;
+        }
+
+        doc.free();
+        if (window < avail) {
+            m_window *= 2;
+        }
+        else {
+            fill();
+        }
     }
-    // Note: null and bool types are not cleared as they have no meaningful "zero" value
+
+    m_offset = m_base + m_pos;
+    m_size = doc.readSize();
+    m_pos += m_size;
+    m_count++;
+    return true;
 }
 
-inline MutableValue MutableValue::index(size_t idx) const
+/* @Section 4.11: Parallel Processing Methods */
+/* ------------------------------------------------------------------------ */
+#ifndef XYJSON_DISABLE_THREAD
+
+inline TaskPool::TaskPool(size_t threads/* = 0*/)
 {
-    if (yyjson_unlikely(!isArray())) return MutableValue(nullptr, m_doc);
-    return MutableValue(yyjson_mut_arr_get(m_val, idx), m_doc);
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    m_queues.reset(new Queue[threads]);
+    m_workers.reserve(threads - 1);
+    for (size_t i = 0; i + 1 < threads; ++i) {
+        m_workers.emplace_back(&TaskPool::work, this, i);
+    }
 }
 
-inline MutableValue MutableValue::index(const char* key, size_t len) const
+inline TaskPool::~TaskPool()
 {
-    if (yyjson_unlikely(!isObject() || !key)) return MutableValue(nullptr, m_doc);
-    return MutableValue(yyjson_mut_obj_getn(m_val, key, len), m_doc);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
 }
 
-inline MutableValue MutableValue::index(size_t idx)
+inline void TaskPool::start(size_t count, std::function<void(size_t)> func)
 {
-    if (yyjson_unlikely(!isArray())) return MutableValue(nullptr, m_doc);
-    return MutableValue(yyjson_mut_arr_get(m_val, idx), m_doc);
+    if (count == 0) return;
+
+    m_func = std::move(func);
+    m_pending += count;
+    size_t n = size();
+    for (size_t task = 0; task < count; ++task) {
+        Queue& queue = m_queues[task % n];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(task);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_round;
+    }
+    m_wake.notify_all();
 }
 
-inline MutableValue MutableValue::index(const char* key, size_t len)
+inline void TaskPool::wait()
 {
-    if (yyjson_unlikely(!isObject() || !key)) return MutableValue(nullptr, m_doc);
-    yyjson_mut_val* val = yyjson_mut_obj_getn(m_val, key, len);
-    if (yyjson_unlikely(!val)) {
-        // Key doesn't exist, insert null value with explicit length
-        val = yyjson_mut_null(m_doc);
-        yyjson_mut_val* key_val = yyjson_mut_strncpy(m_doc, key, len);
-        yyjson_mut_obj_add(m_val, key_val, val);
-    }
-    return MutableValue(val, m_doc);
+    drain();
+    std::exception_ptr error;
+    std::swap(error, m_error);
+    if (error) std::rethrow_exception(error);
 }
 
-inline MutableValue MutableValue::pathto(const char* path, size_t len) const
+inline void TaskPool::drain()
 {
-    if (yyjson_unlikely(!path || len == 0)) return *this;
-    if (path[0] == '/') {
-        yyjson_mut_val* result = yyjson_mut_ptr_getn(m_val, path, len);
-        return MutableValue(result, m_doc);
+    size_t task = 0;
+    while (take(m_workers.size(), task)) {
+        runTask(task);
     }
-    return index(path, len);
-}
 
-/* @Group 4.3.3: assignment set */
-/* ************************************************************************ */
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return m_pending.load() == 0; });
+    m_failed = false;
+}
 
-inline MutableValue& MutableValue::set(const MutableValue& other)
+inline void TaskPool::runTask(size_t task)
 {
-    if (this != &other) {
-        m_val = other.m_val;
-        m_doc = other.m_doc;
+#if defined(__cpp_exceptions)
+    // always finish, or wait() would never return
+    if (!m_failed.load(std::memory_order_relaxed)) {
+        try { m_func(task); }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_error) m_error = std::current_exception();
+            m_failed = true;
+        }
     }
-    return *this;
+#else
+    m_func(task);
+#endif
+    finish();
 }
 
-inline MutableValue& MutableValue::set(std::nullptr_t value)
+inline bool TaskPool::take(size_t id, size_t& task)
 {
-    yyjson_mut_set_null(m_val);
-    return *this;
+    size_t n = size();
+    {
+        Queue& queue = m_queues[id];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+
+    // steal from the back of other queues
+    for (size_t k = 1; k < n; ++k) {
+        Queue& queue = m_queues[(id + k) % n];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
 }
 
-inline MutableValue& MutableValue::set(bool value)
+inline void TaskPool::finish()
 {
-    yyjson_mut_set_bool(m_val, value);
-    return *this;
+    if (m_pending.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done.notify_all();
+    }
 }
 
-inline MutableValue& MutableValue::set(int value)
+inline void TaskPool::work(size_t id)
 {
-    yyjson_mut_set_int(m_val, value);
-    return *this;
+    size_t round = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this, round]() { return m_stop || m_round != round; });
+            if (m_stop) return;
+            round = m_round;
+        }
+
+        size_t task = 0;
+        while (take(id, task)) {
+            runTask(task);
+        }
+    }
 }
 
-inline MutableValue& MutableValue::set(int64_t value)
+inline size_t ParallelParser::parseLines(const char* str, size_t len,
+    const Callback& callback, const ReadOptions& opt/* = ReadOptions()*/)
 {
-    yyjson_mut_set_sint(m_val, value);
-    return *this;
+    if (len == 0 && str) len = strlen(str);
+    if (yyjson_unlikely(!str || !callback)) return 0;
+
+    // split chunks at newline boundaries
+    std::vector<size_t> bounds(1, 0);
+    size_t chunkSize = m_opt.chunkSize > 0 ? m_opt.chunkSize : 1;
+    for (size_t pos = 0; pos < len; pos = bounds.back()) {
+        size_t end = len - pos > chunkSize ? pos + chunkSize : len;
+        if (end < len) {
+            const void* nl = ::memchr(str + end, '\n', len - end);
+            end = nl ? static_cast<const char*>(nl) - str + 1 : len;
+        }
+        bounds.push_back(end);
+    }
+    size_t chunks = bounds.size() - 1;
+
+    ReadOptions lineOpt(opt.flag & ~YYJSON_READ_INSITU & ~YYJSON_READ_STOP_WHEN_DONE, opt.alc);
+    std::atomic<size_t> valid{0};
+    auto parseChunk = [&](size_t chunk, const Callback& emit) {
+        size_t pos = bounds[chunk];
+        size_t end = bounds[chunk + 1];
+        while (pos < end) {
+            const void* nl = ::memchr(str + pos, '\n', end - pos);
+            size_t eol = nl ? static_cast<const char*>(nl) - str : end;
+            while (pos < eol && (str[pos] == ' ' || str[pos] == '\t' || str[pos] == '\r')) {
+                ++pos;
+            }
+            if (pos < eol) {
+                Document doc(str + pos, eol - pos, lineOpt);
+                if (doc.isValid()) valid++;
+                emit(doc, pos);
+            }
+            pos = eol + 1;
+        }
+    };
+
+    if (!m_opt.ordered) {
+        m_pool.run(chunks, [&](size_t chunk) { parseChunk(chunk, callback); });
+        return valid.load();
+    }
+
+    // double buffer of batches, deliver one while parsing the next
+    using Records = std::vector<std::pair<size_t, Document>>;
+    size_t batch = m_pool.size() * 4;
+    std::vector<Records> buffers[2] = {std::vector<Records>(batch), std::vector<Records>(batch)};
+    auto startBatch = [&](size_t first, Records* out) {
+        size_t count = chunks - first < batch ? chunks - first : batch;
+        m_pool.start(count, [&parseChunk, first, out](size_t i) {
+            parseChunk(first + i, [&out, i](Document& doc, size_t offset) {
+                out[i].emplace_back(offset, std::move(doc));
+            });
+        });
+    };
+    // callback runs while next batch is parsing
+    TaskPool::WaitGuard guard(m_pool);
+
+    if (chunks > 0) startBatch(0, buffers[0].data());
+    for (size_t first = 0, k = 0; first < chunks; first += batch, ++k)
+    {
+        m_pool.wait();
+        if (first + batch < chunks) {
+            startBatch(first + batch, buffers[(k + 1) % 2].data());
+        }
+
+        std::vector<Records>& ready = buffers[k % 2];
+        for (Records& records : ready) {
+            for (auto& record : records) {
+                callback(record.second, record.first);
+            }
+            records.clear();
+        }
+    }
+
+    return valid.load();
 }
 
-inline MutableValue& MutableValue::set(uint64_t value)
+inline Document ParallelParser::parseArray(const char* str, size_t len/* = 0*/,
+    const ReadOptions& opt/* = ReadOptions()*/)
 {
-    yyjson_mut_set_uint(m_val, value);
-    return *this;
+    if (len == 0 && str) len = strlen(str);
+    if (yyjson_unlikely(!str)) return Document();
+
+    // sequential parse if not worth or not safe to split
+    const char* end = str + len;
+    const char* open = util::skipSpace(str, end);
+    const char* close = end;
+    while (close > open && util::isSpace(close[-1])) --close;
+    size_t chunkSize = m_opt.chunkSize > 0 ? m_opt.chunkSize : 1;
+    size_t slices = len / chunkSize;
+    yyjson_read_flag unsafe = YYJSON_READ_ALLOW_COMMENTS | YYJSON_READ_ALLOW_TRAILING_COMMAS;
+    if (slices < 2 || m_pool.size() < 2 || close - open < 2 || *open != '['
+        || *--close != ']' || (opt.flag & unsafe) != 0) {
+        return Document(str, len, opt);
+    }
+
+    // prepass: summarize slices in parallel, then resolve their start state
+    const char* first = open + 1;
+    size_t span = close - first;
+    auto sliceBegin = [first, span, slices](size_t k) {
+        return first + span / slices * k + span % slices * k / slices;
+    };
+    std::vector<util::SliceSummary> summary(slices);
+    m_pool.run(slices, [&](size_t k) {
+        summary[k] = util::summarizeSlice(str, sliceBegin(k), sliceBegin(k + 1));
+    });
+
+    std::vector<char> inString(slices);
+    std::vector<long> depth(slices);
+    bool quoted = false;
+    long level = 1;
+    for (size_t k = 0; k < slices; ++k) {
+        inString[k] = quoted;
+        depth[k] = level;
+        level += summary[k].depth[quoted];
+        quoted = quoted != summary[k].oddQuotes;
+    }
+    if (quoted || level != 1) return Document(str, len, opt);
+
+    // the first element boundary in each slice
+    std::vector<const char*> bounds(slices + 1);
+    bounds[0] = open;
+    bounds[slices] = close;
+    // none in slice, as inside a long element, merged into the previous range
+    m_pool.run(slices - 1, [&](size_t i) {
+        size_t k = i + 1;
+        const char* stop = sliceBegin(k + 1);
+        const char* comma = util::scanComma(str, sliceBegin(k), stop, inString[k], depth[k]);
+        bounds[k] = comma < stop ? comma : nullptr;
+    });
+    bounds.erase(std::remove(bounds.begin(), bounds.end(), nullptr), bounds.end());
+    size_t chunks = bounds.size() - 1;
+
+    // parse element ranges as small arrays in-situ, each range copied with
+    // brackets in place of its bounds into one buffer kept by holder
+    std::vector<size_t> starts(chunks + 1);
+    for (size_t k = 0; k < chunks; ++k) {
+        starts[k + 1] = starts[k] + (bounds[k + 1] - bounds[k]) + 1 + YYJSON_PADDING_SIZE;
+    }
+    auto* holder = new util::SliceHolder(opt.alc.c_alc(), starts[chunks]);
+    std::vector<yyjson_doc*> docs(chunks, nullptr);
+    std::vector<yyjson_read_err> errs(chunks);
+    yyjson_read_flag flag = (opt.flag | YYJSON_READ_INSITU) & ~YYJSON_READ_STOP_WHEN_DONE;
+    m_pool.run(chunks, [&](size_t k) {
+        char* buffer = holder->buffer.get() + starts[k];
+        size_t size = bounds[k + 1] - bounds[k] + 1;
+        ::memcpy(buffer, bounds[k], size);
+        buffer[0] = '[';
+        buffer[size - 1] = ']';
+        ::memset(buffer + size, 0, YYJSON_PADDING_SIZE);
+        docs[k] = yyjson_read_opts(buffer, size, flag, &holder->inner, &errs[k]);
+    });
+
+    // stitch the values of all ranges after a new root array
+    size_t vals = 1;
+    size_t count = 0;
+    std::vector<size_t> offsets(chunks + 1);
+    bool ok = true;
+    for (size_t k = 0; k < chunks; ++k) {
+        yyjson_val* root = yyjson_doc_get_root(docs[k]);
+        if (yyjson_unlikely(!root)) {
+            // the same error as sequential parsing, buffer maps to input
+            if (opt.err) {
+                *opt.err = errs[k];
+                opt.err->pos += bounds[k] - str;
+            }
+            ok = false;
+            break;
+        }
+        if (yyjson_unlikely(yyjson_arr_size(root) == 0)) {
+            // blank array is valid, but empty range as in "[1,,2]" is not
+            if (chunks == 1) break;
+            if (opt.err) {
+                opt.err->code = YYJSON_READ_ERROR_UNEXPECTED_CHARACTER;
+                opt.err->msg = "unexpected character, expected a json value";
+                opt.err->pos = bounds[k + 1] - str;
+            }
+            ok = false;
+            break;
+        }
+        offsets[k] = vals;
+        vals += yyjson_doc_get_val_count(docs[k]) - 1;
+        count += yyjson_arr_size(root);
+    }
+    offsets[chunks] = vals;
+
+    yyjson_doc* doc = nullptr;
+    if (ok && count > 0) {
+        size_t hdr = (sizeof(yyjson_doc) + sizeof(yyjson_val) - 1) / sizeof(yyjson_val) * sizeof(yyjson_val);
+        yyjson_alc alc = holder->wrap();
+        doc = static_cast<yyjson_doc*>(alc.malloc(alc.ctx, hdr + vals * sizeof(yyjson_val)));
+        if (yyjson_likely(doc)) {
+            ::memset(doc, 0, sizeof(yyjson_doc));
+            doc->alc = alc;
+            doc->dat_read = len;
+            doc->val_read = vals;
+            doc->root = reinterpret_cast<yyjson_val*>(reinterpret_cast<char*>(doc) + hdr);
+            doc->root->tag = (static_cast<uint64_t>(count) << YYJSON_TAG_BIT) | YYJSON_TYPE_ARR;
+            doc->root->uni.ofs = vals * sizeof(yyjson_val);
+            // free values of each range as soon as copied
+            m_pool.run(chunks, [&](size_t k) {
+                yyjson_val* root = yyjson_doc_get_root(docs[k]);
+                ::memcpy(doc->root + offsets[k], root + 1, (offsets[k + 1] - offsets[k]) * sizeof(yyjson_val));
+                yyjson_doc_free(docs[k]);
+                docs[k] = nullptr;
+            });
+        }
+        else if (opt.err) {
+            opt.err->code = YYJSON_READ_ERROR_MEMORY_ALLOCATION;
+            opt.err->msg = "memory allocation failed";
+            opt.err->pos = 0;
+        }
+    }
+
+    for (yyjson_doc* chunk : docs) {
+        yyjson_doc_free(chunk);
+    }
+    holder->unpin();
+    if (ok && count == 0) return Document(str, len, opt);
+    if (doc && opt.err) *opt.err = yyjson_read_err{};
+    return Document(doc);
 }
 
-inline MutableValue& MutableValue::set(double value)
+inline size_t ParallelWriter::chunkValues() const
 {
-    yyjson_mut_set_real(m_val, value);
-    return *this;
+    // the text is roughly the size of values in memory
+    size_t count = m_opt.chunkSize / sizeof(yyjson_val);
+    return count > 0 ? count : 1;
 }
 
-inline MutableValue& MutableValue::set(const std::string& value)
+template <typename valT>
+inline bool ParallelWriter::isLarge(valT* val) const
 {
-    return setCopy(value.c_str(), value.size());
+    return m_pool.size() > 1 && !util::isSmallTree(val, chunkValues());
 }
 
-inline MutableValue& MutableValue::set(StringRef value)
+template <typename valT>
+inline bool ParallelWriter::writeTree(valT* root, yyjson_write_flag flg, const Sink& sink)
 {
-    if (value.len == 2)
+    std::vector<valT*> keys;
+    std::vector<valT*> vals;
+    std::vector<size_t> weights;
+    size_t total = 0;
+    util::walkChildren(root, [&](valT* key, valT* child) {
+        keys.push_back(key);
+        vals.push_back(child);
+        weights.push_back(util::treeWeight(child, chunkValues()));
+        total += weights.back();
+        return true;
+    });
+
+    // ranges of children with about the same weight
+    size_t target = total / (m_pool.size() * 4);
+    if (target > chunkValues()) target = chunkValues();
+    if (target == 0) target = 1;
+    std::vector<size_t> bounds(1, 0);
+    size_t weight = 0;
+    for (size_t i = 0; i < vals.size(); ++i) {
+        weight += weights[i];
+        if (weight >= target || i + 1 == vals.size()) {
+            bounds.push_back(i + 1);
+            weight = 0;
+        }
+    }
+    size_t ranges = bounds.size() - 1;
+
+    // serialize range as StreamWriter does for the members at level 1,
+    // with brackets in the first and last chunk
+    bool isObject = unsafe_yyjson_get_type(root) == YYJSON_TYPE_OBJ;
+    yyjson_write_flag inner = flg & ~YYJSON_WRITE_NEWLINE_AT_END;
+    auto writeRange = [&](size_t k, std::string& text) {
+        text.clear();
+        util::StringBuf buf(text);
+        StreamWriter writer(&buf, inner);
+        bool ok = k > 0 || writer.put(isObject ? '{' : '[');
+        for (size_t i = bounds[k]; ok && i < bounds[k + 1]; ++i) {
+            ok = (i == 0 || writer.put(',')) && writer.emitMember(keys[i], vals[i], 1);
+        }
+        if (ok && k + 1 == ranges) {
+            ok = (!writer.pretty() || writer.newline(0)) && writer.put(isObject ? '}' : ']');
+            if (ok && (flg & YYJSON_WRITE_NEWLINE_AT_END)) ok = writer.put('\n');
+        }
+        return writer.flush() && ok;
+    };
+
+    // double buffer of batches, deliver one while writing the next
+    size_t batch = m_pool.size() * 4;
+    std::vector<std::string> buffers[2] = {std::vector<std::string>(batch), std::vector<std::string>(batch)};
+    std::vector<char> failed[2] = {std::vector<char>(batch), std::vector<char>(batch)};
+    auto startBatch = [&](size_t first, size_t k) {
+        size_t count = ranges - first < batch ? ranges - first : batch;
+        std::string* out = buffers[k].data();
+        char* bad = failed[k].data();
+        m_pool.start(count, [&writeRange, first, out, bad](size_t i) {
+            bad[i] = !writeRange(first + i, out[i]);
+        });
+    };
+    // sink runs while next batch is writing
+    TaskPool::WaitGuard guard(m_pool);
+
+    bool ok = true;
+    startBatch(0, 0);
+    for (size_t first = 0, k = 0; first < ranges; first += batch, ++k)
     {
-        if (::strcmp(value, "{}") == 0) { return setObject(); }
-        if (::strcmp(value, "[]") == 0) { return setArray(); }
+        m_pool.wait();
+        size_t count = ranges - first < batch ? ranges - first : batch;
+        std::vector<char>& bad = failed[k % 2];
+        ok = ok && std::find(bad.begin(), bad.begin() + count, 1) == bad.begin() + count;
+        if (ok && first + batch < ranges) {
+            startBatch(first + batch, (k + 1) % 2);
+        }
+        ok = ok && sink(buffers[k % 2].data(), count);
+        if (!ok) break;
     }
-    yyjson_mut_set_strn(m_val, value.str, value.len);
-    return *this;
+    return ok;
 }
 
-inline MutableValue& MutableValue::setCopy(const char* value, size_t len)
+template <typename jsonT>
+inline bool ParallelWriter::writeString(const jsonT& json, std::string& output, yyjson_write_flag flg)
 {
-    if (isValid() && value)
-    {
-        // copy input value to new node
-        // let old node point to the string in the new old.
-        // Note the new node and old string is not accessible
-        // and only free when the document is freed.
-        yyjson_mut_val* newNode = yyjson_mut_strncpy(m_doc, value, len);
-        const char* newStr = yyjson_mut_get_str(newNode);
-        yyjson_mut_set_str(m_val, newStr);
-    }
-    return *this;
+    if (!json.isValid() || !isLarge(json.c_val())) return json.write(output, flg);
+    output.clear();
+    return writeTree(json.c_val(), flg, [&output](const std::string* chunks, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            output.append(chunks[i]);
+        }
+        return true;
+    });
 }
 
-template <size_t N>
-inline MutableValue& MutableValue::set(const char(&value)[N])
+template <typename jsonT>
+inline bool ParallelWriter::writeFile(const jsonT& json, FILE* fp, yyjson_write_flag flg)
 {
-    if (N == 3)
-    {
-        if (::strcmp(value, "{}") == 0) { return setObject(); }
-        if (::strcmp(value, "[]") == 0) { return setArray(); }
+    if (yyjson_unlikely(!fp || !json.isValid())) return false;
+    if (!isLarge(json.c_val())) {
+        StreamWriter writer(fp, flg);
+        return writer.write(json) && writer.flush();
     }
-    yyjson_mut_set_strn(m_val, value, N-1);
-    return *this;
+    return writeTree(json.c_val(), flg, [fp](const std::string* chunks, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            if (::fwrite(chunks[i].data(), 1, chunks[i].size(), fp) != chunks[i].size()) return false;
+        }
+        return true;
+    });
+}
+
+#ifdef XYJSON_HAS_UNISTD
+template <typename jsonT>
+inline bool ParallelWriter::writeFd(const jsonT& json, int fd, yyjson_write_flag flg)
+{
+    if (yyjson_unlikely(fd < 0 || !json.isValid())) return false;
+    if (!isLarge(json.c_val())) {
+        StreamWriter writer(fd, flg);
+        return writer.write(json) && writer.flush();
+    }
+    return writeTree(json.c_val(), flg, [fd](const std::string* chunks, size_t count) {
+        // gather no more than the minimal IOV_MAX of POSIX per call
+        constexpr size_t kIov = 16;
+        struct iovec iov[kIov];
+        size_t i = 0;
+        while (i < count) {
+            size_t n = 0;
+            for (size_t j = i; j < count && n < kIov; ++j, ++n) {
+                iov[n].iov_base = const_cast<char*>(chunks[j].data());
+                iov[n].iov_len = chunks[j].size();
+            }
+            ssize_t written = ::writev(fd, iov, static_cast<int>(n));
+            if (written < 0 && errno == EINTR) continue;
+            if (written < 0) return false;
+
+            // skip written chunks, and the rest of partial one by write()
+            size_t done = static_cast<size_t>(written);
+            for (; i < count && done >= chunks[i].size(); ++i) {
+                done -= chunks[i].size();
+            }
+            if (done > 0) {
+                const char* p = chunks[i].data() + done;
+                size_t len = chunks[i].size() - done;
+                while (len > 0) {
+                    ssize_t m = ::write(fd, p, len);
+                    if (m < 0 && errno == EINTR) continue;
+                    if (m <= 0) return false;
+                    p += m;
+                    len -= static_cast<size_t>(m);
+                }
+                ++i;
+            }
+        }
+        return true;
+    });
 }
+#endif
 
-template <size_t N>
-inline MutableValue& MutableValue::set(char(&value)[N])
+inline bool ParallelWriter::write(const Value& val, std::string& output, yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/)
 {
-    return setCopy(value, ::strlen(value));
+    return writeString(val, output, flg);
 }
 
-template<typename T>
-inline typename std::enable_if<trait::is_cstr_type<T>(), MutableValue&>::type
-MutableValue::set(T value)
+inline bool ParallelWriter::write(const Value& val, FILE* fp, yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/)
 {
-    return setCopy(value, ::strlen(value));
+    return writeFile(val, fp, flg);
 }
 
-inline MutableValue& MutableValue::setArray()
+#ifdef XYJSON_HAS_UNISTD
+inline bool ParallelWriter::write(const Value& val, int fd, yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/)
 {
-    if (yyjson_unlikely(isValid()))
-    {
-        yyjson_mut_set_arr(m_val);
-    }
-    return *this;
+    return writeFd(val, fd, flg);
 }
+#endif
 
-inline MutableValue& MutableValue::setObject()
+#ifndef XYJSON_DISABLE_MUTABLE
+inline bool ParallelWriter::write(const MutableValue& val, std::string& output, yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/)
 {
-    if (yyjson_unlikely(isValid()))
-    {
-        yyjson_mut_set_obj(m_val);
-    }
-    return *this;
+    return writeString(val, output, flg);
 }
 
-/* @Group 4.3.4: array and object add */
-/* ************************************************************************ */
-
-inline MutableValue& MutableValue::append(yyjson_mut_val* value)
+inline bool ParallelWriter::write(const MutableValue& val, FILE* fp, yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/)
 {
-    yyjson_mut_arr_append(m_val, value); // the C API would check argument
-    return *this;
+    return writeFile(val, fp, flg);
 }
 
-template <typename T>
-inline MutableValue& MutableValue::append(T&& value)
+#ifdef XYJSON_HAS_UNISTD
+inline bool ParallelWriter::write(const MutableValue& val, int fd, yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/)
 {
-    return append(util::create(m_doc, std::forward<T>(value)));
+    return writeFd(val, fd, flg);
 }
+#endif
+#endif // XYJSON_DISABLE_MUTABLE
 
-inline MutableValue& MutableValue::add(yyjson_mut_val* key, yyjson_mut_val* value)
+inline bool Document::write(std::string& output, const ParallelOptions& opt,
+    yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/) const
 {
-    yyjson_mut_obj_add(m_val, key, value); // the C API would check argument
-    return *this;
+    return ParallelWriter(opt).write(root(), output, flg);
 }
 
-inline MutableValue& MutableValue::add(KeyValue&& kv)
+inline bool Document::write(FILE* fp, const ParallelOptions& opt,
+    yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/) const
 {
-    if (yyjson_likely(yyjson_mut_obj_add(m_val, kv.key, kv.value)))
-    {
-        kv.key = nullptr;
-        kv.value = nullptr;
-    }
-    return *this;
+    return ParallelWriter(opt).write(root(), fp, flg);
 }
 
-template<typename keyT, typename valT>
-inline MutableValue& MutableValue::add(keyT&& key, valT&& value)
+#ifndef XYJSON_DISABLE_MUTABLE
+inline bool MutableDocument::write(std::string& output, const ParallelOptions& opt,
+    yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/) const
 {
-    if (yyjson_likely(isObject())) {
-        yyjson_mut_val* keyNode = util::createKey(m_doc, std::forward<keyT>(key));
-        if (yyjson_unlikely(!keyNode)) {
-            return *this;
-        }
-        
-        yyjson_mut_val* valNode = util::create(m_doc, std::forward<valT>(value));
-        yyjson_mut_obj_add(m_val, keyNode, valNode);
-    }
-    return *this;
+    return ParallelWriter(opt).write(root(), output, flg);
 }
 
-/* @Group 4.3.5: smart input and tag */
-/* ************************************************************************ */
-
-inline KeyValue MutableValue::tag(MutableValue&& key) &&
+inline bool MutableDocument::write(FILE* fp, const ParallelOptions& opt,
+    yyjson_write_flag flg/* = YYJSON_WRITE_NOFLAG*/) const
 {
-    // Require same document pool and string type; do not copy
-    yyjson_mut_val* keyNode = nullptr;
-    if (yyjson_likely(key.m_doc == m_doc && key.isString()))
-    {
-        keyNode = key.m_val;
-    }
-    auto ret = KeyValue(keyNode, m_val);
-    m_val = nullptr;
-    key.m_val = nullptr;
-    return ret;
+    return ParallelWriter(opt).write(root(), fp, flg);
 }
+#endif
 
-template <typename keyT>
-inline KeyValue MutableValue::tag(keyT&& key) &&
+#endif // XYJSON_DISABLE_THREAD
+
+/* @Section 4.12: IncrementalDocument Methods */
+/* ------------------------------------------------------------------------ */
+#ifdef XYJSON_HAS_INCR
+
+inline IncrementalDocument::IncrementalDocument(size_t total/* = 0*/, const ReadOptions& opt/* = ReadOptions()*/)
+    : m_flag(opt.flag & ~YYJSON_READ_INSITU & ~YYJSON_READ_STOP_WHEN_DONE), m_alc(opt.alc)
 {
-    yyjson_mut_val* keyNode = util::createKey(m_doc, std::forward<keyT>(key));
-    auto ret = KeyValue(keyNode, m_val);
-    m_val = nullptr;
-    return ret;
+    reset(total);
 }
 
-// Specialization for KeyValue - can only be added to object
-inline MutableValue& MutableValue::push(KeyValue&& kv)
+inline void IncrementalDocument::clear()
 {
-    if (yyjson_likely(isObject()))
-    {
-        return add(std::forward<KeyValue>(kv));
+    if (m_state) {
+        yyjson_incr_free(m_state);
+        m_state = nullptr;
+    }
+    if (m_doc) {
+        yyjson_doc_free(m_doc);
+        m_doc = nullptr;
     }
-    return *this;
 }
 
-#ifndef XYJSON_DISABLE_CHAINED_INPUT
-template <typename keyT>
-inline bool MutableValue::pushKey(keyT&& key)
+inline void IncrementalDocument::reset(size_t total/* = 0*/)
 {
-    m_pendingKey = util::createKey(m_doc, std::forward<keyT>(key));
-    return false;
+    clear();
+    m_size = 0;
+    m_total = total;
+    m_err = {YYJSON_READ_SUCCESS, nullptr, 0};
+    m_buffer.clear();
+    if (total > 0) m_buffer.resize(total);
 }
 
-template <typename T>
-inline bool MutableValue::pushValue(T&& value)
+inline bool IncrementalDocument::restart()
 {
-    if (yyjson_likely(m_pendingKey == nullptr)) {
+    if (m_state) {
+        yyjson_incr_free(m_state);
+        m_state = nullptr;
+    }
+
+    // wait the first token to know the root type
+    size_t pos = 0;
+    while (pos < m_size && util::isSpace(m_buffer[pos])) ++pos;
+    if (pos == m_size) return true;
+
+    // buffer is larger than input if size is unknown, a closed container
+    // ends the root, any content after it is checked in feed()
+    yyjson_read_flag flag = m_flag;
+    if (m_buffer[pos] == '[' || m_buffer[pos] == '{') flag |= YYJSON_READ_STOP_WHEN_DONE;
+    m_state = yyjson_incr_new(&m_buffer[0], m_buffer.size(), flag, m_alc.c_alc());
+    if (yyjson_unlikely(!m_state)) {
+        m_err = {YYJSON_READ_ERROR_MEMORY_ALLOCATION, "failed to create incremental state", 0};
         return false;
     }
-    yyjson_mut_val* succeedVal = util::create(m_doc, std::forward<T>(value));
-    add(m_pendingKey, succeedVal);
-    m_pendingKey = nullptr;
     return true;
 }
-#endif
 
-// General template for other types
-template <typename T>
-inline MutableValue& MutableValue::push(T&& value)
+inline bool IncrementalDocument::feed(const char* data, size_t len)
 {
-    if (isArray()) {
-        return append(std::forward<T>(value));
+    if (yyjson_unlikely(hasError())) return false;
+    if (len == 0) return true;
+    if (yyjson_unlikely(!data)) {
+        m_err = {YYJSON_READ_ERROR_INVALID_PARAMETER, "input data is NULL", m_size};
+        return false;
     }
-#ifndef XYJSON_DISABLE_CHAINED_INPUT
-    else if (isObject()) {
-        bool ok = pushValue(std::forward<T>(value)) || pushKey(std::forward<T>(value));
+
+    // only whitespace may follow the complete root value
+    if (m_doc) {
+        if (!onlySpace(data, len, m_size)) return false;
+        m_size += len;
+        return true;
     }
-#endif
-    return *this;
-}
 
-// Pop method for array: remove last element and return it
-inline MutableValue& MutableValue::pop(MutableValue& result)
-{
-    if (yyjson_likely(isArray())) {
-        size_t n = size();
-        if (yyjson_likely(n > 0)) {
-            MutableArrayIterator iter = beginArray();
-            iter.advance(n - 1);
-            result = iter.remove();
-            return *this;
+    if (m_size + len > m_buffer.size()) {
+        // more than expected, continue as unknown size, the state refers to
+        // the old buffer and parses the data fed again after growth
+        m_total = 0;
+        if (m_state) {
+            yyjson_incr_free(m_state);
+            m_state = nullptr;
         }
+        size_t capacity = m_buffer.size() * 2;
+        if (capacity < m_size + len) capacity = m_size + len;
+        if (capacity < kChunk) capacity = kChunk;
+        m_buffer.resize(capacity);
+    }
+
+    ::memcpy(&m_buffer[m_size], data, len);
+    m_size += len;
+    if (!m_state) {
+        if (!restart()) return false;
+        if (!m_state) return true; // only whitespace yet
+    }
+
+    m_err = {YYJSON_READ_SUCCESS, nullptr, 0};
+    m_doc = yyjson_incr_read(m_state, m_size, &m_err);
+    if (m_doc) {
+        yyjson_incr_free(m_state);
+        m_state = nullptr;
+        // the rest of this chunk after the closed root
+        size_t end = yyjson_doc_get_read_size(m_doc);
+        if (end < m_size && !onlySpace(&m_buffer[end], m_size - end, end)) {
+            yyjson_doc_free(m_doc);
+            m_doc = nullptr;
+            return false;
+        }
+        return true;
     }
-    result = MutableValue(nullptr, m_doc);
-    return *this;
+    return m_err.code == YYJSON_READ_ERROR_MORE;
 }
 
-// Pop method for object: remove last key-value pair and return it
-inline MutableValue& MutableValue::pop(KeyValue& result)
+inline bool IncrementalDocument::onlySpace(const char* data, size_t len, size_t offset)
 {
-    if (yyjson_likely(isObject())) {
-        size_t n = size();
-        if (yyjson_likely(n > 0)) {
-            MutableObjectIterator iter = beginObject();
-            iter.advance(n - 1);
-            result = iter.remove();
-            return *this;
+    for (size_t i = 0; i < len; ++i) {
+        char c = data[i];
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+            m_err = {YYJSON_READ_ERROR_UNEXPECTED_CONTENT, "unexpected content after document", offset + i};
+            return false;
         }
     }
-    result = KeyValue(nullptr, nullptr);
-    return *this;
+    return true;
 }
 
-/* @Group 4.3.6: create iterator */
-/* ************************************************************************ */
-
-inline MutableArrayIterator MutableValue::iterator(size_t startIndex) const
+inline Document IncrementalDocument::finish()
 {
-    if (yyjson_likely(isArray())) {
-        MutableArrayIterator iter(m_val, m_doc);
-        if (yyjson_likely(startIndex == 0)) return iter;
-        return iter.advance(startIndex);
+    Document result;
+    if (m_doc) {
+        result = Document(m_doc);
+        m_doc = nullptr;
     }
-    return MutableArrayIterator();
+    else if (!hasError()) {
+        // the end of input is known only now if size is not given
+        result = Document(yyjson_read_opts(&m_buffer[0], m_size, m_flag, m_alc.c_alc(), &m_err));
+    }
+
+    if (m_state) {
+        yyjson_incr_free(m_state);
+        m_state = nullptr;
+    }
+    return result;
 }
 
-inline MutableArrayIterator MutableValue::iterator(int startIndex) const
+#endif // XYJSON_HAS_INCR
+
+/* @Section 4.13: MutableView Methods */
+/* ------------------------------------------------------------------------ */
+#ifndef XYJSON_DISABLE_MUTABLE
+
+namespace util
 {
-    return iterator(static_cast<size_t>(startIndex));
-}
 
-inline MutableObjectIterator MutableValue::iterator(const char* startKey) const
+/// Child of container by JSON Pointer token, array index in plain digits.
+inline yyjson_val* pointerChild(yyjson_val* val, const std::string& token)
 {
-    if (yyjson_likely(isObject())) {
-        MutableObjectIterator iter(m_val, m_doc);
-        if (yyjson_likely(startKey == nullptr || *startKey == '\0')) return iter;
-        return iter.advance(startKey);
+    if (yyjson_is_obj(val)) {
+        return yyjson_obj_getn(val, token.data(), token.size());
     }
-    return MutableObjectIterator();
+    if (!yyjson_is_arr(val) || token.empty() || (token.size() > 1 && token[0] == '0')) {
+        return nullptr;
+    }
+    size_t idx = 0;
+    for (char c : token) {
+        if (c < '0' || c > '9') return nullptr;
+        idx = idx * 10 + (c - '0');
+    }
+    return yyjson_arr_get(val, idx);
 }
 
-inline MutableArrayIterator MutableValue::iterator(EmptyArray) const
+} /* end of namespace yyjson::util */
+
+inline MutableView::Patch* MutableView::Patch::find(const std::string& name) const
 {
-    return yyjson_likely(isArray()) ? iterator(size_t(0)) : MutableArrayIterator();
+    for (auto& child : children) {
+        if (child->token == name) return child.get();
+    }
+    return nullptr;
 }
 
-inline MutableObjectIterator MutableValue::iterator(EmptyObject) const
+inline MutableView::Patch* MutableView::Patch::add(const std::string& name, yyjson_val* val)
 {
-    return yyjson_likely(isObject()) ? iterator(nullptr) : MutableObjectIterator();
+    children.emplace_back(new Patch);
+    Patch* child = children.back().get();
+    child->token = name;
+    child->origin = val;
+    return child;
 }
 
-inline MutableArrayIterator MutableValue::beginArray() const
+inline void MutableView::Patch::reset(yyjson_mut_val* val)
 {
-    return iterator(size_t(0));
+    value = val;
+    removed = false;
+    children.clear();
+    appended.clear();
 }
 
-inline MutableArrayIterator MutableValue::endArray() const
+inline bool MutableView::Patch::isModified() const
 {
-    return beginArray().end();
+    if (value || removed || !appended.empty()) return true;
+    for (auto& child : children) {
+        if (child->isModified()) return true;
+    }
+    return false;
 }
 
-inline MutableObjectIterator MutableValue::beginObject() const
+inline MutableView::MutableView(const Document& doc)
+    : m_origin(&doc), m_edit(yyjson_mut_doc_new(nullptr)), m_root(new Patch)
 {
-    return iterator((const char*)nullptr);
+    m_root->origin = yyjson_doc_get_root(doc.c_doc());
 }
 
-inline MutableObjectIterator MutableValue::endObject() const
+inline void MutableView::clear()
 {
-    return beginObject().end();
+    m_root->reset(nullptr);
+    m_edit = MutableDocument(yyjson_mut_doc_new(nullptr));
 }
 
-inline MutableArray MutableValue::array() const
+template <typename T>
+inline bool MutableView::set(const char* path, T&& value)
 {
-    return MutableArray(*this);
+    if (yyjson_unlikely(!path)) return false;
+    return setValue(path, ::strlen(path), util::create(m_edit.c_doc(), std::forward<T>(value)));
 }
 
-inline MutableObject MutableValue::object() const
+inline MutableView::Patch* MutableView::spine(const char* path, size_t len, size_t& pos, std::string& token)
 {
-    return MutableObject(*this);
+    Patch* node = m_root.get();
+    pos = 0;
+    for (;;)
+    {
+        // below a replaced subtree, the rest path is on mutable value
+        if (node->value) return node;
+        if (node->removed || pos >= len || path[pos] != '/') return nullptr;
+
+        const void* sep = ::memchr(path + pos + 1, '/', len - pos - 1);
+        size_t end = sep ? static_cast<const char*>(sep) - path : len;
+        token = util::pointerToken(path + pos + 1, end - pos - 1);
+        if (end == len) return node;
+
+        Patch* child = node->find(token);
+        if (!child) {
+            yyjson_val* val = util::pointerChild(node->origin, token);
+            if (!val) return nullptr;
+            child = node->add(token, val);
+        }
+        node = child;
+        pos = end;
+    }
 }
 
-/* @Group 4.3.7: others */
-/* ************************************************************************ */
-
-inline std::string MutableValue::toString(bool pretty) const
+inline bool MutableView::setValue(const char* path, size_t len, yyjson_mut_val* value)
 {
-    if (yyjson_unlikely(!isValid())) return "";
+    if (yyjson_unlikely(!value || !m_root->origin)) return false;
+    if (len == 0) {
+        m_root->reset(value);
+        return true;
+    }
 
-    if (isString() && !pretty) {
-        return std::string(yyjson_mut_get_str(m_val));
+    size_t pos = 0;
+    std::string token;
+    Patch* node = spine(path, len, pos, token);
+    if (yyjson_unlikely(!node)) return false;
+    if (node->value) {
+        return yyjson_mut_ptr_setx(node->value, path + pos, len - pos, value,
+            m_edit.c_doc(), false, nullptr, nullptr);
     }
 
-    uint32_t flags = YYJSON_WRITE_NOFLAG;
-    if (pretty) {
-        flags |= YYJSON_WRITE_PRETTY;
+    Patch* child = node->find(token);
+    if (!child) {
+        yyjson_val* val = util::pointerChild(node->origin, token);
+        if (!val) {
+            if (yyjson_is_arr(node->origin) && token == "-") {
+                node->appended.push_back(value);
+                return true;
+            }
+            if (!yyjson_is_obj(node->origin)) return false;
+        }
+        child = node->add(token, val);
+        if (!val) child->key = util::create(m_edit.c_doc(), token);
     }
+    child->reset(value);
+    return true;
+}
 
-    size_t len = 0;
-    char* json_str = yyjson_mut_val_write(m_val, flags, &len);
-    if (yyjson_unlikely(!json_str)) return "";
+inline bool MutableView::remove(const char* path, size_t len/* = 0*/)
+{
+    if (len == 0 && path) len = ::strlen(path);
+    if (yyjson_unlikely(!path || len == 0 || !m_root->origin)) return false;
 
-    std::string result(json_str, len);
-    free(json_str);
-    return result;
+    size_t pos = 0;
+    std::string token;
+    Patch* node = spine(path, len, pos, token);
+    if (yyjson_unlikely(!node)) return false;
+    if (node->value) {
+        return yyjson_mut_ptr_removex(node->value, path + pos, len - pos, nullptr, nullptr) != nullptr;
+    }
+
+    Patch* child = node->find(token);
+    if (child && !child->origin) {
+        // added member, just forget it
+        for (auto it = node->children.begin(); it != node->children.end(); ++it) {
+            if (it->get() == child) { node->children.erase(it); break; }
+        }
+        return true;
+    }
+    if (!child) {
+        yyjson_val* val = util::pointerChild(node->origin, token);
+        if (!val) return false;
+        child = node->add(token, val);
+    }
+    if (child->removed) return false;
+    child->reset(nullptr);
+    child->removed = true;
+    return true;
 }
 
-inline int MutableValue::toInteger() const
+inline bool MutableView::writePatch(const Patch& patch, std::string& output) const
 {
-    if (yyjson_unlikely(!isValid())) return 0;
-    if (isArray() || isObject())
+    if (patch.value) return util::appendJson(output, patch.value);
+    yyjson_val* val = patch.origin;
+    if (patch.children.empty() && patch.appended.empty()) {
+        return util::appendJson(output, val);
+    }
+
+    bool first = true;
+    auto comma = [&]() { if (!first) output.push_back(','); first = false; };
+    if (yyjson_is_obj(val))
     {
-        return static_cast<int>(size());
+        output.push_back('{');
+        yyjson_obj_iter iter;
+        yyjson_obj_iter_init(val, &iter);
+        yyjson_val* key = nullptr;
+        while ((key = yyjson_obj_iter_next(&iter))) {
+            const Patch* child = nullptr;
+            size_t klen = yyjson_get_len(key);
+            for (auto& item : patch.children) {
+                if (item->origin && item->token.size() == klen &&
+                    ::memcmp(item->token.data(), yyjson_get_str(key), klen) == 0) {
+                    child = item.get();
+                    break;
+                }
+            }
+            if (child && child->removed) continue;
+            comma();
+            util::appendJson(output, key);
+            output.push_back(':');
+            if (!(child ? writePatch(*child, output)
+                        : util::appendJson(output, yyjson_obj_iter_get_val(key)))) {
+                return false;
+            }
+        }
+        for (auto& item : patch.children) {
+            if (item->origin || !item->value) continue;
+            comma();
+            util::appendJson(output, item->key);
+            output.push_back(':');
+            if (!util::appendJson(output, item->value)) return false;
+        }
+        output.push_back('}');
     }
-    return util::toIntegerCast(*this);
+    else
+    {
+        // merge patches sorted by index with the items
+        std::vector<std::pair<size_t, const Patch*>> patches;
+        for (auto& item : patch.children) {
+            patches.emplace_back(std::strtoul(item->token.c_str(), nullptr, 10), item.get());
+        }
+        std::sort(patches.begin(), patches.end());
+
+        output.push_back('[');
+        size_t next = 0;
+        yyjson_arr_iter iter;
+        yyjson_arr_iter_init(val, &iter);
+        yyjson_val* item = nullptr;
+        for (size_t idx = 0; (item = yyjson_arr_iter_next(&iter)); ++idx) {
+            const Patch* child = nullptr;
+            if (next < patches.size() && patches[next].first == idx) {
+                child = patches[next++].second;
+            }
+            if (child && child->removed) continue;
+            comma();
+            if (!(child ? writePatch(*child, output) : util::appendJson(output, item))) {
+                return false;
+            }
+        }
+        for (yyjson_mut_val* added : patch.appended) {
+            comma();
+            if (!util::appendJson(output, added)) return false;
+        }
+        output.push_back(']');
+    }
+    return true;
 }
 
-inline double MutableValue::toNumber() const
+inline bool MutableView::write(std::string& output) const
 {
-    return yyjson_mut_get_num(m_val);
+    output.clear();
+    if (yyjson_unlikely(!m_root->origin || m_root->removed)) return false;
+    return writePatch(*m_root, output);
 }
 
-inline bool MutableValue::equal(const MutableValue& other) const
+inline std::string MutableView::toString() const
 {
-    return (m_val == other.m_val) || yyjson_mut_equals(m_val, other.m_val);
+    std::string output;
+    write(output);
+    return output;
 }
 
-inline bool MutableValue::less(const MutableValue& other) const
-{
-    return util::lessCompare(*this, other);
-}
+#endif // XYJSON_DISABLE_MUTABLE
 
-/* @Section 4.4: MutableDocument Methods */
+/* @Section 4.14: OnDemandDocument Methods */
 /* ------------------------------------------------------------------------ */
 
-/* @Group 4.4.1: primary manage */
-/* ************************************************************************ */
-
-inline MutableDocument::MutableDocument(yyjson_mut_doc* doc) : m_doc(doc)
+// The raw text and values parsed from it, stable while document moved.
+struct OnDemandDocument::State
 {
-}
+    static constexpr size_t kArena = 16 * 1024; //< leaves parsed without heap
 
-inline MutableDocument::MutableDocument(const char* str, size_t len/* = 0*/)
+    std::string text;
+    ParseSession session; //< destroyed after the parsed documents
+    std::unordered_map<size_t, Document> parsed; //< by offset in text
+
+    const char* end() const { return text.data() + text.size(); }
+    Value parse(const char* pos);
+};
+
+inline Value OnDemandDocument::State::parse(const char* pos)
 {
-    if (len == 0 && str) len = strlen(str);
-    yyjson_doc* doc = yyjson_read(str, len, 0);
-    if (yyjson_likely(doc)) {
-        m_doc = yyjson_doc_mut_copy(doc, nullptr);
-        yyjson_doc_free(doc);
-    } else {
-        m_doc = nullptr;
-    }
+    size_t offset = pos - text.data();
+    auto it = parsed.find(offset);
+    if (it != parsed.end()) return it->second.root();
+
+    const char* stop = util::skipValue(pos, end());
+    if (yyjson_unlikely(stop == nullptr)) return Value();
+    // the arena is recycled only when all documents freed
+    if (parsed.empty()) session.reserve(kArena);
+    Document doc = session.parse(pos, stop - pos);
+    if (yyjson_unlikely(!doc)) return Value();
+    return parsed.emplace(offset, std::move(doc)).first->second.root();
 }
 
-inline MutableDocument::MutableDocument(const Document& other)
+inline OnDemandDocument::OnDemandDocument() {}
+
+inline OnDemandDocument::OnDemandDocument(const char* str, size_t len /*= 0*/)
 {
-    *this = other.mutate();
+    read(str, len);
 }
 
-inline void MutableDocument::free()
+inline OnDemandDocument::OnDemandDocument(const std::string& str)
 {
-    if (yyjson_likely(m_doc))
-    {
-        yyjson_mut_doc_free(m_doc);
-        m_doc = nullptr;
-    }
+    read(str);
 }
 
-// Convert mutable document to read-only document
-inline Document MutableDocument::freeze() const
+inline OnDemandDocument::OnDemandDocument(std::string&& str)
 {
-    if (yyjson_unlikely(!isValid())) {
-        return Document((yyjson_doc*)nullptr);
-    }
-    
-    yyjson_doc* doc = yyjson_mut_doc_imut_copy(m_doc, nullptr);
-    return Document(doc);
+    read(std::move(str));
 }
 
-inline void MutableDocument::setRoot(MutableValue val)
+inline OnDemandDocument::~OnDemandDocument() {}
+
+inline OnDemandDocument::OnDemandDocument(OnDemandDocument&& other) noexcept = default;
+inline OnDemandDocument& OnDemandDocument::operator=(OnDemandDocument&& other) noexcept = default;
+
+inline bool OnDemandDocument::read(const char* str, size_t len /*= 0*/)
 {
-    if (yyjson_likely(m_doc))
-    {
-        yyjson_mut_doc_set_root(m_doc, val.get());
+    if (yyjson_unlikely(str == nullptr)) {
+        free();
+        return false;
     }
+    if (len == 0) len = ::strlen(str);
+    return read(std::string(str, len));
 }
 
-/* @Group 4.4.2: read and write */
-/* ************************************************************************ */
-
-inline bool MutableDocument::read(const char* str, size_t len)
+inline bool OnDemandDocument::read(std::string&& str)
 {
-    free();
-    
-    if (len == 0 && str) len = strlen(str);
-    yyjson_doc* doc = yyjson_read(str, len, 0);
-    if (doc != nullptr)
-    {
-        m_doc = yyjson_doc_mut_copy(doc, nullptr);
-        yyjson_doc_free(doc);
+    if (!m_state) m_state.reset(new State);
+    m_state->parsed.clear();
+    m_state->text = std::move(str);
+    const char* pos = util::skipSpace(m_state->text.data(), m_state->end());
+    if (yyjson_unlikely(pos >= m_state->end())) {
+        free();
+        return false;
     }
-    
-    return isValid();
+    return true;
 }
 
-inline bool MutableDocument::read(FILE* fp)
+inline void OnDemandDocument::free()
 {
-    free();
-    
-    if (yyjson_unlikely(!fp)) return false;
-    yyjson_doc* doc = yyjson_read_fp(fp, 0, nullptr, nullptr);
-    if (doc != nullptr)
-    {
-        m_doc = yyjson_doc_mut_copy(doc, nullptr);
-        yyjson_doc_free(doc);
-    }
-    
-    return isValid();
+    m_state.reset();
 }
 
-inline bool MutableDocument::read(std::ifstream& ifs)
+inline OnDemandValue OnDemandDocument::root() const
 {
-    // Check if stream is in a valid state before any operations
-    if (yyjson_unlikely(!ifs.good())) return false;
-    
-    ifs.seekg(0, std::ios::end);
-    std::streampos pos = ifs.tellg();
-    
-    // Check if tellg() failed (returns -1 for invalid files)
-    if (pos == -1) return false;
-    
-    size_t size = static_cast<size_t>(pos);
-    ifs.seekg(0, std::ios::beg);
-    
-    if (size == 0) return false;
-    
-    std::string content(size, '\0');
-    ifs.read(&content[0], size);
-    
-    return read(content);
+    if (yyjson_unlikely(!m_state)) return OnDemandValue();
+    const char* pos = util::skipSpace(m_state->text.data(), m_state->end());
+    return OnDemandValue(pos, m_state.get());
 }
 
-inline bool MutableDocument::readFile(const char* path)
+template <typename T>
+inline OnDemandValue OnDemandDocument::operator[](T&& index) const
 {
-    if (yyjson_unlikely(!path)) return false;
-    FILE* fp = fopen(path, "rb");
-    if (yyjson_unlikely(!fp)) return false;
+    return root().index(std::forward<T>(index));
+}
 
-    bool result = read(fp);
-    fclose(fp);
-    return result;
+inline size_t OnDemandDocument::parsedCount() const
+{
+    return m_state ? m_state->parsed.size() : 0;
 }
 
-inline bool MutableDocument::write(std::string& output) const
+inline bool OnDemandDocument::write(std::string& output, yyjson_write_flag flg /*= YYJSON_WRITE_NOFLAG*/) const
 {
-    if (yyjson_unlikely(!m_doc)) return false;
-    char* json = yyjson_mut_write(m_doc, 0, nullptr);
-    if (yyjson_unlikely(!json)) return false;
-    output = json;
-    std::free(json);
-    return true;
+    return root().value().write(output, flg);
 }
 
-inline bool MutableDocument::write(FILE* fp) const
+inline yyjson_type OnDemandValue::getType() const
 {
-    if (yyjson_unlikely(!m_doc || !fp)) return false;
-    return yyjson_mut_write_fp(fp, m_doc, 0, nullptr, nullptr);
+    if (isNull()) return YYJSON_TYPE_NULL;
+    if (isBool()) return YYJSON_TYPE_BOOL;
+    if (isString()) return YYJSON_TYPE_STR;
+    if (isArray()) return YYJSON_TYPE_ARR;
+    if (isObject()) return YYJSON_TYPE_OBJ;
+    return value().getType();
 }
 
-inline bool MutableDocument::write(std::ofstream& ofs) const
+inline size_t OnDemandValue::size() const
 {
-    std::string content;
-    if (yyjson_unlikely(!write(content))) return false;
-    
-    ofs.seekp(0, std::ios::beg);
-    ofs.write(content.c_str(), content.size());
-    ofs.flush();
-    
-    return !ofs.fail();
+    if (yyjson_unlikely(!isArray() && !isObject())) return 0;
+    return util::scanSize(m_pos, m_state->end());
 }
 
-inline bool MutableDocument::writeFile(const char* path) const
+inline OnDemandValue OnDemandValue::index(size_t idx) const
 {
-    if (yyjson_unlikely(!path)) return false;
-    FILE* fp = fopen(path, "wb");
-    if (yyjson_unlikely(!fp)) return false;
-    
-    bool result = write(fp);
-    fclose(fp);
-    return result;
+    if (yyjson_unlikely(!isArray())) return OnDemandValue();
+    const char* pos = util::scanIndex(m_pos, m_state->end(), idx);
+    return pos ? OnDemandValue(pos, m_state) : OnDemandValue();
 }
 
-/* @Group 4.4.3: create mutable value */
-/* ************************************************************************ */
+inline OnDemandValue OnDemandValue::index(const char* key, size_t len) const
+{
+    if (yyjson_unlikely(!isObject() || !key)) return OnDemandValue();
+    const char* pos = util::scanKey(m_pos, m_state->end(), key, len);
+    return pos ? OnDemandValue(pos, m_state) : OnDemandValue();
+}
 
-inline MutableValue MutableDocument::create(yyjson_mut_val* value) const
-{ 
-    if (yyjson_likely(value && m_doc))
+inline OnDemandValue OnDemandValue::pathto(const char* path, size_t len) const
+{
+    if (yyjson_unlikely(!path || len == 0)) return *this;
+    if (path[0] != '/') return index(path, len);
+
+    OnDemandValue result = *this;
+    const char* end = path + len;
+    for (const char* token = path; result && token < end; )
     {
-        return MutableValue(value, m_doc); 
+        const char* next = static_cast<const char*>(::memchr(token + 1, '/', end - token - 1));
+        if (next == nullptr) next = end;
+        std::string name = util::pointerToken(token + 1, next - token - 1);
+        if (result.isArray()) {
+            if (name.empty() || (name.size() > 1 && name[0] == '0')) return OnDemandValue();
+            size_t idx = 0;
+            for (char c : name) {
+                if (c < '0' || c > '9') return OnDemandValue();
+                idx = idx * 10 + (c - '0');
+            }
+            result = result.index(idx);
+        }
+        else {
+            result = result.index(name);
+        }
+        token = next;
     }
-    return MutableValue(nullptr, m_doc);
+    return result;
 }
 
-inline MutableValue MutableDocument::create() const
-{ 
-    return create(yyjson_mut_null(m_doc)); 
+inline std::string OnDemandValue::raw() const
+{
+    if (yyjson_unlikely(!m_pos)) return std::string();
+    const char* stop = util::skipValue(m_pos, m_state->end());
+    return stop ? std::string(m_pos, stop - m_pos) : std::string();
 }
 
-template <typename T>
-inline MutableValue MutableDocument::create(T&& value) const
+inline Value OnDemandValue::value() const
 {
-    return create(util::create(m_doc, std::forward<T>(value)));
+    if (yyjson_unlikely(!m_pos)) return Value();
+    return m_state->parse(m_pos);
 }
 
-#endif // XYJSON_DISABLE_MUTABLE
-
-/* @Section 4.5: ArrayIterator Methods */
+/* @Section 4.15: Projection Methods */
 /* ------------------------------------------------------------------------ */
 
-inline ArrayIterator::ArrayIterator(yyjson_val* root) : m_arr(root)
+inline Projection::Projection(std::initializer_list<const char*> paths)
 {
-    if (yyjson_likely(root)) {
-        yyjson_arr_iter_init(root, &m_iter);
+    for (const char* path : paths) {
+        add(path);
     }
 }
 
-inline ArrayIterator& ArrayIterator::next()
+inline Projection::Projection(const std::vector<std::string>& paths)
 {
-    yyjson_arr_iter_next(&m_iter);
-    return *this;
+    for (auto& path : paths) {
+        add(path);
+    }
 }
 
-// Backward iteration is O(N) operation: reset to beginning and advance idx-1 steps
-inline ArrayIterator& ArrayIterator::prev()
+inline bool Projection::add(const char* path, size_t len/* = 0*/)
 {
-    if (yyjson_unlikely(m_iter.idx == 0)) {
-        return end(true);
+    if (yyjson_unlikely(!path)) return false;
+    if (len == 0) len = ::strlen(path);
+    if (yyjson_unlikely(len > 0 && path[0] != '/')) return false;
+
+    Node* node = &m_root;
+    const char* end = path + len;
+    for (const char* token = path; token < end && !node->keep; )
+    {
+        const char* next = static_cast<const char*>(::memchr(token + 1, '/', end - token - 1));
+        if (next == nullptr) next = end;
+        std::string name = util::pointerToken(token + 1, next - token - 1);
+        token = next;
+
+        auto it = std::find_if(node->children.begin(), node->children.end(),
+            [&name](const Node& child) { return child.name == name; });
+        if (it == node->children.end())
+        {
+            Node child;
+            child.any = name == "*";
+            if (!name.empty() && (name.size() == 1 || name[0] != '0')
+                && name.find_first_not_of("0123456789") == std::string::npos) {
+                child.index = static_cast<size_t>(std::stoull(name));
+            }
+            child.name = std::move(name);
+            node->children.push_back(std::move(child));
+            it = node->children.end() - 1;
+        }
+        node = &*it;
     }
-    size_t idx = m_iter.idx - 1;
-    return begin().advance(idx);
+
+    // keep whole subtree, which covers longer paths under it
+    node->keep = true;
+    node->children.clear();
+    return true;
 }
 
-inline ArrayIterator& ArrayIterator::begin()
+inline bool Projection::apply(const char* str, size_t len, std::string& output) const
 {
-    if (yyjson_likely(m_arr)) {
-        yyjson_arr_iter_init(m_arr, &m_iter);
-    }
-    return *this;
+    output.clear();
+    if (yyjson_unlikely(!str)) return false;
+    if (len == 0) len = ::strlen(str);
+
+    const char* end = str + len;
+    const char* p = util::skipSpace(str, end);
+    if (yyjson_unlikely(p >= end)) return false;
+    const char* stop = emit(p, end, Nodes(1, &m_root), output);
+    return stop != nullptr && util::skipSpace(stop, end) == end;
 }
 
-inline ArrayIterator& ArrayIterator::advance(size_t steps)
+// Copy the projected value at p, nothing for unexpected scalar.
+// Return the end of value in input, or null if malformed.
+inline const char* Projection::emit(const char* p, const char* end,
+    const Nodes& nodes, std::string& output) const
 {
-    for (size_t i = 0; i < steps && isValid(); i++) { 
-        next();
+    for (const Node* node : nodes) {
+        if (node->keep) {
+            const char* stop = util::skipValue(p, end);
+            if (yyjson_likely(stop != nullptr)) output.append(p, stop - p);
+            return stop;
+        }
     }
-    return *this;
+    if (*p == '{') return emitObject(p, end, nodes, output);
+    if (*p == '[') return emitArray(p, end, nodes, output);
+    return util::skipValue(p, end);
 }
 
+inline const char* Projection::emitObject(const char* p, const char* end,
+    const Nodes& nodes, std::string& output) const
+{
+    output.push_back('{');
+    p = util::skipSpace(p + 1, end);
+    bool first = true;
+    Nodes matched;
+    while (p < end && *p == '"')
+    {
+        const char* keyEnd = util::skipString(p, end);
+        if (yyjson_unlikely(keyEnd == nullptr)) return nullptr;
+        matched.clear();
+        for (const Node* node : nodes) {
+            for (const Node& child : node->children) {
+                if (child.any || util::rawKeyEqual(p + 1, keyEnd - 1, child.name.data(), child.name.size())) {
+                    matched.push_back(&child);
+                }
+            }
+        }
 
-/* @Section 4.6: ObjectIterator Methods */
-/* ------------------------------------------------------------------------ */
+        const char* q = util::skipSpace(keyEnd, end);
+        if (yyjson_unlikely(q >= end || *q != ':')) return nullptr;
+        q = util::skipSpace(q + 1, end);
+        if (matched.empty()) {
+            q = util::skipValue(q, end);
+        }
+        else {
+            // drop the member if nothing emitted
+            size_t mark = output.size();
+            if (!first) output.push_back(',');
+            output.append(p, keyEnd - p);
+            output.push_back(':');
+            size_t size = output.size();
+            q = emit(q, end, matched, output);
+            if (output.size() == size) output.resize(mark);
+            else first = false;
+        }
+        if (yyjson_unlikely(q == nullptr)) return nullptr;
 
-inline ObjectIterator::ObjectIterator(yyjson_val* root)
-{
-    if (yyjson_likely(root)) {
-        yyjson_obj_iter_init(root, &m_iter);
+        p = util::skipSpace(q, end);
+        if (p >= end || *p != ',') break;
+        p = util::skipSpace(p + 1, end);
     }
-}
 
-inline ObjectIterator& ObjectIterator::next()
-{
-    yyjson_obj_iter_next(&m_iter);
-    return *this;
+    if (yyjson_unlikely(p >= end || *p != '}')) return nullptr;
+    output.push_back('}');
+    return p + 1;
 }
 
-// Backward iteration is O(N) operation: reset to beginning and advance idx-1 steps
-inline ObjectIterator& ObjectIterator::prev()
+inline const char* Projection::emitArray(const char* p, const char* end,
+    const Nodes& nodes, std::string& output) const
 {
-    if (yyjson_unlikely(m_iter.idx == 0)) {
-        return end(true);
-    }
-    size_t idx = m_iter.idx - 1;
-    return begin().advance(idx);
-}
+    output.push_back('[');
+    p = util::skipSpace(p + 1, end);
+    bool first = true;
+    Nodes matched;
+    for (size_t i = 0; p < end && *p != ']'; ++i)
+    {
+        matched.clear();
+        for (const Node* node : nodes) {
+            for (const Node& child : node->children) {
+                if (child.any || child.index == i) matched.push_back(&child);
+            }
+        }
 
-inline ObjectIterator& ObjectIterator::begin()
-{
-    if (yyjson_likely(m_iter.obj)) {
-        yyjson_obj_iter_init(m_iter.obj, &m_iter);
+        const char* q = nullptr;
+        if (matched.empty()) {
+            q = util::skipValue(p, end);
+        }
+        else {
+            // null in place of unexpected scalar to keep positions
+            if (!first) output.push_back(',');
+            first = false;
+            size_t size = output.size();
+            q = emit(p, end, matched, output);
+            if (output.size() == size) output.append("null");
+        }
+        if (yyjson_unlikely(q == nullptr)) return nullptr;
+
+        p = util::skipSpace(q, end);
+        if (p >= end || *p != ',') break;
+        p = util::skipSpace(p + 1, end);
     }
-    return *this;
+
+    if (yyjson_unlikely(p >= end || *p != ']')) return nullptr;
+    output.push_back(']');
+    return p + 1;
 }
 
-inline ObjectIterator& ObjectIterator::advance(size_t steps)
+/* @Section 4.16: Validation Functions */
+/* ------------------------------------------------------------------------ */
+
+inline ValidateResult validate(const char* str, size_t len/* = 0*/, const ReadOptions& opt/* = ReadOptions()*/)
 {
-    for (size_t i = 0; i < steps && isValid(); i++) { 
-        next();
+    ValidateResult result;
+    if (yyjson_unlikely(!str)) {
+        result.code = YYJSON_READ_ERROR_INVALID_PARAMETER;
+        result.msg = "input data is null";
+    }
+    else {
+        if (len == 0) len = strlen(str);
+        result = util::Validator(str, len, opt.flag).run();
     }
-    return *this;
-}
 
-inline ObjectIterator& ObjectIterator::advance(const char* key)
-{
-    if (yyjson_unlikely(!key || !*key)) return *this;
-    
-    while (isValid()) {
-        const char* currentKey = name();
-        if (currentKey && ::strcmp(currentKey, key) == 0) {
-            break;
-        }
-        next();
+    if (opt.err) {
+        opt.err->code = result.code;
+        opt.err->msg = result.msg;
+        opt.err->pos = result.pos;
     }
-    return *this;
+    return result;
 }
 
-// ObjectIterator fast seek implementation using yyjson_obj_iter_getn
-inline Value ObjectIterator::seek(const char* key, size_t key_len)
+inline ValidateResult validate(const std::string& str, const ReadOptions& opt/* = ReadOptions()*/)
 {
-    yyjson_val* val = yyjson_obj_iter_getn(&m_iter, key, key_len);
-    return Value(val);
+    return validate(str.c_str(), str.size(), opt);
 }
 
-#ifndef XYJSON_DISABLE_MUTABLE
-/* @Section 4.7: MutableArrayIterator Methods */
+/* @Section 4.17: StreamWriter Methods */
 /* ------------------------------------------------------------------------ */
 
-inline MutableArrayIterator::MutableArrayIterator(yyjson_mut_val* root, yyjson_mut_doc* doc) : m_doc(doc)
+inline bool StreamWriter::write(const Value& val)
 {
-    if (yyjson_likely(root)) {
-        yyjson_mut_arr_iter_init(root, &m_iter);
-        if (yyjson_likely(m_iter.idx < m_iter.max)) {
-            m_iter.pre = (yyjson_mut_val*)m_iter.arr->uni.ptr;  // prev = tail element
-            m_iter.cur = m_iter.pre->next;                      // cur = first element
-        }
-    }
+    if (yyjson_unlikely(!val.isValid())) return false;
+    return finish(emit(val.c_val(), 0));
 }
 
-inline MutableArrayIterator& MutableArrayIterator::next()
+#ifndef XYJSON_DISABLE_MUTABLE
+inline bool StreamWriter::write(const MutableValue& val)
 {
-    if (yyjson_likely(m_iter.idx < m_iter.max)) {
-        m_iter.pre = m_iter.cur;          // current element becomes previous
-        m_iter.cur = m_iter.cur->next;    // advance to next element
-        m_iter.idx++;                     // increment index
-    }
-    return *this;
+    if (yyjson_unlikely(!val.isValid())) return false;
+    return finish(emit(val.c_val(), 0));
 }
+#endif
 
-// Backward iteration is O(N) operation: reset to beginning and advance idx-1 steps
-// If at beginning, move to fast end (circular linked list)
-inline MutableArrayIterator& MutableArrayIterator::prev()
+inline bool StreamWriter::finish(bool ok)
 {
-    if (yyjson_unlikely(m_iter.idx == 0)) {
-        return end();
-    }
-    size_t idx = m_iter.idx - 1;
-    return begin().advance(idx);
+    if (ok && (m_flag & YYJSON_WRITE_NEWLINE_AT_END)) ok = put('\n');
+    if (!ok) m_error = true;
+    return ok;
 }
 
-inline MutableArrayIterator& MutableArrayIterator::begin()
+inline bool StreamWriter::append(const char* str, size_t len)
 {
-    if (yyjson_likely(m_iter.arr)) {
-        yyjson_mut_arr_iter_init(m_iter.arr, &m_iter);
-        if (yyjson_likely(m_iter.idx < m_iter.max)) {
-            m_iter.pre = (yyjson_mut_val*)m_iter.arr->uni.ptr;  // prev = tail element
-            m_iter.cur = m_iter.pre->next;                      // cur = first element
-        }
-    }
-    return *this;
+    if (yyjson_unlikely(m_error)) return false;
+    m_size += len;
+    if (m_buffer.size() + len > kChunk && !flush()) return false;
+    if (len >= kChunk) return send(str, len);
+    if (m_buffer.capacity() < kChunk) m_buffer.reserve(kChunk);
+    m_buffer.append(str, len);
+    return true;
 }
 
-inline MutableArrayIterator& MutableArrayIterator::advance(size_t steps)
+inline bool StreamWriter::flush()
 {
-    for (size_t i = 0; i < steps && isValid(); i++) { 
-        next();
-    }
-    return *this;
+    if (m_buffer.empty()) return !m_error;
+    bool ok = send(m_buffer.data(), m_buffer.size());
+    m_buffer.clear();
+    return ok;
 }
 
-inline bool MutableArrayIterator::insert(yyjson_mut_val* val)
+inline bool StreamWriter::send(const char* str, size_t len)
 {
-    // allow idx == max to insert at the end
-    if (yyjson_unlikely(!val || !m_iter.arr || m_iter.idx > m_iter.max)) {
-        return false;
+    bool ok = true;
+    if (m_sb) {
+        ok = m_sb->sputn(str, static_cast<std::streamsize>(len)) == static_cast<std::streamsize>(len);
     }
-
-    if (m_iter.max == 0) {
-        // first element, form self-loop
-        val->next = val;
-        m_iter.pre = val;
-        m_iter.cur = val;
-        m_iter.arr->uni.ptr = val;
+    else if (m_fp) {
+        ok = ::fwrite(str, 1, len, m_fp) == len;
     }
-    else {
-        // insert before current element (iterator points to new element)
-        yyjson_mut_val *prev = m_iter.pre;
-        yyjson_mut_val *next = m_iter.cur;
-        prev->next = val;
-        val->next = next;
-        m_iter.cur = val;
-
-        // if inserting at the end, update arr->uni.ptr
-        if (m_iter.idx == m_iter.max) {
-            m_iter.arr->uni.ptr = val;
+#ifdef XYJSON_HAS_UNISTD
+    else if (m_fd >= 0) {
+        while (len > 0) {
+            ssize_t n = ::write(m_fd, str, len);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) { ok = false; break; }
+            str += n;
+            len -= static_cast<size_t>(n);
         }
     }
-    unsafe_yyjson_set_len(m_iter.arr, ++m_iter.max);
-    return true;
+#endif
+    else {
+        ok = false;
+    }
+    if (yyjson_unlikely(!ok)) m_error = true;
+    return ok;
 }
 
-template<typename T>
-inline bool MutableArrayIterator::insert(T&& value)
+inline bool StreamWriter::newline(size_t level)
 {
-    // Create value from template type and forward to native insert
-    yyjson_mut_val* val = util::create(m_doc, std::forward<T>(value));
-    return insert(val);
+    static const char spaces[] = "                                ";
+    if (!put('\n')) return false;
+    size_t width = level * ((m_flag & YYJSON_WRITE_PRETTY_TWO_SPACES) ? 2 : 4);
+    while (width > 0) {
+        size_t n = width < sizeof(spaces) - 1 ? width : sizeof(spaces) - 1;
+        if (!append(spaces, n)) return false;
+        width -= n;
+    }
+    return true;
 }
 
-/// Remove current element and return it
-inline MutableValue MutableArrayIterator::remove()
+template <typename valT>
+inline bool StreamWriter::emitSmall(valT* val, size_t level)
 {
-    yyjson_mut_val* removed_val = nullptr;
-    if (yyjson_likely(isValid() && m_iter.cur)) {
-        removed_val = m_iter.cur;
-
-        if (m_iter.max == 1) {
-            // remove the last element
-            m_iter.cur = nullptr;
-            m_iter.pre = nullptr;
-            m_iter.arr->uni.ptr = nullptr;
-        }
-        else {
-            // remove current element, let cur point to next element
-            m_iter.pre->next = m_iter.cur->next;
-            m_iter.cur = m_iter.pre->next;
-        }
+    yyjson_alc alc = m_scratch.c_alc();
+    size_t len = 0;
+    char* json = util::writeValue(val, m_flag & ~YYJSON_WRITE_NEWLINE_AT_END, &alc, &len);
+    if (yyjson_unlikely(!m_scratch.commit(json, len))) return false;
+    if (!pretty() || level == 0) return append(m_scratch.data(), m_scratch.size());
 
-        m_iter.max--;
-        unsafe_yyjson_set_len(m_iter.arr, m_iter.max);
+    // nested lines of subtree are indented by its level
+    const char* p = m_scratch.data();
+    const char* end = p + m_scratch.size();
+    while (const char* eol = static_cast<const char*>(::memchr(p, '\n', end - p))) {
+        if (!append(p, eol - p) || !newline(level)) return false;
+        p = eol + 1;
     }
-    return MutableValue(removed_val, m_doc);
+    return append(p, end - p);
+}
+
+template <typename valT>
+inline bool StreamWriter::emit(valT* val, size_t level)
+{
+    if (util::isSmallTree(val, kSmallValues)) return emitSmall(val, level);
+
+    bool isObject = unsafe_yyjson_get_type(val) == YYJSON_TYPE_OBJ;
+    if (!put(isObject ? '{' : '[')) return false;
+    bool first = true;
+    bool ok = util::walkChildren(val, [&](valT* key, valT* child) {
+        if (!first && !put(',')) return false;
+        first = false;
+        return emitMember(key, child, level + 1);
+    });
+    if (!ok || (pretty() && !newline(level))) return false;
+    return put(isObject ? '}' : ']');
 }
 
+template <typename valT>
+inline bool StreamWriter::emitMember(valT* key, valT* child, size_t level)
+{
+    if (pretty() && !newline(level)) return false;
+    if (key) {
+        if (!emitSmall(key, level)) return false;
+        if (!(pretty() ? append(": ", 2) : put(':'))) return false;
+    }
+    return emit(child, level);
+}
 
-/* @Section 4.8: MutableObjectIterator Methods */
+/* @Section 4.18: JsonWriter Methods */
 /* ------------------------------------------------------------------------ */
 
-inline MutableObjectIterator::MutableObjectIterator(yyjson_mut_val* root, yyjson_mut_doc* doc) : m_doc(doc)
+inline void JsonWriter::clear()
 {
-    if (yyjson_likely(root)) {
-        yyjson_mut_obj_iter_init(root, &m_iter);
-        if (yyjson_likely(m_iter.idx < m_iter.max)) {
-            m_iter.pre = (yyjson_mut_val*)m_iter.obj->uni.ptr;  // prev = tail key
-            m_iter.cur = m_iter.pre->next->next;                // cur = first key
-        }
-    }
+    m_out.clear();
+    m_stack.clear();
+    m_first = true;
+    m_hasKey = false;
+    m_done = false;
+    m_error = false;
 }
 
-inline MutableObjectIterator& MutableObjectIterator::next()
+inline std::string JsonWriter::release()
 {
-    // directly operate on pointers, advance by two steps (key->val->next key)
-    if (yyjson_likely(m_iter.idx < m_iter.max)) {
-        m_iter.pre = m_iter.cur;                   // current key becomes previous
-        m_iter.cur = m_iter.cur->next->next;       // advance to next key (skip value)
-        m_iter.idx++;                              // increment index
+    std::string output = std::move(m_out);
+    clear();
+    return output;
+}
+
+inline bool JsonWriter::beforeValue()
+{
+    if (yyjson_unlikely(m_error)) return false;
+    if (m_stack.empty()) {
+        // only one root value
+        if (yyjson_unlikely(m_done)) m_error = true;
+        return !m_error;
     }
-    return *this;
+    if (m_stack.back() == '{') {
+        if (yyjson_unlikely(!m_hasKey)) {
+            m_error = true;
+            return false;
+        }
+        m_hasKey = false;
+        return true;
+    }
+    if (!m_first) m_out.push_back(',');
+    m_first = false;
+    return true;
 }
 
-// Backward iteration is O(N) operation: reset to beginning and advance idx-1 steps
-// If at beginning, move to fast end (circular linked list)
-inline MutableObjectIterator& MutableObjectIterator::prev()
+inline bool JsonWriter::beforeKey()
 {
-    if (yyjson_unlikely(m_iter.idx == 0)) {
-        return end();
+    if (yyjson_unlikely(m_error)) return false;
+    if (yyjson_unlikely(m_stack.empty() || m_stack.back() != '{' || m_hasKey)) {
+        m_error = true;
+        return false;
     }
-    size_t idx = m_iter.idx - 1;
-    return begin().advance(idx);
+    if (!m_first) m_out.push_back(',');
+    m_first = false;
+    m_hasKey = true;
+    return true;
 }
 
-inline MutableObjectIterator& MutableObjectIterator::begin()
+inline JsonWriter& JsonWriter::beginObject()
 {
-    if (yyjson_likely(m_iter.obj)) {
-        yyjson_mut_obj_iter_init(m_iter.obj, &m_iter);
-        if (yyjson_likely(m_iter.idx < m_iter.max)) {
-            m_iter.pre = (yyjson_mut_val*)m_iter.obj->uni.ptr;  // prev = tail key
-            m_iter.cur = m_iter.pre->next->next;                // cur = first key
-        }
+    if (beforeValue()) {
+        m_stack.push_back('{');
+        m_out.push_back('{');
+        m_first = true;
     }
     return *this;
 }
 
-inline MutableObjectIterator& MutableObjectIterator::advance(size_t steps)
+inline JsonWriter& JsonWriter::beginArray()
 {
-    for (size_t i = 0; i < steps && isValid(); i++) { 
-        next();
+    if (beforeValue()) {
+        m_stack.push_back('[');
+        m_out.push_back('[');
+        m_first = true;
     }
     return *this;
 }
 
-inline MutableObjectIterator& MutableObjectIterator::advance(const char* key)
+inline JsonWriter& JsonWriter::end()
 {
-    if (yyjson_unlikely(!key || !*key)) return *this;
-    
-    while (isValid()) {
-        const char* currentKey = name();
-        if (currentKey && ::strcmp(currentKey, key) == 0) {
-            break;
-        }
-        next();
+    if (yyjson_unlikely(m_error)) return *this;
+    if (yyjson_unlikely(m_stack.empty() || m_hasKey)) {
+        m_error = true;
+        return *this;
     }
+    m_out.push_back(m_stack.back() == '{' ? '}' : ']');
+    m_stack.pop_back();
+    m_first = false;
+    afterValue();
     return *this;
 }
 
-// MutableObjectIterator fast seek implementation using yyjson_mut_obj_iter_getn
-inline MutableValue MutableObjectIterator::seek(const char* key, size_t key_len)
+inline JsonWriter& JsonWriter::key(const char* str, size_t len)
 {
-    // adapt from yyjson_mut_obj_iter_getn to our iterator semantics
-    if (yyjson_unlikely(!key || key_len == 0 || m_iter.max == 0)) {
-        return MutableValue();
+    if (yyjson_unlikely(!str)) {
+        m_error = true;
+        return *this;
     }
-
-    yyjson_mut_val* cur = m_iter.cur;
-    yyjson_mut_val* pre = m_iter.pre;
-
-    for (size_t i = 0; i < m_iter.max; ++i) {
-        if (unsafe_yyjson_equals_strn(cur, key, key_len)) {
-            m_iter.pre = cur;
-            m_iter.cur = cur->next->next;
-            m_iter.idx += i + 1;
-            if (yyjson_unlikely(m_iter.idx > m_iter.max)) {
-                m_iter.idx -= m_iter.max;  // wrap around
-            }
-            return MutableValue(cur->next, m_doc);
-        }
-        pre = cur;
-        cur = cur->next->next;
+    if (beforeKey()) {
+        appendString(str, len);
+        m_out.push_back(':');
     }
-
-    return MutableValue();  // not found
+    return *this;
 }
 
-// MutableObjectIterator insert implementation
-inline bool MutableObjectIterator::insert(yyjson_mut_val* key, yyjson_mut_val* val)
+template <typename K>
+inline JsonWriter& JsonWriter::key(K&& name)
 {
-    if (yyjson_unlikely(!key || !val || !m_iter.obj)) {
-        return false;
+    using type = std::decay_t<K>;
+    if constexpr (std::is_same<type, std::string>::value || std::is_same<type, std::string_view>::value) {
+        return key(name.data(), name.size());
     }
-
-    // Insert new key-value pair at current iterator position
-    // The structure is: ... -> pre_key -> pre_val -> (key -> val) -> cur_key -> cur_val -> ...
-
-    if (m_iter.max == 0) { // insert the first kv
-        key->next = val;
-        val->next = key;  // Close the circle: key -> val -> key
-        m_iter.cur = key;
-        m_iter.obj->uni.ptr = key;  // Update object tail pointer (last key)
+    else if constexpr (std::is_array<std::remove_reference_t<K>>::value && trait::is_cstr_type<K>()) {
+        // string literal, as index(const char(&)[N]), never null
+        return key(name, std::extent<std::remove_reference_t<K>>::value - 1);
     }
     else {
-        yyjson_mut_val* prev_key = m_iter.pre;
-        yyjson_mut_val* prev_val = prev_key->next;
-        prev_val->next = key;
-        key->next = val;
-        val->next = m_iter.cur;
-        m_iter.cur = key;
-
-        if (m_iter.idx == m_iter.max) { // insert at the end
-            m_iter.obj->uni.ptr = key;  // keep obj point to end key
-        }
+        static_assert(trait::is_cstr_type<K>(), "key of JsonWriter should be string");
+        return key(name, name ? ::strlen(name) : 0);
     }
-
-    m_iter.max++;
-    unsafe_yyjson_set_len(m_iter.obj, m_iter.max);
-    return true;
 }
 
-template<typename K, typename V>
-inline bool MutableObjectIterator::insert(K&& key, V&& value)
+inline JsonWriter& JsonWriter::value(const char* str, size_t len)
 {
-    // Create key and value from template types
-    yyjson_mut_val* key_val = util::createKey(m_doc, std::forward<K>(key));
-    yyjson_mut_val* value_val = util::create(m_doc, std::forward<V>(value));
-    return insert(key_val, value_val);
+    if (beforeValue()) {
+        appendString(str, len);
+        afterValue();
+    }
+    return *this;
 }
 
-inline bool MutableObjectIterator::insert(KeyValue&& kv_pair)
+template <typename T>
+inline JsonWriter& JsonWriter::value(T&& val)
 {
-    bool result = insert(kv_pair.key, kv_pair.value);
-    if (yyjson_likely(result)) {
-        kv_pair.key = nullptr;
-        kv_pair.value = nullptr;
+    using type = std::decay_t<T>;
+    if constexpr (std::is_same<type, std::string>::value || std::is_same<type, std::string_view>::value) {
+        return value(val.data(), val.size());
     }
-    return result;
+    else if constexpr (std::is_array<std::remove_reference_t<T>>::value && trait::is_cstr_type<T>()) {
+        return value(val, std::extent<std::remove_reference_t<T>>::value - 1);
+    }
+    else if constexpr (trait::is_cstr_type<T>()) {
+        if (val) return value(val, ::strlen(val));
+        return value(nullptr);
+    }
+    else if constexpr (std::is_base_of<Document, type>::value || std::is_same<type, MutableDocument>::value) {
+        return value(val.root());
+    }
+    else {
+        if (!beforeValue()) return *this;
+        if constexpr (std::is_same<type, std::nullptr_t>::value) {
+            m_out.append("null", 4);
+        }
+        else if constexpr (std::is_same<type, bool>::value) {
+            if (val) m_out.append("true", 4);
+            else m_out.append("false", 5);
+        }
+        else if constexpr (std::is_integral<type>::value) {
+            appendInteger(val);
+        }
+        else if constexpr (std::is_floating_point<type>::value) {
+            appendReal(static_cast<double>(val));
+        }
+        else if constexpr (std::is_same<type, EmptyArray>::value) {
+            m_out.append("[]", 2);
+        }
+        else if constexpr (std::is_same<type, EmptyObject>::value) {
+            m_out.append("{}", 2);
+        }
+        else if constexpr (std::is_same<type, EmptyString>::value) {
+            m_out.append("\"\"", 2);
+        }
+        else if constexpr (std::is_same<type, ZeroNumber>::value) {
+            m_out.push_back('0');
+        }
+        else if constexpr (std::is_base_of<Value, type>::value || std::is_base_of<MutableValue, type>::value) {
+            if (val.isValid()) appendJson(val.c_val());
+            else m_out.append("null", 4);
+        }
+        else {
+            static_assert(!std::is_same<type, type>::value, "unsupported value type of JsonWriter");
+        }
+        afterValue();
+    }
+    return *this;
 }
 
-#ifndef XYJSON_DISABLE_CHAINED_INPUT
-// Chained insertion support: insertKey
-template<typename keyT>
-inline bool MutableObjectIterator::insertKey(keyT&& key)
+inline JsonWriter& JsonWriter::raw(const char* json, size_t len)
 {
-    m_pendingKey = util::createKey(m_doc, std::forward<keyT>(key));
-    return false;
+    if (beforeValue()) {
+        m_out.append(json, len);
+        afterValue();
+    }
+    return *this;
 }
 
-// Chained insertion support: insertValue
-template<typename valT>
-inline bool MutableObjectIterator::insertValue(valT&& value)
+template <typename T>
+inline JsonWriter& JsonWriter::push(T&& val)
 {
-    if (m_pendingKey == nullptr) {
-        return false;
+    using type = std::decay_t<T>;
+    if constexpr (IsMember<type>::value) {
+        return key(val.key).value(val.value);
     }
-    yyjson_mut_val* valueNode = util::create(m_doc, std::forward<valT>(value));
-    if (yyjson_unlikely(!valueNode)) {
-        return false;
+    else if constexpr (IsItem<type>::value) {
+        return value(val.value);
+    }
+    else {
+        if (!m_stack.empty() && m_stack.back() == '{' && !m_hasKey) {
+            if constexpr (trait::is_key_v<T> || std::is_same<type, std::string_view>::value) {
+                return key(std::forward<T>(val));
+            }
+            else {
+                m_error = true;
+                return *this;
+            }
+        }
+        return value(std::forward<T>(val));
     }
-    bool result = insert(m_pendingKey, valueNode);
-    m_pendingKey = nullptr;
-    return result;
-}
-
-// Insert method for chained insertion - handles key/value logic internally
-// Returns true if a value was inserted (meaning we should advance)
-// Returns false if a key was stored (meaning we should wait for value) or both failed
-template<typename T>
-inline bool MutableObjectIterator::insert(T&& arg)
-{
-    return insertValue(std::forward<T>(arg)) || insertKey(std::forward<T>(arg));
 }
-#endif
 
-// MutableObjectIterator remove implementation
-inline KeyValue MutableObjectIterator::remove()
+inline void JsonWriter::appendString(const char* str, size_t len)
 {
-    yyjson_mut_val* removed_key = nullptr;
-    yyjson_mut_val* removed_val = nullptr;
-
-    if (yyjson_likely(isValid() && m_iter.cur)) {
-        removed_key = m_iter.cur;
-        removed_val = m_iter.cur->next;
+    static const char hex[] = "0123456789ABCDEF";
+    constexpr uint64_t kOnes = 0x0101010101010101ULL;
+    constexpr uint64_t kHigh = 0x8080808080808080ULL;
 
-        if (m_iter.max == 1) {
-            // remove the last key-value pair
-            m_iter.cur = nullptr;
-            m_iter.pre = nullptr;
-            m_iter.obj->uni.ptr = nullptr;
+    m_out.push_back('"');
+    const char* p = str;
+    const char* end = str + len;
+    const char* run = p; //< plain bytes not copied yet
+    while (p < end)
+    {
+        // skip 8 bytes if none is quote, backslash or control char
+        if (end - p >= 8) {
+            uint64_t x;
+            ::memcpy(&x, p, 8);
+            uint64_t quote = x ^ (kOnes * '"');
+            uint64_t slash = x ^ (kOnes * '\\');
+            uint64_t mask = ((quote - kOnes) & ~quote) | ((slash - kOnes) & ~slash) | ((x - kOnes * 0x20) & ~x);
+            if ((mask & kHigh) == 0) {
+                p += 8;
+                continue;
+            }
         }
-        else {
-            // remove current key-value pair from circular linked list
-            // Kprev -> Vprev -> Kcur -> Vcur -> Knext -> Vnext -> ...
-            // becomes: Kprev -> Vprev -> Knext -> Vnext -> ...
-            yyjson_mut_val *key_prev = m_iter.pre;
-            yyjson_mut_val *val_prev = key_prev->next;
-            yyjson_mut_val *key_next = m_iter.cur->next->next;
-            val_prev->next = key_next;
 
-            // move iterator to next key
-            m_iter.cur = key_next;
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            ++p;
+            continue;
         }
-
-        m_iter.max--;
-        unsafe_yyjson_set_len(m_iter.obj, m_iter.max);
+        m_out.append(run, p - run);
+        switch (c)
+        {
+        case '"': m_out.append("\\\"", 2); break;
+        case '\\': m_out.append("\\\\", 2); break;
+        case '\b': m_out.append("\\b", 2); break;
+        case '\f': m_out.append("\\f", 2); break;
+        case '\n': m_out.append("\\n", 2); break;
+        case '\r': m_out.append("\\r", 2); break;
+        case '\t': m_out.append("\\t", 2); break;
+        default:
+            m_out.append("\\u00", 4);
+            m_out.push_back(hex[c >> 4]);
+            m_out.push_back(hex[c & 0xF]);
+            break;
+        }
+        run = ++p;
     }
-    return KeyValue(removed_key, removed_val);
+    m_out.append(run, p - run);
+    m_out.push_back('"');
 }
 
-#endif // XYJSON_DISABLE_MUTABLE
+template <typename T>
+inline void JsonWriter::appendInteger(T val)
+{
+    char buf[24];
+    std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), val);
+    m_out.append(buf, result.ptr - buf);
+}
+
+inline void JsonWriter::appendReal(double val)
+{
+    // format by yyjson on a value in stack, directly into output
+    yyjson_val num;
+    num.tag = YYJSON_TYPE_NUM | YYJSON_SUBTYPE_REAL;
+    num.uni.f64 = val;
+    util::StringSink sink(m_out, true);
+    yyjson_alc alc = sink.c_alc();
+    size_t len = 0;
+    char* json = yyjson_val_write_opts(&num, YYJSON_WRITE_INF_AND_NAN_AS_NULL, &alc, &len, nullptr);
+    if (yyjson_unlikely(!sink.commit(json, len))) m_out.append("null", 4);
+}
+
+template <typename V>
+inline void JsonWriter::appendJson(V* val)
+{
+    if (yyjson_unlikely(!util::appendJson(m_out, val))) m_error = true;
+}
 
 /* @Part 5: Operator Interface */
 /* ======================================================================== */
@@ -3688,11 +9499,22 @@ inline MutableDocument operator~(const Document& doc)
     return doc.mutate();
 }
 
+template <size_t N>
+inline MutableDocument operator~(const InlineDocument<N>& doc)
+{
+    return doc.mutate();
+}
+
 // `~doc` --> `doc.freeze()` : MutableDocument --> Document
 inline Document operator~(const MutableDocument& doc)
 {
     return doc.freeze();
 }
+
+inline Document operator~(MutableDocument&& doc)
+{
+    return std::move(doc).freeze();
+}
 #endif
 
 /* @Section 5.3: Comparison Operator */
@@ -3813,6 +9635,32 @@ inline KeyValue operator*(MutableValue&& key, MutableValue&& value)
 
 #endif // XYJSON_DISABLE_MUTABLE
 
+// `writer * value` --> value waiting for key, as `doc * value`
+template <typename T>
+inline JsonWriter::Item<std::decay_t<T>> operator*(JsonWriter& writer, T&& value)
+{
+    (void)writer;
+    return JsonWriter::Item<std::decay_t<T>>{std::forward<T>(value)};
+}
+
+// `writer * value * key` --> key and value written together by `<<`
+// the key moved in if a temporary string, so the member can be kept
+template <typename T, typename K>
+inline typename std::enable_if<trait::is_key_v<K>, JsonWriter::Member<T, JsonWriter::MemberKey<K>>>::type
+operator*(JsonWriter::Item<T>&& item, K&& key)
+{
+    using keyT = JsonWriter::MemberKey<K>;
+    return JsonWriter::Member<T, keyT>{keyT(std::forward<K>(key)), std::move(item.value)};
+}
+
+template <typename K, typename T>
+inline typename std::enable_if<trait::is_key_v<K>, JsonWriter::Member<T, JsonWriter::MemberKey<K>>>::type
+operator*(K&& key, JsonWriter::Item<T>&& item)
+{
+    using keyT = JsonWriter::MemberKey<K>;
+    return JsonWriter::Member<T, keyT>{keyT(std::forward<K>(key)), std::move(item.value)};
+}
+
 /* @Section 5.5: Stream and Input Operator */
 /* ------------------------------------------------------------------------ */
 
@@ -3832,12 +9680,20 @@ operator>>(const docT& doc, T& output)
     return doc.write(output);
 }
 
+// `writer << value` --> `writer.push(value)`
+template <typename T>
+inline JsonWriter& operator<<(JsonWriter& writer, T&& value)
+{
+    return writer.push(std::forward<T>(value));
+}
+
 // `std::ostream << json` --> output value as JSON string
 template<typename jsonT>
 inline typename std::enable_if<trait::is_value<jsonT>::value, std::ostream&>::type
 operator<<(std::ostream& os, const jsonT& json)
 {
-    return os << json.toString();
+    util::streamJson(os, json);
+    return os;
 }
 
 #ifndef XYJSON_DISABLE_MUTABLE
@@ -4141,4 +9997,36 @@ inline yyjson::Document operator""_xyjson(const char* jsonStr, std::size_t len)
 
 } /* end of namespace yyjson:: */
 
+/// Hash by json content, so that Value and Document can be unordered keys.
+namespace std
+{
+
+template <>
+struct hash<yyjson::Value>
+{
+    size_t operator()(const yyjson::Value& val) const noexcept { return static_cast<size_t>(val.hash()); }
+};
+
+template <>
+struct hash<yyjson::Document>
+{
+    size_t operator()(const yyjson::Document& doc) const noexcept { return static_cast<size_t>(doc.root().hash()); }
+};
+
+#ifndef XYJSON_DISABLE_MUTABLE
+template <>
+struct hash<yyjson::MutableValue>
+{
+    size_t operator()(const yyjson::MutableValue& val) const noexcept { return static_cast<size_t>(val.hash()); }
+};
+
+template <>
+struct hash<yyjson::MutableDocument>
+{
+    size_t operator()(const yyjson::MutableDocument& doc) const noexcept { return static_cast<size_t>(doc.root().hash()); }
+};
+#endif
+
+} /* end of namespace std */
+
 #endif /* end of include guard: XYJSON_H__ */
@@ -14,6 +14,7 @@
 using namespace yyjson;
 using perf::measurePerformance;
 using perf::relativePerformance;
+using perf::readFile;
 
 DEF_TAST(chained_deep_path, "深度链式访问对比")
 {
@@ -91,4 +92,58 @@ DEF_TAST(chained_parse_and_access, "解析+访问组合对比")
     );
     
     COUTF(passed, true);
+
+    // 大文档中只取少量字段，按需扫描跳过无关子树
+    std::string mediumText = readFile("perf/datasets/medium.json");
+    COUTF(mediumText.empty() == false, true);
+
+    passed = relativePerformance(
+        "xyjson on-demand access",
+        [&mediumText]() {
+            OnDemandDocument doc(mediumText.c_str(), mediumText.size());
+            std::string company = doc / "company" | "";
+            int salary = doc / "metrics" / "avg_salary" | 0;
+            std::string name = doc / "employees" / 2 / "name" | "";
+            COUTF(company.empty(), false);
+            COUTF(salary, 85000);
+            COUTF(name, "Employee 3");
+        },
+        "xyjson full parse access",
+        [&mediumText]() {
+            Document doc(mediumText);
+            std::string company = doc / "company" | "";
+            int salary = doc / "metrics" / "avg_salary" | 0;
+            std::string name = doc / "employees" / 2 / "name" | "";
+            COUTF(company.empty(), false);
+            COUTF(salary, 85000);
+            COUTF(name, "Employee 3");
+        },
+        1000
+    );
+
+    COUTF(passed, true);
+}
+
+DEF_TAST(chained_hash_value, "结构哈希与序列化后字符串哈希对比")
+{
+    std::string jsonText = readFile("perf/datasets/medium.json");
+    COUTF(jsonText.empty() == false, true);
+    Document doc(jsonText);
+    COUTF(doc.isValid(), true);
+
+    // 直接遍历连续存储的结点，无需序列化与分配
+    bool passed = relativePerformance(
+        "xyjson structural hash",
+        [&doc]() {
+            COUTF(doc.root().hash() != 0, true);
+        },
+        "xyjson toString and hash",
+        [&doc]() {
+            size_t hash = std::hash<std::string>()(doc.root().toString());
+            COUTF(hash != 0, true);
+        },
+        1000
+    );
+
+    COUTF(passed, true);
 }
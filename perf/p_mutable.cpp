@@ -343,3 +343,135 @@ DEF_TAST(mutable_object_1000, "可变对象构造对比(1000个属性)")
 
     COUTF(passed, true);
 }
+
+DEF_TAST(mutable_parse, "直接解析为可变文档与 yyjson 读后深拷贝对比")
+{
+    std::string jsonText = readFile("perf/datasets/medium.json");
+    COUTF(jsonText.empty() == false, true);
+
+    // xyjson 复用解析时的字符串池，只构建一次可变值链表
+    bool passed = relativePerformance(
+        "xyjson mutable parse",
+        [&jsonText]() {
+            MutableDocument doc(jsonText);
+            COUTF(doc.isValid(), true);
+        },
+        "yyjson read and mut copy",
+        [&jsonText]() {
+            yyjson_doc* idoc = yyjson_read(jsonText.c_str(), jsonText.size(), 0);
+            yyjson_mut_doc* doc = yyjson_doc_mut_copy(idoc, NULL);
+            yyjson_doc_free(idoc);
+            COUTF(doc != nullptr, true);
+            yyjson_mut_doc_free(doc);
+        },
+        1000
+    );
+
+    COUTF(passed, true);
+}
+
+DEF_TAST(mutable_write_buffer, "序列化到复用缓冲区与 yyjson_mut_write 后拷贝对比")
+{
+    std::string jsonText = readFile("perf/datasets/medium.json");
+    COUTF(jsonText.empty() == false, true);
+    MutableDocument doc(jsonText);
+    COUTF(doc.isValid(), true);
+
+    // 缓冲区跨调用复用，原地序列化，无 strlen 与拷贝
+    WriteBuffer buffer;
+    bool passed = relativePerformance(
+        "xyjson write buffer",
+        [&doc, &buffer]() {
+            COUTF(doc.write(buffer), true);
+        },
+        "yyjson mut write and copy",
+        [&doc]() {
+            std::string output;
+            size_t len = 0;
+            char* json = yyjson_mut_write(doc.c_doc(), 0, &len);
+            COUTF(json != nullptr, true);
+            output.assign(json, len);
+            free(json);
+        },
+        1000
+    );
+
+    COUTF(passed, true);
+}
+
+DEF_TAST(mutable_json_writer, "直接写出 json 文本与 yyjson 构建可变文档后序列化对比")
+{
+    // 不创建节点，键值直接转义格式化追加到复用的字符串
+    JsonWriter writer(64 * 1024);
+    bool passed = relativePerformance(
+        "xyjson json writer",
+        [&writer]() {
+            writer.clear();
+            writer.beginArray();
+            for (int i = 0; i < 500; ++i) {
+                auto item = writer.object();
+                writer << "id" << i << "name" << "item name" << "score" << i * 0.5 << "ok" << true;
+            }
+            writer.end();
+            COUTF(writer.isComplete(), true);
+        },
+        "yyjson mut build and write",
+        []() {
+            yyjson_mut_doc* doc = yyjson_mut_doc_new(NULL);
+            yyjson_mut_val* root = yyjson_mut_arr(doc);
+            yyjson_mut_doc_set_root(doc, root);
+            for (int i = 0; i < 500; ++i) {
+                yyjson_mut_val* item = yyjson_mut_arr_add_obj(doc, root);
+                yyjson_mut_obj_add_int(doc, item, "id", i);
+                yyjson_mut_obj_add_str(doc, item, "name", "item name");
+                yyjson_mut_obj_add_real(doc, item, "score", i * 0.5);
+                yyjson_mut_obj_add_bool(doc, item, "ok", true);
+            }
+            size_t len = 0;
+            char* json = yyjson_mut_write(doc, 0, &len);
+            COUTF(json != nullptr, true);
+            free(json);
+            yyjson_mut_doc_free(doc);
+        },
+        100
+    );
+
+    COUTF(passed, true);
+}
+
+DEF_TAST(mutable_parallel_write, "多线程序列化大文档与 yyjson_mut_write 对比")
+{
+    std::string jsonText = readFile("perf/datasets/large.json");
+    COUTF(jsonText.empty() == false, true);
+
+    // 以大文件为元素拼接成一个顶层大数组
+    std::string arrayText = "[";
+    for (int i = 0; i < 32; ++i) {
+        if (i > 0) arrayText += ",";
+        arrayText += jsonText;
+    }
+    arrayText += "]";
+    MutableDocument doc(arrayText);
+    COUTF(doc.root().size(), 32);
+
+    ParallelOptions opt;
+    opt.chunkSize = 256 * 1024;
+    ParallelWriter writer(opt);
+    std::string output;
+    bool passed = relativePerformance(
+        "xyjson parallel write",
+        [&doc, &writer, &output]() {
+            COUTF(writer.write(doc.root(), output), true);
+        },
+        "yyjson mut write",
+        [&doc]() {
+            size_t len = 0;
+            char* json = yyjson_mut_write(doc.c_doc(), 0, &len);
+            COUTF(json != nullptr, true);
+            free(json);
+        },
+        10
+    );
+
+    COUTF(passed, true);
+}
@@ -66,6 +66,62 @@ DEF_TAST(parse_medium, "解析中等文件对比")
     COUTF(passed, true);
 }
 
+DEF_TAST(parse_session, "复用 ParseSession 内存池解析对比")
+{
+    std::string jsonText = readFile("perf/datasets/small.json");
+    COUTF(jsonText.empty() == false, true);
+
+    ParseSession session;
+    bool passed = relativePerformance(
+        "xyjson session parse",
+        [&jsonText, &session]() {
+            Document doc = session.parse(jsonText);
+            COUTF(doc.isValid(), true);
+        },
+        "xyjson parse",
+        [&jsonText]() {
+            Document doc(jsonText);
+            COUTF(doc.isValid(), true);
+        },
+        10000
+    );
+
+    COUTF(passed, true);
+    COUTF(session.liveBlocks(), 0);
+}
+
+DEF_TAST(parse_many, "批量解析小文档共享内存与逐个解析对比")
+{
+    // 模拟一批 500 条小消息
+    std::vector<std::string> messages;
+    for (int i = 0; i < 500; ++i) {
+        messages.push_back("{\"id\":" + std::to_string(i)
+            + ",\"type\":\"click\",\"user\":{\"name\":\"u" + std::to_string(i) + "\"}}");
+    }
+    std::vector<std::string_view> views(messages.begin(), messages.end());
+
+    DocumentBatch batch;
+    bool passed = relativePerformance(
+        "xyjson parse many",
+        [&views, &batch]() {
+            size_t valid = batch.parse(views);
+            COUTF(valid, 500);
+        },
+        "xyjson parse loop",
+        [&views]() {
+            size_t valid = 0;
+            for (auto& view : views) {
+                Document doc(view.data(), view.size());
+                if (doc) valid++;
+            }
+            COUTF(valid, 500);
+        },
+        1000
+    );
+
+    COUTF(passed, true);
+}
+
 DEF_TAST(parse_large, "解析大文件对比")
 {
     std::string jsonText = readFile("perf/datasets/large.json");
@@ -91,6 +147,61 @@ DEF_TAST(parse_large, "解析大文件对比")
     COUTF(passed, true);
 }
 
+DEF_TAST(parse_validate, "只校验不建树与完整解析对比")
+{
+    std::string jsonText = readFile("perf/datasets/medium.json");
+    COUTF(jsonText.empty() == false, true);
+
+    bool passed = relativePerformance(
+        "xyjson validate",
+        [&jsonText]() {
+            ValidateResult result = validate(jsonText);
+            COUTF(result.isValid(), true);
+        },
+        "xyjson parse",
+        [&jsonText]() {
+            Document doc(jsonText);
+            COUTF(doc.isValid(), true);
+        },
+        1000
+    );
+
+    COUTF(passed, true);
+}
+
+DEF_TAST(parse_parallel_array, "多线程解析大数组与单线程解析对比")
+{
+    std::string jsonText = readFile("perf/datasets/large.json");
+    COUTF(jsonText.empty() == false, true);
+
+    // 以大文件为元素拼接成一个顶层大数组
+    std::string arrayText = "[";
+    for (int i = 0; i < 32; ++i) {
+        if (i > 0) arrayText += ",";
+        arrayText += jsonText;
+    }
+    arrayText += "]";
+
+    ParallelOptions opt;
+    opt.chunkSize = 256 * 1024;
+    ParallelParser parser(opt);
+    bool passed = relativePerformance(
+        "xyjson parallel array parse",
+        [&arrayText, &parser]() {
+            Document doc = parser.parseArray(arrayText);
+            COUTF(doc.root().size(), 32);
+        },
+        "xyjson parse",
+        [&arrayText]() {
+            Document doc(arrayText);
+            COUTF(doc.root().size(), 32);
+        },
+        10
+    );
+
+    COUTF(passed, true);
+}
+
 DEF_TAST(parse_file, "文件读取+解析对比")
 {
     bool passed = relativePerformance(
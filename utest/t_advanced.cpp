@@ -7,6 +7,8 @@
 #include "couttast/couttast.h"
 #include "xyjson.h"
 #include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 
 // Example functions for pipe functionality testing
 namespace {
@@ -627,6 +629,63 @@ DEF_TAST(advanced_sort_mixed_array, "sort a mixed array of json values")
     COUT(actual_str, expected_str);
 }
 
+DEF_TAST(advanced_hash_value, "structural hash of json values")
+{
+    using namespace yyjson;
+
+    DESC("equal values hash alike, key order ignored");
+    Document doc1(R"({"a":1,"b":[true,null,"x"],"c":{"d":1.5,"e":""}})");
+    Document doc2(R"({"c":{"e":"","d":1.5},"b":[true,null,"x"],"a":1})");
+    COUT(doc1 == doc2, true);
+    COUT(doc1.root().hash() == doc2.root().hash(), true);
+    COUT(doc1.root().hash(7) == doc1.root().hash(), false);
+
+    MutableDocument mut = doc2.mutate();
+    COUT(mut.root().hash() == doc1.root().hash(), true);
+    COUT((mut / "c").hash() == (doc1 / "c").hash(), true);
+    mut.root()["a"] = 2;
+    COUT(mut.root().hash() == doc1.root().hash(), false);
+
+    DESC("different structure or type hash differently");
+    const char* texts[] = {
+        "null", "true", "false", "0", "1", "-1", "1.0", "\"1\"", "\"\"", "[]", "{}",
+        "[1,2]", "[2,1]", "[[1],2]", "{\"a\":1}", "{\"a\":\"1\"}", "{\"b\":1}", "[\"a\",1]",
+    };
+    std::vector<uint64_t> hashes;
+    for (const char* text : texts) {
+        hashes.push_back(Document(text).root().hash());
+    }
+    std::sort(hashes.begin(), hashes.end());
+    COUT(std::unique(hashes.begin(), hashes.end()) == hashes.end(), true);
+
+    DESC("long strings and integer subtypes");
+    std::string longText(100, 'x');
+    MutableDocument num;
+    COUT(num.create(static_cast<int64_t>(5)).hash() == Document("5").root().hash(), true);
+    COUT(num.create(static_cast<int64_t>(-5)).hash() == Document("-5").root().hash(), true);
+    COUT(num.create(longText).hash() == Document("\"" + longText + "\"").root().hash(), true);
+    longText[99] = 'y';
+    COUT(num.create(longText).hash() == Document("\"" + std::string(100, 'x') + "\"").root().hash(), false);
+    COUT(Value().hash(), 0);
+
+    DESC("Value and Document as keys of unordered containers");
+    std::unordered_map<Value, int> counter;
+    Document list(R"([{"x":1,"y":2},{"y":2,"x":1},[1],{"x":1}])");
+    for (auto item : list.root().array()) {
+        counter[item]++;
+    }
+    COUT(counter.size(), 3);
+    COUT(counter[list / 1], 2);
+
+    std::unordered_set<Document> docs;
+    docs.insert(Document("[1,2]"));
+    docs.insert(Document(" [1, 2] "));
+    docs.insert(Document("[2,1]"));
+    COUT(docs.size(), 2);
+    COUT(docs.count(Document("[1,2]")), 1);
+    COUT(std::hash<MutableValue>()(mut.root()) == mut.root().hash(), true);
+}
+
 DEF_TAST(advanced_string_optimization, "test string creation optimization strategies")
 {
     using namespace yyjson;
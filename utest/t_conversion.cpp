@@ -755,3 +755,56 @@ DEF_TAST(conversion_explicit, "test explicit type conversion functions")
     MutableDocument mutDoc3 = (MutableDocument)doc;
     COUT(mutDoc3.hasError(), false);
 }
+
+DEF_TAST(conversion_raw_number, "test lazy number parsing with NUMBER_AS_RAW flag")
+{
+    std::string jsonText = R"({"int": 30, "neg": -5, "real": 2.5, "big": 123456789012345678901234567890})";
+
+    DESC("all numbers kept as raw string");
+    {
+        yyjson::Document doc(jsonText, yyjson::ReadOptions().numberAsRaw());
+        COUT(doc.isValid(), true);
+        COUT((doc / "int").isRaw(), true);
+        COUT((doc / "int").isNumber(), false);
+
+        // parsed on access as if read without the flag
+        COUT(doc / "int" | 0, 30);
+        COUT(doc / "neg" | int64_t(0), -5);
+        COUT(doc / "int" | uint64_t(0), 30);
+        COUT(doc / "real" | 0.0, 2.5);
+        COUT(doc / "int" | 0.0, 0.0);
+        COUT(doc / "int" | yyjson::kNumber, 30.0);
+        COUT((doc / "real").toNumber(), 2.5);
+        COUT((doc / "real").toInteger(), 2);
+        COUT((doc / "big").toNumber() > 1e29, true);
+
+        double real = 0;
+        COUT((doc / "real").get(real), true);
+        COUT(real, 2.5);
+
+        // compare as number with eager parsed value
+        yyjson::Document other(R"([10, 100])");
+        COUT(other / 0 < doc / "int", true);
+        COUT(doc / "int" < other / 1, true);
+        COUT(doc / "neg" < doc / "real", true);
+    }
+
+    DESC("only big numbers kept as raw string");
+    {
+        yyjson::Document doc(jsonText, yyjson::ReadOptions().bignumAsRaw());
+        COUT((doc / "int").isRaw(), false);
+        COUT((doc / "big").isRaw(), true);
+        COUT((doc / "big").toString(), "123456789012345678901234567890");
+        COUT((doc / "big" | 0.0) > 1e29, true);
+    }
+
+    DESC("raw number in mutable document");
+    {
+        yyjson::MutableDocument mutDoc(jsonText, yyjson::ReadOptions().numberAsRaw());
+        COUT((mutDoc / "int").isRaw(), true);
+        COUT(mutDoc / "int" | 0, 30);
+        COUT(mutDoc / "real" | 0.0, 2.5);
+        COUT((mutDoc / "neg").toNumber(), -5.0);
+        COUT(mutDoc / "neg" < mutDoc / "int", true);
+    }
+}
@@ -0,0 +1,506 @@
+/**
+ * @file t_memory.cpp
+ * @author lymslive
+ * @date 2025-11-20
+ * @brief memory allocation and management test for xyjson
+ * */
+#include "couttast/couttast.h"
+#include "xyjson.h"
+
+#ifdef XYJSON_HAS_PMR
+namespace {
+
+// memory_resource that counts bytes passed through it
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    size_t allocated = 0;
+    size_t deallocated = 0;
+    size_t count = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t align) override
+    {
+        allocated += bytes;
+        ++count;
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t align) override
+    {
+        deallocated += bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+} // anonymous namespace
+#endif
+
+DEF_TAST(memory_allocator_pmr, "parse, mutate and freeze with pmr memory resource")
+{
+#ifdef XYJSON_HAS_PMR
+    std::string json = R"({"name":"Alice","age":30,"tags":["a","b"]})";
+    CountingResource resource;
+
+    DESC("read Document with pmr allocator");
+    {
+        yyjson::Document doc(json, &resource);
+        COUT(doc.isValid(), true);
+        COUT(doc / "name" | "", "Alice");
+        COUT(resource.count > 0, true);
+        COUT(resource.allocated > resource.deallocated, true);
+    }
+    COUT(resource.allocated, resource.deallocated);
+
+    DESC("mutate and freeze inherit the allocator");
+    {
+        yyjson::Document doc;
+        COUT(doc.read(json, &resource), true);
+        size_t count = resource.count;
+
+        auto mut = doc.mutate();
+        COUT(resource.count > count, true);
+        mut / "age" = 31;
+
+        count = resource.count;
+        auto doc2 = mut.freeze();
+        COUT(resource.count > count, true);
+        COUT(doc2 / "age" | 0, 31);
+    }
+    COUT(resource.allocated, resource.deallocated);
+
+    DESC("MutableDocument with pmr allocator");
+    {
+        yyjson::MutableDocument mut(&resource);
+        COUT(mut.root().isObject(), true);
+        *mut << "key" << "value";
+        COUT(mut / "key" | "", "value");
+
+        yyjson::MutableDocument mut2(json, &resource);
+        COUT(mut2 / "tags" / 1 | "", "b");
+
+        // explicit default allocator for converted document
+        auto doc = mut2.freeze(yyjson::Allocator());
+        COUT(doc / "tags" / 0 | "", "a");
+    }
+    COUT(resource.allocated, resource.deallocated);
+
+    DESC("monotonic buffer as per-request arena");
+    {
+        char buffer[4096];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+        yyjson::Document doc(json, &arena);
+        COUT(doc / "age" | 0, 30);
+        auto mut = doc.mutate();
+        COUT(mut / "tags" / 0 | "", "a");
+    }
+#endif
+}
+
+DEF_TAST(memory_allocator_pool, "parse with raw yyjson_alc from a fixed buffer")
+{
+    std::string json = R"({"name":"Alice","age":30})";
+    char buffer[1024];
+    yyjson_alc alc;
+    COUT(yyjson_alc_pool_init(&alc, buffer, sizeof(buffer)), true);
+
+    yyjson::Document doc;
+    COUT(doc.read(json, &alc), true);
+    COUT(doc / "age" | 0, 30);
+
+    yyjson::Allocator defaultAlc;
+    COUT(defaultAlc.isDefault(), true);
+    COUT(defaultAlc.c_alc() == nullptr, true);
+    yyjson::Allocator poolAlc(&alc);
+    COUT(poolAlc.isDefault(), false);
+
+    DESC("buffer too small to parse");
+    {
+        char tiny[16];
+        yyjson_alc tinyAlc;
+        yyjson_alc_pool_init(&tinyAlc, tiny, sizeof(tiny));
+        yyjson::Document bad(json, &tinyAlc);
+        COUT(bad.isValid(), false);
+        COUT(bad.hasError(), true);
+    }
+}
+
+DEF_TAST(memory_inline_document, "parse into fixed buffer without heap allocation")
+{
+    std::string json = R"({"cmd":"ping","seq":7,"args":[1,2,3]})";
+
+    DESC("pool allocator over caller buffer");
+    {
+        alignas(16) char buffer[1024];
+        yyjson::Document doc(json.c_str(), json.size(), yyjson::Allocator::pool(buffer, sizeof(buffer)));
+        COUT(doc / "seq" | 0, 7);
+
+        char tiny[8];
+        yyjson::Allocator failed = yyjson::Allocator::pool(tiny, sizeof(tiny));
+        COUT(failed.isDefault(), false);
+        yyjson::Document bad(json.c_str(), json.size(), failed);
+        COUT(bad.isValid(), false);
+    }
+
+    DESC("inline document");
+    {
+        yyjson::InlineDocument<4096> doc(json);
+        COUT(doc.capacity(), 4096);
+        COUT(doc.isValid(), true);
+        COUT(doc / "cmd" | "", "ping");
+        COUT(doc["args"][2] | 0, 3);
+        COUT(doc.root().toString(), json);
+
+        DESC("read again reuses the buffer");
+        for (int i = 0; i < 100; ++i) {
+            COUT(doc.read("{\"seq\":" + std::to_string(i) + "}"), true);
+        }
+        COUT(doc / "seq" | 0, 99);
+        std::string input = "[1,2]";
+        doc << input;
+        COUT(doc.root().size(), 2);
+
+        DESC("mutate to heap survives next read");
+        auto mut = doc.mutate();
+        mut.root() << 3;
+        COUT(mut.root().size(), 3);
+        COUT(doc.read(std::string("{\"seq\":100}")), true);
+        COUT(mut.root().toString(), "[1,2,3]");
+        COUT(doc / "seq" | 0, 100);
+
+        DESC("operator~ also mutates to heap");
+        auto copy = ~doc;
+        COUT(doc.read("[\"other\", \"text\", \"to\", \"overwrite\"]"), true);
+        COUT(copy.root().toString(), "{\"seq\":100}");
+        COUT(doc / 3 | "", "overwrite");
+    }
+
+    DESC("buffer too small fails cleanly");
+    {
+        std::string big = "[0";
+        for (int i = 1; i < 100; ++i) { big += "," + std::to_string(i); }
+        big += "]";
+        yyjson::InlineDocument<256> doc(big);
+        COUT(doc.isValid(), false);
+        yyjson_read_err err;
+        COUT(doc.read(big.c_str(), big.size(), yyjson::ReadOptions().error(&err)), false);
+        COUT(err.code, YYJSON_READ_ERROR_MEMORY_ALLOCATION);
+        COUT(doc.read("[1]"), true);
+    }
+}
+
+DEF_TAST(memory_parse_session, "recycle one arena across many document parses")
+{
+    std::string json = R"({"name":"Alice","age":30,"tags":["a","b"]})";
+    yyjson::ParseSession session;
+    COUT(session.capacity(), 0);
+
+    DESC("buffer recycled after each document freed");
+    const void* first = nullptr;
+    for (int i = 0; i < 3; ++i)
+    {
+        yyjson::Document doc = session.parse(json);
+        COUT(doc / "age" | 0, 30);
+        COUT(session.used() > 0, true);
+        COUT(session.liveBlocks() > 0, true);
+        if (i == 0) first = doc.c_doc();
+        COUT(doc.c_doc() == first, true);
+    }
+    COUT(session.used(), 0);
+    COUT(session.liveBlocks(), 0);
+
+    DESC("capacity stable for same input");
+    size_t capacity = session.capacity();
+    COUT(capacity >= yyjson_read_max_memory_usage(json.size(), 0), true);
+    {
+        auto doc = session.parse(json.c_str());
+        COUT(session.capacity(), capacity);
+    }
+
+    DESC("multiple live documents and heap fallback");
+    {
+        auto doc1 = session.parse(json);
+        auto doc2 = session.parse(json);
+        auto doc3 = session.parse(json);
+        COUT(doc1 / "name" | "", "Alice");
+        COUT(doc2 / "tags" / 1 | "", "b");
+        COUT(doc3 == doc1, true);
+        COUT(session.capacity(), capacity);
+    }
+    COUT(session.liveBlocks(), 0);
+
+    DESC("grow geometrically for larger input");
+    {
+        std::string big = "[" + json;
+        for (int i = 0; i < 100; ++i) { big += "," + json; }
+        big += "]";
+        auto doc = session.parse(big);
+        COUT(doc.root().size(), 101);
+        COUT(session.capacity() >= 2 * capacity, true);
+    }
+
+    DESC("invalid input");
+    {
+        auto doc = session.parse("{invalid");
+        COUT(doc.hasError(), true);
+        COUT(session.liveBlocks(), 0);
+        COUT(session.parse(nullptr).hasError(), true);
+    }
+}
+
+DEF_TAST(memory_mutable_adopt, "mutable document read directly refers the parsed strings")
+{
+    std::string json = R"({"name":"Alice","tags":["a","b\n"],"nested":{"x":"y","e":[],"o":{}}})";
+
+    DESC("strings and structure preserved");
+    yyjson::MutableDocument mut(json);
+    COUT(mut / "name" | "", "Alice");
+    COUT(mut / "tags" / 1 | "", "b\n");
+    COUT(mut / "nested" / "x" | "", "y");
+    COUT((mut / "nested" / "e").size(), 0);
+    COUT(mut.root().toString(), json);
+
+    DESC("modify after read");
+    mut / "tags" << "c";
+    mut / "nested" / "e" << 1;
+    mut / "nested" / "o" << "k" << "v";
+    mut / "name" = "Bob";
+    COUT(mut / "tags" / 2 | "", "c");
+    COUT(mut / "nested" / "o" / "k" | "", "v");
+    COUT(mut / "name" | "", "Bob");
+
+    auto doc = mut.freeze();
+    mut.free();
+    COUT(doc / "tags" / 0 | "", "a");
+    COUT(doc / "nested" / "e" / 0 | 0, 1);
+
+#ifdef XYJSON_HAS_PMR
+    DESC("string pool freed with its allocator");
+    CountingResource resource;
+    {
+        yyjson::MutableDocument mut2(json, &resource);
+        COUT(mut2 / "nested" / "x" | "", "y");
+        auto doc2 = mut2.freeze();
+        mut2.free();
+        COUT(resource.allocated > resource.deallocated, true);
+        COUT(doc2 / "name" | "", "Alice");
+    }
+    COUT(resource.allocated, resource.deallocated);
+#endif
+}
+
+DEF_TAST(memory_mutable_reserve, "reserve pools before building a large mutable document")
+{
+    DESC("default constructed empty object");
+    yyjson::MutableDocument mut;
+    COUT(mut.root().isObject(), true);
+    COUT(mut.root().size(), 0);
+    COUT(mut.reserve(1000, 16 * 1024), true);
+    for (int i = 0; i < 500; ++i) {
+        mut.root().add("key" + std::to_string(i), "value" + std::to_string(i));
+    }
+    COUT(mut.root().size(), 500);
+    COUT(mut / "key499" | "", "value499");
+
+    yyjson::MutableDocument invalid((yyjson_mut_doc*)nullptr);
+    COUT(invalid.reserve(10), false);
+
+#ifdef XYJSON_HAS_PMR
+    DESC("few pool growths after reserve");
+    auto build = [](size_t values, size_t bytes) {
+        CountingResource resource;
+        yyjson::MutableDocument doc{yyjson::Allocator(&resource)};
+        doc.reserve(values, bytes);
+        for (int i = 0; i < 1000; ++i) {
+            doc.root().add(std::string("k") + std::to_string(i), i);
+        }
+        return resource.count;
+    };
+    size_t growths = build(0, 0);
+    size_t reserved = build(2100, 8 * 1024);
+    COUT(reserved < growths, true);
+    COUT(reserved <= 4, true);
+#endif
+}
+
+DEF_TAST(memory_freeze_inplace, "consuming freeze takes over the strings of mutable document")
+{
+    std::string json = R"({"name":"Alice","tags":["a","b"],"nested":{"e":[],"o":{},"n":1.5}})";
+
+    DESC("freeze document read from text");
+    {
+        yyjson::MutableDocument mut(json);
+        mut / "tags" << "c" << std::string("d");
+        mut.root().add("extra", std::string(100, 'x'));
+        yyjson::Document doc = std::move(mut).freeze();
+        COUT(mut.isValid(), false);
+        COUT(doc / "name" | "", "Alice");
+        COUT(doc / "tags" / 2 | "", "c");
+        COUT(doc / "tags" / 3 | "", "d");
+        COUT((doc / "extra" | std::string()).size(), 100);
+        COUT((doc / "nested" / "e").size(), 0);
+        COUT(doc / "nested" / "n" | 0.0, 1.5);
+        COUT(doc.root().size(), 4);
+
+        DESC("same content as copy freeze");
+        yyjson::MutableDocument mut2(json);
+        mut2 / "tags" << "c" << "d";
+        mut2.root().add("extra", std::string(100, 'x'));
+        COUT(doc == mut2.freeze(), true);
+        COUT(doc.root().toString(), (~mut2).root().toString());
+    }
+
+    DESC("operator~ on temporary and empty document");
+    {
+        yyjson::Document doc = ~yyjson::MutableDocument(json);
+        COUT(doc / "tags" / 1 | "", "b");
+        yyjson::MutableDocument empty((yyjson_mut_doc*)nullptr);
+        COUT(std::move(empty).freeze().isValid(), false);
+    }
+
+#ifdef XYJSON_HAS_PMR
+    DESC("all memory released after frozen document freed");
+    CountingResource resource;
+    {
+        yyjson::MutableDocument mut(&resource);
+        for (int i = 0; i < 100; ++i) {
+            mut.root().add("key" + std::to_string(i), "value" + std::to_string(i));
+        }
+        size_t count = resource.count;
+        auto doc = std::move(mut).freeze();
+        COUT(doc / "key99" | "", "value99");
+        // only the value array allocated, strings not copied
+        COUT(resource.count, count + 1);
+        auto mut2 = doc.mutate();
+        COUT(mut2 / "key0" | "", "value0");
+    }
+    COUT(resource.allocated, resource.deallocated);
+    {
+        yyjson::MutableDocument mut(json, &resource);
+        auto doc = ~std::move(mut);
+        COUT(doc / "nested" / "n" | 0.0, 1.5);
+    }
+    COUT(resource.allocated, resource.deallocated);
+#endif
+}
+
+DEF_TAST(memory_document_batch, "parse many small documents into one shared arena")
+{
+    std::vector<std::string> messages;
+    for (int i = 0; i < 500; ++i) {
+        messages.push_back("{\"id\":" + std::to_string(i) + ",\"tags\":[\"a\",\"b\"]}");
+    }
+    std::vector<std::string_view> views(messages.begin(), messages.end());
+
+    DESC("all documents in one arena");
+    yyjson::DocumentBatch batch = yyjson::parseMany(views);
+    COUT(batch.size(), 500);
+    COUT(batch.validCount(), 500);
+    COUT(batch[499] / "id" | 0, 499);
+    COUT(batch.at(10) / "tags" / 1 | "", "b");
+    size_t capacity = batch.capacity();
+    COUT(capacity > 0, true);
+
+    int sum = 0;
+    for (const yyjson::Document& doc : batch) {
+        sum += doc / "id" | 0;
+    }
+    COUT(sum, 499 * 500 / 2);
+
+    DESC("reuse the arena for next batch");
+    messages[1] = "{bad";
+    messages.push_back("");
+    COUT(batch.parse(messages), 499);
+    COUT(batch.size(), 501);
+    COUT(batch.at(1).isValid(), false);
+    COUT(batch.at(500).isValid(), false);
+    COUT(batch[2] / "id" | 0, 2);
+    COUT(batch.capacity(), capacity);
+
+    DESC("error of the first invalid input");
+    yyjson_read_err err;
+    yyjson::ReadOptions opt;
+    opt.err = &err;
+    COUT(batch.parse(messages, opt), 499);
+    COUT(err.code != YYJSON_READ_SUCCESS, true);
+    COUT(err.pos, 1);
+
+    DESC("move and clear");
+    yyjson::DocumentBatch other = std::move(batch);
+    COUT(other[0] / "id" | -1, 0);
+    other.clear();
+    COUT(other.empty(), true);
+    COUT(other.capacity(), capacity);
+
+    const char* literals[] = {"[1]", "[2,3]"};
+    auto small = yyjson::parseMany(literals);
+    COUT(small[1].size(), 2);
+}
+
+DEF_TAST(memory_usage_accounting, "report memory held by documents and peak of allocator")
+{
+    std::string json = R"({"name":"Alice","tags":["a","b","c"],"age":30})";
+
+    DESC("read-only document");
+    {
+        yyjson::Document doc(json);
+        yyjson::MemoryUsage usage = doc.memoryUsage();
+        COUT(usage.values, 10);
+        COUT(usage.strings >= json.size(), true);
+        COUT(usage.used > usage.values * sizeof(yyjson_val), true);
+        COUT(usage.allocated, usage.used);
+
+        yyjson::Document empty;
+        COUT(empty.memoryUsage().allocated, 0);
+    }
+
+    DESC("mutable document grows with values");
+    {
+        yyjson::MutableDocument mut;
+        yyjson::MemoryUsage before = mut.memoryUsage();
+        COUT(before.values, 1);
+        for (int i = 0; i < 100; ++i) {
+            mut.root().add("key" + std::to_string(i), i);
+        }
+        yyjson::MemoryUsage after = mut.memoryUsage();
+        COUT(after.values, 201);
+        COUT(after.strings >= 100 * 4, true);
+        COUT(after.used <= after.allocated, true);
+        COUT(after.allocated > before.allocated, true);
+    }
+
+    DESC("tracker of current and peak bytes");
+    yyjson::MemoryTracker tracker;
+    {
+        yyjson::Document doc(json, yyjson::ReadOptions(tracker.allocator()));
+        COUT(doc / "age" | 0, 30);
+        COUT(tracker.current() > 0, true);
+        COUT(tracker.blocks() > 0, true);
+
+        auto mut = doc.mutate();
+        for (int i = 0; i < 100; ++i) {
+            mut.root()["tags"] << std::to_string(i);
+        }
+        COUT(mut / "tags" / 103 | "", "99");
+        COUT(tracker.peak() >= tracker.current(), true);
+    }
+    COUT(tracker.current(), 0);
+    COUT(tracker.blocks(), 0);
+    size_t peak = tracker.peak();
+    COUT(peak > 0, true);
+    tracker.resetPeak();
+    COUT(tracker.peak(), 0);
+
+    DESC("tracker over pool allocator");
+    alignas(16) char buffer[4096];
+    yyjson::MemoryTracker pooled(yyjson::Allocator::pool(buffer, sizeof(buffer)));
+    {
+        yyjson::Document doc(json, yyjson::ReadOptions(pooled.allocator()));
+        COUT(doc.isValid(), true);
+        COUT(pooled.current() > 0, true);
+    }
+    COUT(pooled.current(), 0);
+}
@@ -1180,3 +1180,50 @@ DEF_TAST(mutable_clear, "test clear functionality for MutableValue")
         COUT(doc.root() | 0L, 0L);
     }
 }
+
+DEF_TAST(mutable_view_overlay, "test copy-on-write MutableView over Document")
+{
+    std::string json = R"({"server":{"host":"localhost","port":80},"list":[1,2,3],"a/b":{"c~d":1},"debug":true})";
+    yyjson::Document doc(json);
+    yyjson::MutableView view(doc);
+    COUT(view.isModified(), false);
+    COUT(view.toString(), json);
+
+    DESC("replace, add and remove by path");
+    COUT(view.set("/server/port", 8080), true);
+    COUT(view.set("/server/tls", true), true);
+    COUT(view.remove("/debug"), true);
+    COUT(view.remove("/debug"), false);
+    COUT(view.remove("/missing"), false);
+    COUT(view.set("/missing/key", 1), false);
+    COUT(view.isModified(), true);
+    COUT(view.toString(), R"({"server":{"host":"localhost","port":8080,"tls":true},"list":[1,2,3],"a/b":{"c~d":1}})");
+
+    DESC("array index and append");
+    COUT(view.set("/list/1", "two"), true);
+    COUT(view.remove("/list/0"), true);
+    COUT(view.set("/list/-", 4), true);
+    COUT(view.set("/list/9", 9), false);
+    COUT(view.set("/list/01", 9), false);
+    COUT(view.toString(), R"({"server":{"host":"localhost","port":8080,"tls":true},"list":["two",3,4],"a/b":{"c~d":1}})");
+
+    DESC("escaped token and editing below a replaced subtree");
+    COUT(view.set("/a~1b/c~0d", 2), true);
+    COUT(view.set("/server", *yyjson::Document(R"({"host":"example.com"})")), true);
+    COUT(view.set("/server/port", 443), true);
+    COUT(view.remove("/server/host"), true);
+    COUT(view.toString(), R"({"server":{"port":443},"list":["two",3,4],"a/b":{"c~d":2}})");
+
+    DESC("original document is untouched");
+    COUT(doc / "server" / "port" | 0, 80);
+    COUT(doc / "debug" | false, true);
+    yyjson::Document result(view.toString());
+    COUT(result / "server" / "port" | 0, 443);
+
+    DESC("clear and replace root");
+    view.clear();
+    COUT(view.isModified(), false);
+    COUT(view.toString(), json);
+    COUT(view.set("", 1), true);
+    COUT(view.toString(), "1");
+}
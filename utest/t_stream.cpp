@@ -6,6 +6,9 @@
  * */
 #include "couttast/couttast.h"
 #include "xyjson.h"
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
 
 DEF_TAST(stream_document_ops, "test Document stream operators << and >>")
 {
@@ -480,3 +483,1168 @@ DEF_TAST(stream_file_operations, "test file read/write operations for Document a
     remove(testFilePath);
     remove(testFileMutPath);
 }
+
+DEF_TAST(stream_read_insitu, "test in-situ reading that takes over input buffer")
+{
+    DESC("read from moved std::string");
+    {
+        std::string json = R"({"name":"Alice","tags":["x","y"]})";
+        yyjson::Document doc;
+        COUT(doc.read(std::move(json)), true);
+        COUT(doc / "name" | "", "Alice");
+        COUT(doc / "tags" / 1 | "", "y");
+        // no string pool is duplicated in in-situ mode
+        COUT(doc.c_doc()->str_pool == nullptr, true);
+
+        // the buffer is still alive after converted and original freed
+        auto mutDoc = doc.mutate();
+        doc.free();
+        COUT(mutDoc / "name" | "", "Alice");
+
+        yyjson::Document doc2(std::string(R"([1, "short"])"));
+        COUT(doc2[1] | "", "short");
+        doc2 = yyjson::Document(std::string("{invalid"));
+        COUT(doc2.hasError(), true);
+    }
+
+    DESC("read from char buffer with room for padding");
+    {
+        char buffer[64] = R"({"name":"Bob"})";
+        size_t len = strlen(buffer);
+        yyjson::Document doc;
+        COUT(doc.read(buffer, len, sizeof(buffer)), true);
+        const char* name = doc / "name" | "";
+        COUT(name, "Bob");
+        COUT(name >= buffer && name < buffer + sizeof(buffer), true);
+    }
+
+    DESC("read from char buffer without room, copied");
+    {
+        char buffer[] = R"({"name":"Bob"})";
+        size_t len = strlen(buffer);
+        yyjson::Document doc;
+        COUT(doc.read(buffer, len, len), true);
+        const char* name = doc / "name" | "";
+        COUT(name, "Bob");
+        COUT(name >= buffer && name < buffer + sizeof(buffer), false);
+        COUT(std::string(buffer), R"({"name":"Bob"})");
+    }
+
+    DESC("read in-situ with custom allocator");
+    {
+        char pool[1024];
+        yyjson_alc alc;
+        yyjson_alc_pool_init(&alc, pool, sizeof(pool));
+        yyjson::Document doc;
+        COUT(doc.read(std::string(R"({"age":30})"), &alc), true);
+        COUT(doc / "age" | 0, 30);
+    }
+}
+
+DEF_TAST(stream_mmap_file, "test reading file via memory mapping")
+{
+    const char* path = "/tmp/test_json_mmap.json";
+    {
+        yyjson::Document doc(R"({"name":"Alice","items":[1,2,3],"note":"a\nb"})");
+        COUT(doc.writeFile(path), true);
+    }
+
+    DESC("default in-situ copy-on-write mapping");
+    {
+        yyjson::Document doc;
+        COUT(doc.mmapFile(path), true);
+        COUT(doc / "name" | "", "Alice");
+        COUT(doc / "note" | "", "a\nb");
+        COUT((doc / "items").size(), 3);
+
+        auto mutDoc = doc.mutate();
+        doc.free();
+        COUT(mutDoc / "items" / 2 | 0, 3);
+
+        // the file is not modified by in-situ decoding
+        yyjson::Document again;
+        COUT(again.readFile(path), true);
+        COUT(again / "note" | "", "a\nb");
+    }
+
+    DESC("read-only mapping with other flags");
+    {
+        yyjson::Document doc;
+        COUT(doc.mmapFile(path, 0), true);
+        COUT(doc / "items" / 0 | 0, 1);
+        COUT(doc.mmapFile(path, yyjson::kMmapSequential | yyjson::kMmapPopulate), true);
+        COUT(doc / "note" | "", "a\nb");
+        COUT(doc.mmapFile(path, yyjson::kMmapPopulate | yyjson::kMmapInsitu), true);
+        COUT(doc / "name" | "", "Alice");
+    }
+
+    DESC("error handling");
+    {
+        yyjson::Document doc;
+        COUT(doc.mmapFile("/non/existent/path.json"), false);
+        COUT(doc.mmapFile(nullptr), false);
+
+        FILE* fp = fopen(path, "w");
+        fclose(fp);
+        COUT(doc.mmapFile(path), false);
+    }
+
+    remove(path);
+}
+
+DEF_TAST(stream_read_options, "test reading with yyjson flags in ReadOptions")
+{
+    std::string jsonText = R"({
+        // comment line
+        "name": "Alice", /* inline */
+        "items": [1, 2, 3,],
+    })";
+
+    DESC("default options reject json extension");
+    {
+        yyjson::Document doc(jsonText);
+        COUT(doc.hasError(), true);
+
+        yyjson_read_err err;
+        COUT(doc.read(jsonText, yyjson::ReadOptions().error(&err)), false);
+        COUT(err.code != YYJSON_READ_SUCCESS, true);
+        COUT(err.pos > 0, true);
+    }
+
+    DESC("allow comments and trailing commas");
+    {
+        auto opt = yyjson::ReadOptions().allowComments().allowTrailingCommas();
+        yyjson::Document doc(jsonText, opt);
+        COUT(doc / "name" | "", "Alice");
+        COUT((doc / "items").size(), 3);
+
+        yyjson::MutableDocument mutDoc(jsonText, opt);
+        COUT(mutDoc / "items" / 2 | 0, 3);
+
+        yyjson::Document doc2;
+        COUT(doc2.read(std::string(jsonText), opt), true);
+        COUT(doc2 / "name" | "", "Alice");
+
+        yyjson::ReadOptions flagOpt(YYJSON_READ_ALLOW_COMMENTS | YYJSON_READ_ALLOW_TRAILING_COMMAS);
+        COUT(doc2.read(jsonText, flagOpt), true);
+    }
+
+    DESC("stop when done for concatenated json");
+    {
+        std::string text = R"({"a":1} {"b":2})";
+        yyjson::Document doc;
+        COUT(doc.read(text), false);
+        COUT(doc.read(text, yyjson::ReadOptions().stopWhenDone()), true);
+        COUT(doc / "a" | 0, 1);
+        COUT(doc.readSize(), 7);
+        COUT(doc.read(text.c_str() + doc.readSize(), text.size() - 7,
+            yyjson::ReadOptions().stopWhenDone()), true);
+        COUT(doc / "b" | 0, 2);
+    }
+
+    DESC("options with file and allocator");
+    {
+        const char* path = "/tmp/test_json_options.json";
+        FILE* fp = fopen(path, "w");
+        fputs(jsonText.c_str(), fp);
+        fclose(fp);
+
+        char buffer[4096];
+        yyjson_alc alc;
+        yyjson_alc_pool_init(&alc, buffer, sizeof(buffer));
+        auto opt = yyjson::ReadOptions(&alc).allowComments().allowTrailingCommas();
+        yyjson::Document doc;
+        COUT(doc.readFile(path, opt), true);
+        COUT(doc / "items" / 0 | 0, 1);
+        yyjson::MutableDocument mutDoc;
+        COUT(mutDoc.readFile(path, yyjson::ReadOptions().allowComments().allowTrailingCommas()), true);
+        COUT(mutDoc / "name" | "", "Alice");
+        remove(path);
+    }
+}
+
+namespace {
+
+// streambuf that gives a few bytes once and can not seek, like a pipe
+class PipeBuf : public std::streambuf
+{
+public:
+    explicit PipeBuf(const std::string& data) : m_data(data) {}
+
+protected:
+    int_type underflow() override
+    {
+        if (m_pos >= m_data.size()) return traits_type::eof();
+        size_t n = std::min<size_t>(7, m_data.size() - m_pos);
+        char* p = &m_data[m_pos];
+        setg(p, p, p + n);
+        m_pos += n;
+        return traits_type::to_int_type(*p);
+    }
+
+private:
+    std::string m_data;
+    size_t m_pos = 0;
+};
+
+} // anonymous namespace
+
+DEF_TAST(stream_read_istream, "test reading from generic non-seekable std::istream")
+{
+    DESC("read from pipe-like stream");
+    {
+        PipeBuf buf(R"({"name":"Alice","items":[1,2,3]})");
+        std::istream is(&buf);
+        yyjson::Document doc;
+        COUT(doc.read(is), true);
+        COUT(doc / "name" | "", "Alice");
+        COUT(doc.c_doc()->str_pool == nullptr, true);
+    }
+
+    DESC("read large input in growing chunks");
+    {
+        std::string json = "[";
+        for (int i = 0; i < 20000; ++i) {
+            if (i > 0) json += ",";
+            json += R"({"id":)" + std::to_string(i) + "}";
+        }
+        json += "]";
+
+        PipeBuf buf(json);
+        std::istream is(&buf);
+        yyjson::Document doc;
+        COUT(doc << is, true);
+        COUT(doc.root().size(), 20000);
+        COUT(doc / 19999 / "id" | 0, 19999);
+
+        PipeBuf buf2(json);
+        std::istream is2(&buf2);
+        yyjson::MutableDocument mutDoc;
+        COUT(mutDoc << is2, true);
+        COUT(mutDoc / 100 / "id" | 0, 100);
+    }
+
+    DESC("read from current position of seekable stream");
+    {
+        std::istringstream iss(R"(### {"a":1})");
+        iss.ignore(4);
+        yyjson::Document doc;
+        COUT(doc.read(iss), true);
+        COUT(doc / "a" | 0, 1);
+        COUT(doc.read(iss), false);
+    }
+
+    DESC("empty or invalid stream");
+    {
+        PipeBuf buf("");
+        std::istream is(&buf);
+        yyjson::Document doc;
+        COUT(doc.read(is), false);
+
+        PipeBuf buf2("{invalid");
+        std::istream is2(&buf2);
+        yyjson::MutableDocument mutDoc;
+        COUT(mutDoc.read(is2), false);
+    }
+}
+
+DEF_TAST(stream_document_stream, "test reading NDJSON and concatenated json records")
+{
+    DESC("json lines in memory");
+    {
+        std::string text = "{\"id\":1}\n{\"id\":2}\n\n{\"id\":3}\n";
+        yyjson::DocumentStream stream(text);
+        yyjson::Document doc;
+        int sum = 0;
+        while (stream.next(doc)) {
+            sum += doc / "id" | 0;
+        }
+        COUT(sum, 6);
+        COUT(stream.count(), 3);
+        COUT(stream.offset(), 19);
+        COUT(stream.size(), 8);
+        COUT(stream.hasError(), false);
+    }
+
+    DESC("concatenated and pretty json values");
+    {
+        std::string text = R"(  [1, 2] {"a":
+            {"b": true}}  123 "str" 4.5)";
+        yyjson::DocumentStream stream(text.c_str());
+        yyjson::Document doc;
+        COUT(stream.next(doc), true);
+        COUT(doc.root().size(), 2);
+        COUT(stream.offset(), 2);
+        COUT(stream.next(doc), true);
+        COUT(doc / "a" / "b" | false, true);
+        COUT(stream.next(doc), true);
+        COUT(doc.root() | 0, 123);
+        COUT(stream.next(doc), true);
+        COUT(doc.root() | "", "str");
+        COUT(stream.next(doc), true);
+        COUT(doc.root() | 0.0, 4.5);
+        COUT(stream.next(doc), false);
+        COUT(doc.isValid(), false);
+        COUT(stream.hasError(), false);
+    }
+
+    DESC("record larger than parse window");
+    {
+        std::string big = R"({"list":[)";
+        for (int i = 0; i < 1000; ++i) {
+            if (i > 0) big += ",";
+            big += std::to_string(i);
+        }
+        big += "]}";
+        std::string text = big + "\n" + big + "\n{}";
+        yyjson::DocumentStream stream(text);
+        yyjson::Document doc;
+        COUT(stream.next(doc), true);
+        COUT((doc / "list").size(), 1000);
+        COUT(stream.next(doc), true);
+        COUT(stream.offset(), big.size() + 1);
+        COUT(stream.size(), big.size());
+        COUT(stream.next(doc), true);
+        COUT(doc.root().isObject(), true);
+        COUT(stream.next(doc), false);
+    }
+
+    DESC("error record stops the stream");
+    {
+        std::string text = "{\"id\":1}\n{\"id\":}\n{\"id\":3}\n";
+        yyjson::DocumentStream stream(text);
+        yyjson::Document doc;
+        COUT(stream.next(doc), true);
+        COUT(stream.next(doc), false);
+        COUT(stream.hasError(), true);
+        COUT(stream.error().pos, 15);
+        COUT(stream.next(doc), false);
+        COUT(stream.count(), 1);
+    }
+
+    DESC("json lines from FILE* and fd in chunks");
+    {
+        const char* path = "/tmp/test_json_lines.json";
+        FILE* fp = fopen(path, "w");
+        for (int i = 0; i < 10000; ++i) {
+            fprintf(fp, "{\"id\":%d,\"name\":\"item%d\"}\n", i, i);
+        }
+        fclose(fp);
+
+        fp = fopen(path, "r");
+        yyjson::DocumentStream stream(fp);
+        yyjson::Document doc;
+        size_t lastOffset = 0;
+        int count = 0;
+        while (stream.next(doc)) {
+            if ((doc / "id" | -1) != count) break;
+            lastOffset = stream.offset();
+            ++count;
+        }
+        fseek(fp, 0, SEEK_END);
+        size_t fileSize = ftell(fp);
+        fclose(fp);
+        COUT(count, 10000);
+        COUT(stream.hasError(), false);
+        COUT(lastOffset + stream.size() + 1, fileSize);
+        COUT(doc.isValid(), false);
+
+#ifdef XYJSON_HAS_UNISTD
+        // reuse given dynamic allocator
+        yyjson_alc* alc = yyjson_alc_dyn_new();
+        fp = fopen(path, "r");
+        {
+            yyjson::DocumentStream fdStream(fileno(fp), yyjson::ReadOptions(alc));
+            count = 0;
+            while (fdStream.next(doc)) { ++count; }
+        }
+        fclose(fp);
+        yyjson_alc_dyn_free(alc);
+        COUT(count, 10000);
+#endif
+        remove(path);
+    }
+}
+
+DEF_TAST(stream_parallel_lines, "test parsing NDJSON on multiple threads")
+{
+#ifndef XYJSON_DISABLE_THREAD
+    std::string input;
+    std::vector<size_t> offsets;
+    for (int i = 0; i < 1000; ++i)
+    {
+        offsets.push_back(input.size());
+        input += "{\"id\":" + std::to_string(i) + ",\"name\":\"item\"}\n";
+        if (i % 100 == 0) input += "\r\n";
+    }
+
+    DESC("ordered delivery on the calling thread");
+    {
+        yyjson::ParallelOptions opt(4);
+        opt.chunkSize = 256;
+        yyjson::ParallelParser parser(opt);
+        COUT(parser.threads(), 4);
+
+        std::vector<int> ids;
+        std::vector<size_t> pos;
+        size_t count = parser.parseLines(input, [&](yyjson::Document& doc, size_t offset) {
+            ids.push_back(doc / "id" | -1);
+            pos.push_back(offset);
+        });
+        COUT(count, 1000);
+        COUT(ids.size(), 1000);
+        bool inOrder = true;
+        for (int i = 0; i < 1000; ++i) {
+            if (ids[i] != i || pos[i] != offsets[i]) inOrder = false;
+        }
+        COUT(inOrder, true);
+
+        DESC("parser reusable, invalid line also delivered");
+        std::string bad = "{\"id\":1}\n{bad\n\n[2]";
+        std::vector<bool> valid;
+        count = parser.parseLines(bad, [&](yyjson::Document& doc, size_t) {
+            valid.push_back(doc.isValid());
+        });
+        COUT(count, 2);
+        COUT(valid.size(), 3);
+        COUT(valid[1], false);
+    }
+
+    DESC("unordered delivery on worker threads");
+    {
+        yyjson::ParallelOptions opt(3, false);
+        opt.chunkSize = 128;
+        yyjson::ParallelParser parser(opt);
+
+        std::mutex mutex;
+        std::vector<int> ids;
+        size_t count = parser.parseLines(input, [&](yyjson::Document& doc, size_t) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ids.push_back(doc / "id" | -1);
+        });
+        COUT(count, 1000);
+        std::sort(ids.begin(), ids.end());
+        COUT(ids.front(), 0);
+        COUT(ids.back(), 999);
+        COUT(std::unique(ids.begin(), ids.end()) == ids.end(), true);
+    }
+
+    DESC("keep documents moved out of callback");
+    {
+        yyjson::ParallelParser parser;
+        std::vector<yyjson::Document> docs;
+        parser.parseLines(input.c_str(), 0, [&](yyjson::Document& doc, size_t) {
+            docs.push_back(std::move(doc));
+        });
+        COUT(docs.size(), 1000);
+        COUT(docs[999] / "id" | 0, 999);
+    }
+
+#if defined(__cpp_exceptions)
+    DESC("callback throws while next batch is parsing");
+    {
+        yyjson::ParallelOptions opt(4);
+        opt.chunkSize = 256;
+        yyjson::ParallelParser parser(opt);
+        bool caught = false;
+        try {
+            parser.parseLines(input, [](yyjson::Document& doc, size_t) {
+                if ((doc / "id" | 0) == 10) throw std::runtime_error("stop");
+            });
+        }
+        catch (const std::runtime_error&) {
+            caught = true;
+        }
+        COUT(caught, true);
+        COUT(parser.parseLines(input, [](yyjson::Document&, size_t) {}), 1000);
+    }
+
+    DESC("unordered callback throws on workers");
+    {
+        yyjson::ParallelOptions opt(4, false);
+        opt.chunkSize = 256;
+        yyjson::ParallelParser parser(opt);
+        bool caught = false;
+        try {
+            parser.parseLines(input, [](yyjson::Document& doc, size_t) {
+                if ((doc / "id" | 0) % 100 == 10) throw std::runtime_error("stop");
+            });
+        }
+        catch (const std::runtime_error&) {
+            caught = true;
+        }
+        COUT(caught, true);
+        std::atomic<size_t> count{0};
+        COUT(parser.parseLines(input, [&count](yyjson::Document&, size_t) { count++; }), 1000);
+        COUT(count.load(), 1000);
+    }
+#endif
+#endif
+}
+
+DEF_TAST(stream_parallel_array, "test parsing one large array on multiple threads")
+{
+#ifndef XYJSON_DISABLE_THREAD
+    std::string input = "[\n";
+    for (int i = 0; i < 1000; ++i)
+    {
+        if (i > 0) input += ",\n";
+        input += "{\"id\":" + std::to_string(i) + R"(,"tag":"a,]\"\\","list":[1,{"x":"}"}]})";
+    }
+    input += "\n]\n";
+    yyjson::Document expect(input);
+
+    DESC("split into ranges and stitched as one document");
+    yyjson::ParallelOptions opt(4);
+    opt.chunkSize = 256;
+    yyjson::ParallelParser parser(opt);
+    yyjson::Document doc = parser.parseArray(input);
+    COUT(doc.isValid(), true);
+    COUT(doc.root().size(), 1000);
+    COUT(doc == expect, true);
+    COUT(doc / 999 / "id" | 0, 999);
+    COUT(doc / 500 / "tag" | "", "a,]\"\\");
+    COUT(doc / "/3/list/1/x" | "", "}");
+
+    int sum = 0;
+    for (auto item : doc.root().array()) {
+        sum += item / "id" | 0;
+    }
+    COUT(sum, 999 * 1000 / 2);
+    size_t count = 0;
+    for (auto it = doc.root().beginArray(); it != doc.root().endArray(); ++it) {
+        ++count;
+    }
+    COUT(count, 1000);
+
+    DESC("mutate and write as normal document");
+    auto mut = doc.mutate();
+    COUT(mut / 10 / "id" | 0, 10);
+    COUT(doc.root().toString(), expect.root().toString());
+
+    DESC("one element spans many slices");
+    std::string big = "[1, {\"list\": [";
+    for (int i = 0; i < 2000; ++i)
+    {
+        if (i > 0) big += ",";
+        big += std::to_string(i);
+    }
+    big += "]}, 2]";
+    yyjson::Document bigDoc = parser.parseArray(big);
+    COUT(bigDoc.root().size(), 3);
+    COUT(bigDoc == yyjson::Document(big), true);
+    COUT(bigDoc / 1 / "list" / 1999 | 0, 1999);
+    COUT(bigDoc / 2 | 0, 2);
+
+    DESC("fallback to sequential parse");
+    COUT(parser.parseArray(R"({"a":[1,2]})") / "a" / 1 | 0, 2);
+    COUT(parser.parseArray("[1,2,3]").root().size(), 3);
+
+    std::string bad = input;
+    bad.replace(bad.find(",\n", bad.size() / 2), 1, ",#");
+    yyjson_read_err err;
+    yyjson::ReadOptions readOpt;
+    readOpt.err = &err;
+    COUT(parser.parseArray(bad, readOpt).isValid(), false);
+    COUT(err.code != YYJSON_READ_SUCCESS, true);
+    COUT(err.pos, bad.find(",#") + 1);
+    COUT(parser.parseArray(input, readOpt).isValid(), true);
+    COUT(err.code, YYJSON_READ_SUCCESS);
+
+    std::string empty = "[" + std::string(1000, ' ') + ",1]";
+    COUT(parser.parseArray(empty).isValid(), false);
+    std::string blank = "[" + std::string(1000, ' ') + "]";
+    COUT(parser.parseArray(blank).root().size(), 0);
+#endif
+}
+
+DEF_TAST(stream_incremental_document, "test parsing one json fed in chunks")
+{
+#ifdef XYJSON_HAS_INCR
+    std::string json = R"({"name":"Alice","tags":["a","b","c"],"nested":{"x":1.5,"y":[1,2,3]}})";
+
+    DESC("total size known in advance");
+    {
+        yyjson::IncrementalDocument incr(json.size());
+        for (size_t i = 0; i < json.size(); i += 7) {
+            COUT(incr.feed(json.data() + i, std::min<size_t>(7, json.size() - i)), true);
+        }
+        COUT(incr.isComplete(), true);
+        COUT(incr.size(), json.size());
+        yyjson::Document doc = incr.finish();
+        COUT(doc / "tags" / 2 | "", "c");
+        COUT(doc / "nested" / "y" / 2 | 0, 3);
+    }
+
+    DESC("unknown size, buffer grows");
+    {
+        std::string big = "[";
+        for (int i = 0; i < 2000; ++i) { big += (i ? "," : "") + json; }
+        big += "]";
+
+        yyjson::IncrementalDocument incr;
+        for (size_t i = 0; i < big.size(); i += 1000) {
+            COUT(incr.feed(big.substr(i, 1000)), true);
+        }
+        COUT(incr.isComplete(), true);
+        auto doc = incr.finish();
+        COUT(doc.root().size(), 2000);
+        COUT(doc / 1999 / "name" | "", "Alice");
+
+        DESC("reuse after finish by reset without size");
+        incr.reset();
+        COUT(incr.feed(" " + json.substr(0, 30)), true);
+        COUT(incr.isComplete(), false);
+        COUT(incr.feed(json.substr(30) + "\n"), true);
+        COUT(incr.isComplete(), true);
+        COUT(incr.finish() / "nested" / "x" | 0.0, 1.5);
+
+        incr.reset(0);
+        COUT(incr.feed("[1,2]"), true);
+        COUT(incr.finish().root().size(), 2);
+        incr.reset();
+        COUT(incr.feed("[1,2] x"), false);
+        COUT(incr.error().code, YYJSON_READ_ERROR_UNEXPECTED_CONTENT);
+    }
+
+    DESC("scalar root completed at finish");
+    {
+        yyjson::IncrementalDocument incr;
+        COUT(incr.feed("12"), true);
+        COUT(incr.feed("34 "), true);
+        COUT(incr.finish().root() | 0, 1234);
+    }
+
+    DESC("syntax error and reset");
+    {
+        yyjson::IncrementalDocument incr;
+        incr.feed("{\"a\":");
+        COUT(incr.feed("]"), false);
+        COUT(incr.hasError(), true);
+        COUT(incr.feed("{}"), false);
+        COUT(incr.finish().isValid(), false);
+
+        incr.reset(json.size());
+        COUT(incr.hasError(), false);
+        COUT(incr.feed(json), true);
+        COUT(incr.feed(" \n"), true);
+        COUT(incr.feed("x"), false);
+        COUT(incr.error().code, YYJSON_READ_ERROR_UNEXPECTED_CONTENT);
+    }
+
+    DESC("truncated input");
+    {
+        yyjson::IncrementalDocument incr(json.size());
+        COUT(incr.feed(json.substr(0, 20)), true);
+        COUT(incr.finish().hasError(), true);
+        COUT(incr.error().code, YYJSON_READ_ERROR_UNEXPECTED_END);
+    }
+#endif
+}
+
+DEF_TAST(stream_ondemand_document, "test on-demand document scanning raw text")
+{
+    std::string json = R"({
+        "skip": {"deep": [1, [2, {"x": "]}"}], "q\"uote"]},
+        "user": {"id": 42, "name": "Alice", "tags": ["a", "b", "c"]},
+        "a\/b": true,
+        "items": [{"price": 1.5}, {"price": 2.5}, {"price": 3}],
+        "empty": [], "none": null
+    })";
+
+    yyjson::OnDemandDocument doc(json);
+    COUT(doc.isValid(), true);
+    COUT(doc.root().isObject(), true);
+    COUT(doc.parsedCount(), 0);
+
+    DESC("key, index and path access");
+    COUT(doc / "user" / "id" | 0, 42);
+    COUT(doc / "user" / "name" | "", "Alice");
+    COUT(doc["user"]["tags"][2] | "", "c");
+    COUT(doc / "/items/1/price" | 0.0, 2.5);
+    COUT(doc / "/items/2/price" | 0, 3);
+    COUT(doc / "skip" / "deep" / 1 / 1 / "x" | "", "]}");
+    COUT(doc / "skip" / "deep" / 2 | "", "q\"uote");
+    COUT(doc / "a/b" | false, true);
+    COUT(doc.parsedCount(), 8);
+
+    DESC("only visited values parsed and cached");
+    COUT(doc / "user" / "id" | 0, 42);
+    COUT(doc.parsedCount(), 8);
+
+    DESC("type, size and raw text");
+    COUT(doc / "none" & nullptr, true);
+    COUT((doc / "user" / "tags").isArray(), true);
+    COUT((doc / "user" / "tags").size(), 3);
+    COUT((doc / "user").size(), 3);
+    COUT((doc / "empty").size(), 0);
+    COUT(doc.root().size(), 6);
+    COUT((doc / "items" / 0).raw(), R"({"price": 1.5})");
+    COUT((doc / "/items/0").toString(), R"({"price":1.5})");
+    COUT(+(doc / "user" / "id"), 42);
+    COUT(-(doc / "user" / "name"), "\"Alice\"");
+
+    DESC("generic operators on value and document");
+    COUT((doc / "user" / "tags").getType(), YYJSON_TYPE_ARR);
+    COUT((doc / "none").getType(), YYJSON_TYPE_NULL);
+    COUT((doc / "user" / "id").getType(), YYJSON_TYPE_NUM);
+    COUT(*(doc / "user" / "tags" % 1) | "", "b");
+    COUT(doc / "/items/0/price" < doc / "/items/1/price", true);
+    std::string out;
+    yyjson::OnDemandDocument small("[1, 2, 3]");
+    COUT(small >> out, true);
+    COUT(out, "[1,2,3]");
+
+    DESC("missing path");
+    COUT((doc / "user" / "age").isValid(), false);
+    COUT(doc / "user" / "age" | -1, -1);
+    COUT((doc / "/items/3").isValid(), false);
+    COUT((doc / "/items/01").isValid(), false);
+    COUT((doc / "empty" / 0).isValid(), false);
+    COUT((doc / "none" / "x").isValid(), false);
+
+    DESC("move and take over string");
+    yyjson::OnDemandDocument doc2(std::move(doc));
+    COUT(doc.isValid(), false);
+    COUT(doc2 / "user" / "tags" / 0 | "", "a");
+    yyjson::OnDemandDocument doc3(std::string("[1, 2, 3]"));
+    COUT(doc3[2] | 0, 3);
+
+    DESC("empty text");
+    yyjson::OnDemandDocument empty(" \n");
+    COUT(empty.isValid(), false);
+    COUT((empty / "x").isValid(), false);
+}
+
+DEF_TAST(stream_read_projection, "test reading only the projected paths")
+{
+    std::string json = R"({"user": {"id": 1, "name": "Alice", "tags": ["x", "y"]},
+        "items": [{"price": 2, "sku": "s1"}, {"sku": "s2"}, 5, {"price": [3, 4]}],
+        "skip": {"deep": "]}"}, "meta": {"v": 1}})";
+
+    DESC("keep paths and the containers along them");
+    yyjson::Document doc;
+    COUT(doc.read(json, {"/user/id", "/items/*/price"}), true);
+    COUT(doc.root().toString(), R"({"user":{"id":1},"items":[{"price":2},{},null,{"price":[3,4]}]})");
+    COUT(doc / "user" / "id" | 0, 1);
+    COUT((doc / "user" / "name").isValid(), false);
+    COUT((doc / "skip").isValid(), false);
+    COUT((doc / "items").size(), 4);
+
+    DESC("array index, whole subtree and missing path");
+    yyjson::Projection proj;
+    COUT(proj.empty(), true);
+    COUT(proj.add("/user/tags/1"), true);
+    COUT(proj.add(std::string("/meta")), true);
+    COUT(proj.add("/meta/v"), true);
+    COUT(proj.add("/nothing"), true);
+    COUT(proj.add("bad"), false);
+    yyjson::Document doc2(json.c_str(), 0);
+    COUT(doc2.read(json, proj), true);
+    COUT(doc2.root().toString(), R"({"user":{"tags":["y"]},"meta":{"v":1}})");
+
+    std::string text;
+    COUT(proj.apply(json.c_str(), json.size(), text), true);
+    COUT(text, R"({"user":{"tags":["y"]},"meta":{"v": 1}})");
+
+    DESC("empty projection or path keeps all");
+    COUT(doc2.read(json, yyjson::Projection()), true);
+    COUT(doc2 / "user" / "name" | "", "Alice");
+    COUT(doc2.read(json, {""}), true);
+    COUT(doc2 / "skip" / "deep" | "", "]}");
+
+    DESC("malformed input");
+    yyjson_read_err err;
+    yyjson::ReadOptions opt;
+    opt.err = &err;
+    COUT(doc2.read(R"({"user": {"id": 1)", {"/user/id"}, opt), false);
+    COUT(doc2.isValid(), false);
+    COUT(err.code, YYJSON_READ_ERROR_UNEXPECTED_CHARACTER);
+}
+
+DEF_TAST(stream_validate, "test validating json text without building document")
+{
+    std::string json = R"({"name": "Alice", "tags": ["a", "b", "c"], "age": 30})";
+
+    DESC("statistics of valid input");
+    yyjson::ValidateResult result = yyjson::validate(json);
+    COUT(result.isValid(), true);
+    COUT(!!result, true);
+    COUT(result.depth, 2);
+    COUT(result.values, 10);
+    COUT(result.values, yyjson_doc_get_val_count(yyjson::Document(json).c_doc()));
+    COUT(result.readSize, json.size());
+    COUT(yyjson::validate("42").depth, 0);
+
+    DESC("error code and position");
+    result = yyjson::validate(R"({"a": [1, 2 3]})");
+    COUT(result.isValid(), false);
+    COUT(result.code, YYJSON_READ_ERROR_UNEXPECTED_CHARACTER);
+    COUT(result.pos, 12);
+    COUT(yyjson::validate("[1, 2").code, YYJSON_READ_ERROR_UNEXPECTED_END);
+    COUT(yyjson::validate("[01]").code, YYJSON_READ_ERROR_INVALID_NUMBER);
+    result = yyjson::validate("[1, -1e400]");
+    COUT(result.code, YYJSON_READ_ERROR_INVALID_NUMBER);
+    COUT(result.pos, 4);
+    COUT(yyjson::validate("[1e999]", yyjson::ReadOptions().bignumAsRaw()).isValid(), true);
+    COUT(yyjson::validate("[1e999]", yyjson::ReadOptions().allowInfAndNan()).isValid(), true);
+    COUT(yyjson::validate("[nul]").code, YYJSON_READ_ERROR_LITERAL);
+    COUT(yyjson::validate("\"\\ud800\"").code, YYJSON_READ_ERROR_INVALID_STRING);
+    COUT(yyjson::validate("\"\xc3\x28\"").code, YYJSON_READ_ERROR_INVALID_STRING);
+    COUT(yyjson::validate("  ").code, YYJSON_READ_ERROR_EMPTY_CONTENT);
+    COUT(yyjson::validate("{} {}").code, YYJSON_READ_ERROR_UNEXPECTED_CONTENT);
+    COUT(yyjson::validate(nullptr).code, YYJSON_READ_ERROR_INVALID_PARAMETER);
+
+    yyjson_read_err err;
+    COUT(yyjson::validate("[1,]", 0, yyjson::ReadOptions().error(&err)).isValid(), false);
+    COUT(err.pos, 3);
+
+    DESC("read flags");
+    yyjson::ReadOptions relaxed = yyjson::ReadOptions().allowComments().allowTrailingCommas().allowInfAndNan();
+    COUT(yyjson::validate("/* c */ [1, NaN, -Infinity, ] // end", relaxed).isValid(), true);
+    result = yyjson::validate("[1] [2]", yyjson::ReadOptions().stopWhenDone());
+    COUT(result.isValid(), true);
+    COUT(result.readSize, 3);
+
+    DESC("agree with parsing");
+    const char* samples[] = {
+        "[1, -0.5e+3, true, false, null]", "{\"k\": {\"k\": {}}}", "\"\\u00e9\xe4\xb8\xad\"",
+        "[1,,2]", "{\"k\" 1}", "{\"k\": 1,}", "[\"\t\"]", "-", "1.", "[1e]", "\"\\q\"",
+        "[1e999]", "[-1e400]", "[0.0001e312]", "[1.7976931348623157e308]", "[0.0e999]",
+    };
+    for (const char* sample : samples) {
+        yyjson::Document doc(sample);
+        COUT(yyjson::validate(sample).isValid(), doc.isValid());
+    }
+
+    DESC("deep nesting without recursion");
+    std::string deep = std::string(10000, '[') + std::string(10000, ']');
+    result = yyjson::validate(deep);
+    COUT(result.isValid(), true);
+    COUT(result.depth, 10000);
+}
+
+DEF_TAST(stream_write_buffer, "test writing into reusable string and buffer")
+{
+    std::string json = R"({"name":"Alice","tags":["a","b"],"age":30})";
+    yyjson::Document doc(json);
+    yyjson::MutableDocument mut(json);
+
+    DESC("write into string replaces content");
+    std::string output = "old content that is longer than the json output";
+    COUT(doc.write(output), true);
+    COUT(output, json);
+    COUT(output.size(), json.size());
+    COUT(mut.write(output), true);
+    COUT(output, json);
+    COUT(doc.write(output, YYJSON_WRITE_PRETTY), true);
+    COUT(output, doc.root().toString(true));
+
+    DESC("write value and toString");
+    COUT((doc / "tags").write(output), true);
+    COUT(output, R"(["a","b"])");
+    COUT((mut / "age").write(output), true);
+    COUT(output, "30");
+    COUT((doc / "name").toString(), "Alice");
+    COUT((mut / "tags").toString(), R"(["a","b"])");
+    COUT(yyjson::Value().write(output), false);
+
+    DESC("reuse write buffer");
+    yyjson::WriteBuffer buffer;
+    COUT(buffer.empty(), true);
+    COUT(std::string(buffer.data()), "");
+    COUT(doc.write(buffer), true);
+    COUT(buffer.str(), json);
+    COUT(buffer.size(), json.size());
+    COUT(::strlen(buffer.data()), json.size());
+    size_t capacity = buffer.capacity();
+    COUT(capacity > json.size(), true);
+    for (int i = 0; i < 10; ++i) {
+        mut.root()["age"] = i;
+        COUT(mut.write(buffer), true);
+    }
+    COUT(std::string(buffer.view()), R"({"name":"Alice","tags":["a","b"],"age":9})");
+    COUT(buffer.capacity(), capacity);
+    COUT((doc / "tags").write(buffer), true);
+    COUT(buffer.str(), R"(["a","b"])");
+    buffer.clear();
+    COUT(buffer.empty(), true);
+
+    DESC("grow for large output");
+    yyjson::MutableDocument big;
+    for (int i = 0; i < 1000; ++i) {
+        big.root().add("key" + std::to_string(i), "value" + std::to_string(i));
+    }
+    COUT(big.write(buffer), true);
+    COUT(buffer.str(), big.root().toString());
+    COUT(buffer.capacity() > capacity, true);
+
+    DESC("buffer memory from allocator");
+    yyjson::MemoryTracker tracker;
+    {
+        yyjson::WriteBuffer tracked(tracker.allocator());
+        COUT(doc.write(tracked), true);
+        COUT(tracked.str(), json);
+        COUT(tracker.current() >= tracked.capacity(), true);
+    }
+    COUT(tracker.current(), 0);
+}
+
+DEF_TAST(stream_chunked_writer, "test streaming large document to targets in chunks")
+{
+    // more values than a subtree serialized at once
+    yyjson::MutableDocument mut("[]");
+    for (int i = 0; i < 3000; ++i) {
+        yyjson::MutableValue item = mut.create(yyjson::kObject);
+        item.add("id", i).add("name", "item" + std::to_string(i)).add("tags", mut.create(yyjson::kArray));
+        mut.root() << item;
+    }
+    mut.root()[7]["tags"] << "x" << "y";
+    std::string json = mut.root().toString();
+    yyjson::Document doc(json);
+    COUT(doc.root().size(), 3000);
+
+    DESC("same output as yyjson writer");
+    {
+        std::ostringstream oss;
+        yyjson::StreamWriter writer(oss);
+        COUT(writer.write(doc), true);
+        COUT(writer.flush(), true);
+        COUT(oss.str() == json, true);
+        COUT(writer.size(), json.size());
+    }
+    {
+        std::ostringstream oss;
+        oss << mut;
+        COUT(oss.str() == json, true);
+    }
+
+    DESC("pretty mode re-indents nested subtrees");
+    const yyjson_write_flag flags[] = {
+        YYJSON_WRITE_PRETTY, YYJSON_WRITE_PRETTY_TWO_SPACES,
+        YYJSON_WRITE_PRETTY | YYJSON_WRITE_NEWLINE_AT_END,
+    };
+    for (yyjson_write_flag flg : flags) {
+        std::string expect;
+        COUT(doc.write(expect, flg), true);
+        std::ostringstream oss;
+        yyjson::StreamWriter writer(oss, flg);
+        COUT(writer.write(doc), true);
+        writer.flush();
+        COUT(oss.str() == expect, true);
+
+        std::ostringstream mss;
+        yyjson::StreamWriter(mss, flg).write(mut);
+        COUT(mss.str() == expect, true);
+    }
+
+    DESC("large object and nested small values");
+    {
+        yyjson::MutableDocument obj;
+        for (int i = 0; i < 5000; ++i) {
+            obj.root().add("k" + std::to_string(i), i % 3 ? obj.create() : obj.create("v"));
+        }
+        std::string expect = obj.root().toString(true);
+        std::ostringstream oss;
+        yyjson::StreamWriter(oss, YYJSON_WRITE_PRETTY).write(obj);
+        COUT(oss.str() == expect, true);
+    }
+
+    DESC("FILE and file descriptor");
+    {
+        FILE* fp = tmpfile();
+        COUT(doc.write(fp), true);
+        COUT(static_cast<size_t>(ftell(fp)), json.size());
+        fclose(fp);
+
+        const char* path = "/tmp/xyjson_stream_writer.json";
+        COUT(doc.writeFile(path), true);
+        yyjson::Document back;
+        COUT(back.readFile(path), true);
+        COUT(back == doc, true);
+
+        std::ofstream ofs(path);
+        COUT(mut.write(ofs), true);
+        ofs.close();
+        COUT(back.readFile(path), true);
+        COUT(back == doc, true);
+#ifdef XYJSON_HAS_UNISTD
+        int fd = ::open(path, O_WRONLY | O_TRUNC);
+        {
+            yyjson::StreamWriter writer(fd);
+            COUT(writer.write(doc), true);
+            COUT(writer.append("\n", 1), true);
+        }
+        ::close(fd);
+        COUT(back.readFile(path), true);
+        COUT(back == doc, true);
+#endif
+        std::remove(path);
+    }
+
+    DESC("strings output as plain value");
+    std::ostringstream oss;
+    oss << doc / 7 / "name" << ' ' << doc / 7 / "tags";
+    COUT(oss.str(), R"(item7 ["x","y"])");
+    COUT(yyjson::StreamWriter(oss).write(yyjson::Value()), false);
+}
+
+DEF_TAST(stream_json_writer, "test writing json text directly without nodes")
+{
+    DESC("same output as mutable document built by operators");
+    yyjson::MutableDocument mut;
+    mut.root() << "name" << "Alice" << mut * 25 * "age";
+    mut.root() << "tags" << (mut * yyjson::kArray << "a" << 1 << 2.5 << true << nullptr);
+    mut.root() << "info" << (mut * yyjson::kObject << "empty" << yyjson::kObject << "zero" << 0);
+
+    yyjson::JsonWriter writer;
+    {
+        auto root = writer.object();
+        writer << "name" << "Alice" << writer * 25 * "age";
+        {
+            auto tags = writer.array("tags");
+            writer << "a" << 1 << 2.5 << true << nullptr;
+        }
+        writer.beginObject("info");
+        writer << "empty" << yyjson::kObject << "zero" << yyjson::kNumber;
+        writer.end();
+        COUT(writer.isComplete(), false);
+    }
+    COUT(writer.isValid(), true);
+    COUT(writer.isComplete(), true);
+    COUT(writer.str(), mut.root().toString());
+
+    DESC("member keeps the key of a temporary string");
+    writer.clear();
+    {
+        auto root = writer.object();
+        auto member = writer * 25 * std::string("age of a key longer than short string");
+        std::string("overwrite the freed key buffer if it were not kept");
+        writer << member;
+    }
+    COUT(writer.str(), R"({"age of a key longer than short string":25})");
+
+    DESC("strings are escaped as yyjson writer");
+    std::string text = "quote\" slash\\ tab\t line\n ctrl\x01 utf8\xe4\xb8\xad end of a long string";
+    writer.clear();
+    writer.beginArray().value(text).value(std::string_view(text).substr(0, 7)).end();
+    yyjson::MutableDocument arr("[]");
+    arr.root() << text << text.substr(0, 7);
+    COUT(writer.str(), arr.root().toString());
+    COUT(writer.size(), writer.str().size());
+
+    DESC("values and documents copied as json");
+    yyjson::Document doc(R"({"a":[1,{"b":null}],"c":"d"})");
+    writer.clear();
+    writer.beginObject();
+    writer.add("doc", doc).add("a", doc / "a").add("mut", mut / "tags");
+    writer << "none" << doc / "none";
+    writer.key("raw").raw("[1,2]", 5);
+    writer.end();
+    COUT(writer.str(), R"({"doc":{"a":[1,{"b":null}],"c":"d"},"a":[1,{"b":null}],)"
+        R"("mut":["a",1,2.5,true,null],"none":null,"raw":[1,2]})");
+    yyjson::Document back(writer.release());
+    COUT(back / "doc" == doc.root(), true);
+    COUT(writer.size(), 0);
+    COUT(writer.isComplete(), false);
+
+    DESC("misuse marks writer invalid");
+    {
+        yyjson::JsonWriter bad;
+        bad.beginObject();
+        bad << 1;
+        COUT(bad.isValid(), false);
+        COUT(!bad, true);
+    }
+    {
+        yyjson::JsonWriter bad;
+        bad.end();
+        COUT(bad.isValid(), false);
+    }
+    {
+        yyjson::JsonWriter bad;
+        bad << 1 << 2;
+        COUT(bad.isValid(), false);
+        COUT(bad.str(), "1");
+    }
+    {
+        yyjson::JsonWriter bad;
+        bad.beginArray().key("k");
+        COUT(bad.isValid(), false);
+    }
+}
+
+DEF_TAST(stream_parallel_write, "test writing one large document on multiple threads")
+{
+#ifndef XYJSON_DISABLE_THREAD
+    yyjson::MutableDocument mut("[]");
+    for (int i = 0; i < 2000; ++i) {
+        yyjson::MutableValue item = mut.create(yyjson::kObject);
+        item.add("id", i).add("name", "item\t" + std::to_string(i));
+        item.add("list", mut * yyjson::kArray << i << (mut * yyjson::kObject << "x" << i * 0.5));
+        mut.root() << item;
+    }
+    yyjson::Document doc(mut.root().toString());
+    yyjson::MutableDocument obj;
+    for (int i = 0; i < 2000; ++i) {
+        obj.root().add("k" + std::to_string(i), i % 3 ? obj.create(i) : obj.create(yyjson::kArray));
+    }
+
+    yyjson::ParallelOptions opt(4);
+    opt.chunkSize = 1024;
+    yyjson::ParallelWriter writer(opt);
+    COUT(writer.threads(), 4);
+
+    DESC("same output as sequential writer with each flags");
+    const yyjson_write_flag flags[] = {
+        YYJSON_WRITE_NOFLAG, YYJSON_WRITE_PRETTY, YYJSON_WRITE_PRETTY_TWO_SPACES,
+        YYJSON_WRITE_PRETTY | YYJSON_WRITE_NEWLINE_AT_END,
+    };
+    for (yyjson_write_flag flg : flags) {
+        std::string expect;
+        std::string output;
+        COUT(doc.write(expect, flg), true);
+        COUT(writer.write(doc.root(), output, flg), true);
+        COUT(output == expect, true);
+        COUT(writer.write(mut.root(), output, flg), true);
+        COUT(output == expect, true);
+
+        COUT(obj.write(expect, flg), true);
+        COUT(writer.write(obj.root(), output, flg), true);
+        COUT(output == expect, true);
+    }
+
+    DESC("write by document with options");
+    std::string json = doc.root().toString();
+    std::string output;
+    COUT(doc.write(output, opt), true);
+    COUT(output == json, true);
+    COUT(mut.write(output, opt), true);
+    COUT(output == json, true);
+
+    DESC("FILE and file descriptor");
+    {
+        FILE* fp = tmpfile();
+        COUT(doc.write(fp, opt, YYJSON_WRITE_PRETTY), true);
+        COUT(static_cast<size_t>(ftell(fp)), doc.root().toString(true).size());
+        fclose(fp);
+#ifdef XYJSON_HAS_UNISTD
+        const char* path = "/tmp/xyjson_parallel_writer.json";
+        int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        COUT(writer.write(mut.root(), fd), true);
+        ::close(fd);
+        yyjson::Document back;
+        COUT(back.readFile(path), true);
+        COUT(back == doc, true);
+        std::remove(path);
+#endif
+    }
+
+    DESC("small or scalar value written sequentially");
+    COUT(writer.write(doc / 7, output), true);
+    COUT(output, (doc / 7).toString());
+    COUT(writer.write(doc / 7 / "id", output), true);
+    COUT(output, "7");
+    COUT(writer.write(yyjson::Value(), output), false);
+#endif
+}